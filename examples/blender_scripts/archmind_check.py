@@ -43,11 +43,14 @@ def check(askew, amax,dfilename, pfilename):
         except ValueError:
             index = 0
 
+        #the faces of 55 degrees and above are counted in the last bucket
+        index = min(index, 11)
+
         tri_angles[index] = tri_angles[index] + 1
 
     out = open(dfilename, 'w')
 
-    out.write('#Min angle distribution, every 5 degrees\n')
+    out.write('#Min angle distribution, every 5 degrees, the last row counts all faces above 55 degrees\n')
     for i in range(0,12):
         out.write('%3d %d\n' % ((i+1)*5, tri_angles[i]) )
 
@@ -177,7 +177,7 @@ def angles(f):
 
     return [a0,a1,a2]
 
-def mesh_check(m, angle_needle, angle_skew, angle_max):
+def mesh_check(m, angle_needle, angle_skew, angle_max, angle_feature=60.0):
     '''Check the mesh and returns stats''' 
     stats = {}
     stats['mesh_quality'] = 0.0
@@ -189,6 +189,7 @@ def mesh_check(m, angle_needle, angle_skew, angle_max):
     stats['edges_total'] = m.edges_size
     stats['edges_free'] = 0
     stats['edges_tjoin'] = 0
+    stats['edges_feature'] = 0
     stats['verts_total'] = m.verts_size
     stats['verts_free'] = 0
 
@@ -213,16 +214,15 @@ def mesh_check(m, angle_needle, angle_skew, angle_max):
 
         stats['mesh_quality'] += quality( f ) / m.faces_size
 
-    #edges stats
-    for e in m.edges:
-        if is_free(e):
-            stats['edges_free'] += 1
-        elif is_tjoin(e):
-            stats['edges_tjoin'] += 1
-    
-    for v in m.verts:
-        if len( list( v.edges ) ) == 0:
-            stats['verts_free'] += 1
+    #edges and vertices stats
+    report = classify_manifold(m)
+    stats['edges_free'] = report.boundary_count
+    stats['edges_tjoin'] = report.tjoin_count
+    stats['verts_free'] = report.isolated_count
+
+    #edges sharper than angle_feature degrees, boundary and tjoin edges included
+    features = curvature(m).feature_edges(angle_feature)
+    stats['edges_feature'] = sum( [bin(b).count('1') for b in bytearray(features)] )
 
     return stats
 
@@ -35,23 +35,15 @@ from archmind_utils import *
 def check(askew, amax, dfilename, pfilename):
     mymesh = blender_to_mesh()
 
-    #make a list for min angle triangle distribution
-    tri_angles = [0 for i in range(0,12)]
-
-    for f in list(mymesh.faces):
-        fa = angles(f)
-
-        try:
-            index = int(min( fa ) / (pi * (4.99999/180.0)) )
-        except ValueError:
-            index = 0
-
-        tri_angles[index] = tri_angles[index] + 1
+    #min angle distribution, the faces of 55 degrees and above (equilateral
+    #triangles, quads) are counted in the last bucket
+    histogram = quality_report(mymesh).min_angle.histogram
+    tri_angles = histogram[0:11] + [sum(histogram[11:])]
 
     if dfilename != '':
         out = open(dfilename, 'w')
 
-        out.write('#Min angle distribution, every 5 degrees\n')
+        out.write('#Min angle distribution, every 5 degrees, the last row counts all faces above 55 degrees\n')
         for i in range(0,12):
             out.write('%3d %d\n' % ((i+1)*5, tri_angles[i]) )
 
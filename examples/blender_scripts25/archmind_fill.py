@@ -38,78 +38,12 @@ bl_info = {
 
 from archmind_utils import *
 
-def find(dict,key):
-    try:
-        return dict[key]
-    except KeyError:
-        return 0 
-
-def follow(e, checked):
-    '''Follows an open boundary'''
-    
-    vertices = []
-    perimeter = 0.0
-    cur_edge = e
-    start_vert = e.v0
-    cur_vert = start_vert
-    prev_vert = cur_vert
-
-    while True:
-        found_edge = False
-        vertices.append( cur_vert )
-
-        #mark the edge as checked
-        checked[cur_edge] = True
-        
-        #calculate the perimeter of the boundary
-        perimeter += distance(cur_edge.v0.point,cur_edge.v1.point)
-        prev_vert = cur_vert    
-
-        #go to the next point of the edge
-        if prev_vert == cur_edge.v0:
-            cur_vert = cur_edge.v1
-        else:
-            cur_vert = cur_edge.v0
-        
-        #find next edge to follow
-        for ee in cur_vert.edges:
-            if is_free( ee ) and ee != cur_edge:
-            
-                #found closed boundary
-                if ee == e:
-                    return [vertices,perimeter]
-            
-                #do not select checked edges
-                if find(checked,ee):
-                    continue
-
-                found_edge = True
-                cur_edge = ee
-                break
-
-        if not found_edge:
-            return [[],0.0]     #failed to find closed boundary
-
-
 def fill(d):
     '''Fill holes with a perimeter less than d'''
     m = blender_to_mesh()
 
-    checked = {}
-    holes = []
-
-    #find the holes of the mesh that satisfy the threshold
-    for e in m.edges:
-        if is_free(e) and not find(checked,e):
-            [hole,perimeter] = follow(e,checked)
-
-            if len(hole) > 0 and perimeter <= d:
-                holes.append( hole )
-
-    #cover the holes
-    for hole in holes:
-        #build a new non convex polygon
-        m.add_face( poly(hole) )
+    #follow the boundary loops and triangulate the holes natively
+    fill_holes(m, d)
 
     mesh_to_blender(m)
     
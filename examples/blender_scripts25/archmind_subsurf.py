@@ -35,76 +35,13 @@ bl_info = {
 
 from archmind_utils import *
 
-def hermite(p0,p1,n0,n1,t):
-    '''Calculates the value of the Cubic Hermite Spline for parameter t'''
-    #Hermite direction
-    d = p0 - p1
-    #Hermite tangents
-    m0 = cross( cross( d, n0 ), n0 )
-    m1 = cross( cross( d, n1 ), n1 )
-
-    t_2 = t*t
-    t_3 = t*t*t
-    h00 = 2*t_3 - 3*t_2 + 1
-    h10 = t_3 - 2*t_2 + t
-    h01 = -2*t_3 + 3*t_2
-    h11 = t_3 - t_2
-    return p0 * h00 + m0 * h10 + p1 * h01 +m1 * h11
-
-def compute_normals(m):
-    #reset normals
-    for v in m.verts:
-        v.normal = vec3(0.0)
-
-    for f in m.faces:
-        for v in f.verts:
-            v.normal += f.normal * area( f.points ) 
-
-    #normalize
-    for v in m.verts:
-        v.normal = normalize( v.normal )
-
-def subsurf():
+def subsurf(levels):
     m = blender_to_mesh()
 
-    #extend vertex class to hold the normal 
-    vertex.normal = vec3(0.0)       
-     
-    #compute area weighted normals for the mesh
-    compute_normals(m)
-        
-    #split the edges of the mesh
-    for e in list(m.edges):
-        #middle of the Hermite Spline that is defined by the edge endpoints and the corresponding normals
-        pt = hermite(e.v0.point,e.v1.point,e.v0.normal,e.v1.normal,0.5)
-        #split the edge without triangulation
-        v = m.split_edge(e, 0.5)
-        #the new point is moved to the middle of the Hermite Spline
-        m.set_point(v,pt)
-        
-    #the mesh now contains non planar polygons that needs to be converted to triangles/quads 
-    #therefore the faces of the mesh are splitted uniformly according to the 
-    #following patterns for triangles and quads
-    #   p0            p0----p1
-    #   /\            |  |  |
-    #  /--\            -----
-    # /_\/_\          |__|__|
-    #p2    p1         p3    p2
-    for f in list(m.faces):
-       verts = list(f.verts)
-       if len(verts) == 6: #triangle
-           m.add_face( triangle(verts[5],verts[0],verts[1]) )     #upper triangle
-           m.add_face( triangle(verts[1],verts[2],verts[3]) )     #right triangle
-           m.add_face( triangle(verts[3],verts[4],verts[5]) )     #left triangle 
-           m.add_face( triangle(verts[1],verts[3],verts[5]) )     #middle triangle
-       else: #quad
-           c = vertex( centroid(verts) )     #quad centroid
-           m.add_face( quad(verts[7],verts[0],verts[1],c) )  
-           m.add_face( quad(verts[1],verts[2],verts[3],c) )
-           m.add_face( quad(verts[3],verts[4],verts[5],c) )
-           m.add_face( quad(verts[5],verts[6],verts[7],c) )
-
-       m.remove_face(f)    #remove the old face
+    #the edges are split at the middle of the Hermite Spline that is defined by the edge 
+    #endpoints and the area weighted vertex normals, the triangles are split in four 
+    #triangles and the quads in four quads around their centroid
+    subdivide(m, subdivide_scheme.hermite, levels)
     
     mesh_to_blender(m)
 
@@ -117,8 +54,7 @@ class SubsurfClass(bpy.types.Operator):
     levels = bpy.props.IntProperty(name='Levels', default=0, min = 1, max = 5)
 
     def execute(self, context):
-        for i in range(0,self.levels):
-            subsurf()
+        subsurf(self.levels)
 
         return {'FINISHED'}
 
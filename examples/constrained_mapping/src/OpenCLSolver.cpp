@@ -23,6 +23,8 @@
 #include "OpenCLBlas.h"
 #include "NonLinearSolvers.h"
 #include "UtilsCL.h"
+#include "Geometry/Boundary.h"
+#include "Geometry/Properties.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -1554,16 +1556,8 @@ parameterization::SolverCL::SolverCL(
             }
         }
 
-        mesh_t::point_t pmin = input_mesh.verts()[0]->point();
-        mesh_t::point_t pmax = input_mesh.verts()[0]->point();
-
-        foreach( mesh_t::vertex_ptr_t v, input_mesh.verts() ) {
-            mesh_t::point_t p = v->point();
-            for( int i = 0; i < 3; i++ ) {
-                pmin[i] = min(pmin[i],p[i]);
-                pmax[i] = max(pmax[i],p[i]);
-            }
-        }
+        mesh_t::point_t pmin, pmax;
+        arch::geometry::bounding_box( input_mesh, pmin, pmax );
 
         m_Scale = input_mesh.edges()[0]->length();
         foreach( mesh_t::edge_ptr_t e, input_mesh.edges() ) {
@@ -2059,46 +2053,6 @@ void parameterization::SolverCL::compute_mips_weights(std::vector< cl_scalar_t >
 
 }
 
-bool find_boundary( mesh_t::edge_ptr_t e, std::vector< mesh_t::vertex_ptr_t > &boundary, double &perimeter ) 
-{
-    boundary.clear();
-    perimeter = 0.0;
-    std::map< mesh_t::edge_ptr_t, bool > checked;
-    std::deque< mesh_t::edge_ptr_t > q;
-    mesh_t::edge_ptr_t cur_edge = e;
-    mesh_t::vertex_ptr_t cur_vert = e->v0();
-    mesh_t::vertex_ptr_t prev_vert = cur_vert;
-
-    while( 1 ) {
-        bool found_edge = false;
-        boundary.push_back( cur_vert );
-        
-        perimeter += cur_edge->length();
-        
-        //mark the edge as checked
-        checked[cur_edge] = true;
-        prev_vert = cur_vert;
-        cur_vert = prev_vert == cur_edge->v0() ? cur_edge->v1() : cur_edge->v0();
-        foreach( mesh_t::edge_ptr_t ee, cur_vert->edges() ) {
-            if( is_free( ee ) && ee != cur_edge ) {
-                //found closed boundary
-                if( ee == e ) return true;
-
-                //do not select checked edge
-                if( checked.find(ee) != checked.end() ) continue;
-
-                found_edge = true;
-                cur_edge = ee;
-                break;
-            }
-        }
-
-        //failed to find closed boundary
-        if( !found_edge ) 
-            return false;
-    }
-}
-
 void parameterization::SolverCL::untangle_laplace(int max_iters)
 {
 #if 0
@@ -2217,18 +2171,18 @@ void parameterization::SolverCL::circular_projection(int max_iters)
     using namespace cl;
 
     std::vector< mesh_t::vertex_ptr_t > boundary;
+    std::vector< mesh_t::vertex_array_t > loops;
     double perimeter = 0;
 
     //find the boundary with the longest perimeter
-    foreach( mesh_t::edge_ptr_t e, m_Input.edges() ) {
-        double p;
-        std::vector< mesh_t::vertex_ptr_t > b;
-
-        if( is_free( e ) && find_boundary( e, b, p ) ) {
-            if( p > perimeter ) {
-                perimeter = p;
-                boundary = b;
-            }
+    boundary_loops( m_Input, loops );
+
+    foreach( const mesh_t::vertex_array_t &b, loops ) {
+        double p = arch::geometry::perimeter( b );
+
+        if( p > perimeter ) {
+            perimeter = p;
+            boundary = b;
         }
     }
 
@@ -22,7 +22,7 @@
 //Laplacian smoothing example
 
 #include "Geometry/Geometry.h"
-#include "Geometry/Algorithms.h"
+#include "Geometry/Smooth.h"
 #include "Io/Io.h"
 
 #include <iostream>
@@ -42,19 +42,6 @@ typedef mesh_t::face_t face_t;
 typedef mesh_t::face_ptr_t face_ptr_t;
 typedef mesh_t::point_t point_t;
 
-bool is_locked( vertex_ptr_t v )
-{
-    //Check if any edge of the vertex is free (boundary) or tjoin
-    for( vertex_t::edge_iterator_t e = v->edges_begin();
-        e != v->edges_end(); ++e )
-    {
-        if( is_free( *e ) || is_tjoin( *e ) )
-            return true;
-    }
-
-    return false;
-}
-
 int main(int argc, char **argv)
 {
     mesh_t mymesh;
@@ -73,18 +60,8 @@ int main(int argc, char **argv)
 
     int iterations = atoi(argv[3]);
 
-    //Simultaneous Laplacian smoothing
-    for( int i = 0; i < iterations; ++i )
-    {
-        for( 
-            mesh_t::vertex_iterator_t v = mymesh.verts_begin();
-            v != mymesh.verts_end(); ++v )
-        {
-            //Move the vertex to the centoid of its neighbors
-            if( !is_locked(*v) )
-                mymesh.set_point(*v, centroid( (*v)->verts() ) );
-        }
-    }
+    //Simultaneous Laplacian smoothing, the boundary and tjoin vertices are locked
+    smooth( mymesh, iterations );
 
     if( !save_to_file( argv[2], mymesh ) )
         std::cerr << "Failed to write output file " << argv[1] << std::endl;
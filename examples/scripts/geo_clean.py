@@ -22,42 +22,16 @@
 
 import sys
 import argparse
-from collections import deque
 from archmind.geometry import *
 from archmind.io import *
 
-def fix_orientation(m):
-    """Fixes the faces orientation and returns the number of fixed faces"""
-
-    flips = 0
-    checked = [0 for i in range(0,m.faces_size)]    #build a list with zeros
-    queue = deque( [next(m.faces)] )     #add the first face to the queue
-
-    while queue:
-        f = queue.popleft()
-
-        for ff in f.faces:
-            #skip already fixed faces
-            if not checked[ff.id]:
-                #get the common edge of the two faces
-                e = set(f.edges).intersection(ff.edges).pop()
-
-                if f.edge_cw(e) == ff.edge_cw(e):
-                    m.flip_face(ff)       #flip face orientation
-                    flips+=1
-
-                checked[ff.id] = 1       #mark as fixed
-                queue.append(ff)
-
-    return flips
-
 def check_duplicate(f):
     """Returns true if the face contains duplicate vertices"""
     return len(set(f.verts)) != f.verts_size
 
 
 def clean(argv):
-    """Removes degenerated faces and fixes the orientation"""
+    """Removes degenerated faces, splits the non manifold edges and vertices and fixes the orientation"""
 
     parser = argparse.ArgumentParser()
     parser.add_argument('-s', help="input model")
@@ -80,10 +54,24 @@ def clean(argv):
             mymesh.remove_face(f)
             rem += 1
 
-    flips = fix_orientation(mymesh)
+    manifold = classify_manifold(mymesh)
+    verts = mymesh.verts_size
+    if not manifold.is_manifold:
+        make_manifold(mymesh)
+
+    report = orient_consistently(mymesh)
+    crossing = find_self_intersections(mymesh)
 
     print('Faces removed : %d' % rem)
-    print('Faces flipped : %d' % flips)
+    print('Faces flipped : %d' % report.flips)
+    if report.non_orientable:
+        print('Non orientable components : %d' % report.non_orientable)
+    if crossing:
+        print('Self intersecting face pairs : %d' % len(crossing))
+    if not manifold.is_manifold:
+        print('Tjoin edges : %d' % manifold.tjoin_count)
+        print('Non manifold vertices : %d' % manifold.nonmanifold_count)
+        print('Vertices added : %d' % (mymesh.verts_size - verts))
 
     save_to_file(mesh_filename,mymesh)
 
@@ -25,14 +25,7 @@ import argparse
 from archmind.geometry import *
 from archmind.io import *
 
-#helper function that checks if a vertex can be moved
-def locked(v):
-	for e in v.edges:
-		if is_free( e ):
-			return 1
-	return 0
-
-def smooth(argv):
+def main(argv):
     """Laplacian smoothing"""
 
     parser = argparse.ArgumentParser()
@@ -48,15 +41,12 @@ def smooth(argv):
     print('Smoothing...')
     NumOfIters = 20
 
-    for i in range(0,NumOfIters):
-	    for v in mymesh.verts:
-		    if not locked(v):
-			    mymesh.set_point( v, centroid( v.verts ) )
+    smooth(mymesh, NumOfIters)
 
     print('Saving ...')
     save_to_file(mesh_filename,mymesh)
 
 if __name__ == "__main__":
-    smooth(sys.argv[1:])
+    main(sys.argv[1:])
 
 
@@ -21,14 +21,108 @@
 
 #include "../Geometry/Geometry.h"
 #include "../Geometry/Algorithms.h"
+#include "../Geometry/Quality.h"
+#include "../Geometry/Distance.h"
+#include "../Io/Io.h"
 #include "../Python/PyInterface.h"
 
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
 using namespace arch::geometry;
 
+static void print_measure(const char *name, const quality_measure &q)
+{
+    std::printf( "%-14s min %10.4g  max %10.4g  mean %10.4g\n", name, q.min, q.max, q.mean() );
+
+    for( std::size_t i = 0; i < q.histogram.size(); ++i )
+    {
+        if( q.histogram[i] )
+            std::printf( "    [%10.4g, %10.4g) %10lu\n", q.start + i * q.width, q.start + (i + 1) * q.width, 
+                (unsigned long)q.histogram[i] );
+    }
+}
+
+//archmind quality <file> : prints the quality report of a mesh file
+static int quality(const char *filename)
+{
+    mesh<> m;
+
+    if( !arch::io::load_from_file( filename, m ) )
+    {
+        std::cout << "Could not load " << filename << std::endl;
+        return 1;
+    }
+
+    mesh_quality q = quality_report( m );
+
+    std::printf( "faces %lu  degenerate %lu\n", (unsigned long)q.faces, (unsigned long)q.degenerate );
+
+    print_measure( "min angle", q.min_angle );
+    print_measure( "max angle", q.max_angle );
+    print_measure( "aspect ratio", q.aspect_ratio );
+    print_measure( "skew", q.skew );
+    print_measure( "area", q.area );
+    print_measure( "edge length", q.edge_length );
+
+    return 0;
+}
+
+static void print_distance(const char *name, const mesh_distance &d)
+{
+    std::printf( "%-8s max %10.4g  mean %10.4g  rms %10.4g  samples %lu\n", name, d.max, d.mean, d.rms, 
+        (unsigned long)d.samples );
+}
+
+//archmind distance <file a> <file b> [samples] [tolerance] : prints the distances between two mesh files,
+//returns 2 if the Hausdorff distance is above the tolerance or infinite, as for a mesh without faces
+static int distance(int argc, char **argv)
+{
+    mesh<> a, b;
+
+    for( int i = 0; i < 2; ++i )
+    {
+        if( !arch::io::load_from_file( argv[i], i ? b : a ) )
+        {
+            std::cout << "Could not load " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    const std::size_t samples = argc > 2 ? std::strtoul( argv[2], 0, 10 ) : 100000;
+
+    const mesh_distance ab = surface_distance( a, b, samples );
+    const mesh_distance ba = surface_distance( b, a, samples );
+    const double hausdorff = std::max( ab.max, ba.max );
+
+    print_distance( "a -> b", ab );
+    print_distance( "b -> a", ba );
+    std::printf( "hausdorff %10.4g\n", hausdorff );
+
+    if( hausdorff == std::numeric_limits< double >::infinity() )
+    {
+        std::cout << "A mesh has no faces to measure the distance to" << std::endl;
+        return 2;
+    }
+
+    if( argc > 3 && hausdorff > std::atof( argv[3] ) )
+        return 2;
+
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
     using namespace arch::python;
 
+    if(argc > 2 && std::strcmp(argv[1], "quality") == 0)
+        return quality(argv[2]);
+
+    if(argc > 3 && std::strcmp(argv[1], "distance") == 0)
+        return distance(argc - 2, argv + 2);
+
     if(argc > 1)
     {
         Interface pyEngine(argc-1,argv+1);
@@ -22,7 +22,14 @@
 #ifndef GEOMETRY_ALGORITHMS_H
 #define GEOMETRY_ALGORITHMS_H
 
+#include "Indexed.h"
+#include "Parallel.h"
+
 #include <iterator>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 
 namespace arch
 {
@@ -109,24 +116,43 @@ typename vec_t::value_type triangle_area(
 \brief Checks a planar polygon for convexity
 \param Poly a vector of points
 \return true if the points form a convex polygon
+
+The corners are projected on the coordinate plane of the dominant axis of the Newell normal and 
+their turns are compared with the exact orient2d, collinear corners are allowed.
 */
 template<typename PointVectorType>
 bool is_convex(const PointVectorType &poly)
 {
-    typedef typename PointVectorType::value_type vec_t;
-    typedef typename vec_t::real_t real_t;
+    const std::size_t n = poly.size();
 
-    if( poly.size() <= 3 ) return true;
+    if( n <= 3 ) return true;
 
-    vec_t n = math::cross( poly[2] - poly[0], poly[1] - poly[0] );
-    
-    for( std::size_t i = 1; i < poly.size(); ++i )
+    double normal[3] = { 0.0, 0.0, 0.0 };
+    for( std::size_t i = 0; i < n; ++i )
     {
-        vec_t cs = math::cross( 
-            poly[(i+2)%poly.size()] - poly[i], 
-            poly[(i+1)%poly.size()] - poly[i] );
+        const std::size_t j = (i + 1) % n;
 
-        if( dot( cs, n ) < real_t(0.0) )
+        for( int k = 0; k < 3; ++k )
+        {
+            const int u = (k + 1) % 3, v = (k + 2) % 3;
+            normal[k] += (double( poly[i][u] ) - double( poly[j][u] )) * (double( poly[i][v] ) + double( poly[j][v] ));
+        }
+    }
+
+    const double nx = std::fabs( normal[0] ), ny = std::fabs( normal[1] ), nz = std::fabs( normal[2] );
+    const int axis = nx > ny ? (nx > nz ? 0 : 2) : (ny > nz ? 1 : 2);
+    const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+
+    bool left = false, right = false;
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        const std::size_t j = (i + 1) % n, k = (i + 2) % n;
+        const double turn = math::orient2d( poly[i][u], poly[i][v], poly[j][u], poly[j][v], poly[k][u], poly[k][v] );
+
+        left = left || turn > 0.0;
+        right = right || turn < 0.0;
+
+        if( left && right )
             return false;
     }
 
@@ -209,6 +235,141 @@ circum_center(const PointIterator &begin, const PointIterator &end)
     return circum_center( poly );
 }
 
+/*!
+\brief Point of the cubic Hermite curve between two surface points
+\param p0 the first point
+\param n0 the unit normal of the surface at p0
+\param p1 the second point
+\param n1 the unit normal of the surface at p1
+\param t the parametric value (0-1.0)
+\return the point of the curve, a point of the chord if a tangent cannot be found
+
+The tangents are the chord projected on the tangent planes of the end points scaled to the chord length,
+so the curve follows the surface when it replaces a straight edge.
+*/
+template<typename vec_t>
+vec_t hermite_point( const vec_t &p0, const vec_t &n0, const vec_t &p1, const vec_t &n1, const typename vec_t::real_t &t )
+{
+    typedef typename vec_t::real_t real_t;
+
+    vec_t d = p1 - p0;
+    real_t len = math::magnitude( d );
+
+    vec_t t0 = d - n0 * math::dot( n0, d );
+    vec_t t1 = d - n1 * math::dot( n1, d );
+
+    real_t len0 = math::magnitude( t0 );
+    real_t len1 = math::magnitude( t1 );
+
+    if( !(len0 > real_t(0.0)) || !(len1 > real_t(0.0)) )
+        return p0 + d * t;
+
+    t0 *= len / len0;
+    t1 *= len / len1;
+
+    real_t t2 = t * t, t3 = t2 * t;
+
+    return p0 * (real_t(2.0) * t3 - real_t(3.0) * t2 + real_t(1.0)) + t0 * (t3 - real_t(2.0) * t2 + t) +
+           p1 * (real_t(3.0) * t2 - real_t(2.0) * t3) + t1 * (t3 - t2);
+}
+
+/*!
+\brief Closest point of a triangle to a point
+\param p the point
+\param a the first corner
+\param b the second corner
+\param c the third corner
+\return the point of the triangle closest to p
+
+The Voronoi regions of the corners and the edges are tested first (Ericson, Real-Time 
+Collision Detection 5.1.5) so degenerate triangles give a point of their longest edge.
+*/
+template<typename vec_t>
+vec_t closest_point_triangle( const vec_t &p, const vec_t &a, const vec_t &b, const vec_t &c )
+{
+    typedef typename vec_t::real_t real_t;
+
+    const vec_t ab = b - a, ac = c - a, ap = p - a;
+    const real_t d1 = math::dot( ab, ap ), d2 = math::dot( ac, ap );
+
+    if( d1 <= real_t(0.0) && d2 <= real_t(0.0) )
+        return a;
+
+    const vec_t bp = p - b;
+    const real_t d3 = math::dot( ab, bp ), d4 = math::dot( ac, bp );
+
+    if( d3 >= real_t(0.0) && d4 <= d3 )
+        return b;
+
+    const real_t vc = d1 * d4 - d3 * d2;
+
+    if( vc <= real_t(0.0) && d1 >= real_t(0.0) && d3 <= real_t(0.0) )
+        return a + ab * (d1 / (d1 - d3));
+
+    const vec_t cp = p - c;
+    const real_t d5 = math::dot( ab, cp ), d6 = math::dot( ac, cp );
+
+    if( d6 >= real_t(0.0) && d5 <= d6 )
+        return c;
+
+    const real_t vb = d5 * d2 - d1 * d6;
+
+    if( vb <= real_t(0.0) && d2 >= real_t(0.0) && d6 <= real_t(0.0) )
+        return a + ac * (d2 / (d2 - d6));
+
+    const real_t va = d3 * d6 - d5 * d4;
+
+    if( va <= real_t(0.0) && (d4 - d3) >= real_t(0.0) && (d5 - d6) >= real_t(0.0) )
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    const real_t denom = real_t(1.0) / (va + vb + vc);
+
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/*!
+\brief Intersection of a ray with a triangle (Moller-Trumbore)
+\param origin the origin of the ray
+\param dir the direction of the ray
+\param a the first corner
+\param b the second corner
+\param c the third corner
+\param t the ray parameter of the hit
+\param u the barycentric coordinate of b at the hit
+\param v the barycentric coordinate of c at the hit
+\return true if the ray hits the triangle for a positive t, from either side
+*/
+template<typename vec_t>
+bool ray_triangle( const vec_t &origin, const vec_t &dir, const vec_t &a, const vec_t &b, const vec_t &c, 
+                   typename vec_t::real_t &t, typename vec_t::real_t &u, typename vec_t::real_t &v )
+{
+    typedef typename vec_t::real_t real_t;
+
+    const vec_t e1 = b - a, e2 = c - a;
+    const vec_t pv = math::cross( dir, e2 );
+    const real_t det = math::dot( e1, pv );
+
+    if( det == real_t(0.0) )
+        return false;
+
+    const real_t inv = real_t(1.0) / det;
+    const vec_t tv = origin - a;
+
+    u = math::dot( tv, pv ) * inv;
+    if( u < real_t(0.0) || u > real_t(1.0) )
+        return false;
+
+    const vec_t qv = math::cross( tv, e1 );
+
+    v = math::dot( dir, qv ) * inv;
+    if( v < real_t(0.0) || u + v > real_t(1.0) )
+        return false;
+
+    t = math::dot( e2, qv ) * inv;
+
+    return t >= real_t(0.0);
+}
+
 /*!
 \brief Calculate centroid of list of vertex pointers
 \param begin Start iterator
@@ -263,6 +424,381 @@ bool is_ear(const Iterator &begin, const Iterator &end, const VertexType &v0, co
     return true;
 }
 
+//!Twice the signed area of a 2d triangle, positive for counter clock-wise points, the sign is exact
+template<typename Real>
+double orient2( const math::vec2<Real> &a, const math::vec2<Real> &b, const math::vec2<Real> &c )
+{
+    return math::orient2d( a.x, a.y, b.x, b.y, c.x, c.y );
+}
+
+/*!
+\brief Six times the signed volume of the tetrahedron a b c d
+\return positive if d lies on the side the normal of the counter clock-wise triangle a b c points to
+
+The sign is exact, the intersection tests below are decided by these signs alone.
+*/
+template<typename vec_t>
+double orient3( const vec_t &a, const vec_t &b, const vec_t &c, const vec_t &d )
+{
+    return math::orient3d( a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z, d.x, d.y, d.z );
+}
+
+//!-1, 0 or 1
+inline int sign_of( double v )
+{
+    return v > 0.0 ? 1 : (v < 0.0 ? -1 : 0);
+}
+
+//!Projection of coplanar points on the plane of the dominant axis of a normal
+struct plane_projection
+{
+    template<typename vec_t>
+    plane_projection( const vec_t &a, const vec_t &b, const vec_t &c )
+    {
+        const double ux = double( b.x ) - double( a.x ), uy = double( b.y ) - double( a.y ), uz = double( b.z ) - double( a.z );
+        const double vx = double( c.x ) - double( a.x ), vy = double( c.y ) - double( a.y ), vz = double( c.z ) - double( a.z );
+        const double n[3] = { std::fabs( uy * vz - uz * vy ), std::fabs( uz * vx - ux * vz ), std::fabs( ux * vy - uy * vx ) };
+
+        const int axis = n[0] > n[1] ? (n[0] > n[2] ? 0 : 2) : (n[1] > n[2] ? 1 : 2);
+
+        U = (axis + 1) % 3;
+        V = (axis + 2) % 3;
+        Degenerate = n[axis] == 0.0;
+    }
+
+    template<typename vec_t>
+    math::vec2<double> operator()( const vec_t &p )const { return math::vec2<double>( double( p[U] ), double( p[V] ) ); }
+
+    int U, V;
+
+    //!the three points were collinear
+    bool Degenerate;
+};
+
+//!True if r lies in the bounding box of the segment pq
+template<typename Real>
+bool in_segment_box( const math::vec2<Real> &p, const math::vec2<Real> &q, const math::vec2<Real> &r )
+{
+    return std::min( p.x, q.x ) <= r.x && r.x <= std::max( p.x, q.x ) && 
+           std::min( p.y, q.y ) <= r.y && r.y <= std::max( p.y, q.y );
+}
+
+//!True if the closed segments ab and cd of the plane meet
+template<typename Real>
+bool segments_intersect( const math::vec2<Real> &a, const math::vec2<Real> &b, const math::vec2<Real> &c, const math::vec2<Real> &d )
+{
+    const int o1 = sign_of( orient2( a, b, c ) ), o2 = sign_of( orient2( a, b, d ) );
+    const int o3 = sign_of( orient2( c, d, a ) ), o4 = sign_of( orient2( c, d, b ) );
+
+    if( o1 * o2 < 0 && o3 * o4 < 0 )
+        return true;
+
+    //a point on the line of the other segment has to be between its ends
+    return (o1 == 0 && in_segment_box( a, b, c )) || (o2 == 0 && in_segment_box( a, b, d )) ||
+           (o3 == 0 && in_segment_box( c, d, a )) || (o4 == 0 && in_segment_box( c, d, b ));
+}
+
+//!True if p lies in the closed triangle abc of the plane, a triangle without area contains nothing
+template<typename Real>
+bool point_in_triangle_2d( const math::vec2<Real> &p, const math::vec2<Real> &a, const math::vec2<Real> &b, const math::vec2<Real> &c )
+{
+    const int s0 = sign_of( orient2( a, b, p ) ), s1 = sign_of( orient2( b, c, p ) ), s2 = sign_of( orient2( c, a, p ) );
+
+    if( sign_of( orient2( a, b, c ) ) == 0 )
+        return false;
+
+    return !( (s0 < 0 || s1 < 0 || s2 < 0) && (s0 > 0 || s1 > 0 || s2 > 0) );
+}
+
+/*!
+\brief True if the closed segment ab meets the closed triangle pqr
+\note a triangle without area is not hit
+*/
+template<typename vec_t>
+bool segment_triangle_intersect( const vec_t &a, const vec_t &b, const vec_t &p, const vec_t &q, const vec_t &r )
+{
+    const int sa = sign_of( orient3( p, q, r, a ) ), sb = sign_of( orient3( p, q, r, b ) );
+
+    if( sa * sb > 0 )
+        return false;
+
+    if( sa == 0 && sb == 0 )
+    {
+        const plane_projection proj( p, q, r );
+
+        if( proj.Degenerate )
+            return false;
+
+        const math::vec2<double> a2 = proj( a ), b2 = proj( b ), p2 = proj( p ), q2 = proj( q ), r2 = proj( r );
+
+        return point_in_triangle_2d( a2, p2, q2, r2 ) || segments_intersect( a2, b2, p2, q2 ) || 
+               segments_intersect( a2, b2, q2, r2 ) || segments_intersect( a2, b2, r2, p2 );
+    }
+
+    //the segment reaches the plane, the line through it has to pass inside the three edges
+    const int s0 = sign_of( orient3( a, b, p, q ) ), s1 = sign_of( orient3( a, b, q, r ) ), s2 = sign_of( orient3( a, b, r, p ) );
+
+    return !( (s0 < 0 || s1 < 0 || s2 < 0) && (s0 > 0 || s1 > 0 || s2 > 0) );
+}
+
+/*!
+\brief True if the closed triangles p1 q1 r1 and p2 q2 r2 meet, touching included
+
+Two triangles that are not coplanar meet exactly when an edge of one of them meets the other, 
+the intersection is a segment of the line of the two planes that ends on their edges. 
+Coplanar triangles are compared in the projection on the plane.
+*/
+template<typename vec_t>
+bool triangles_intersect( const vec_t &p1, const vec_t &q1, const vec_t &r1, const vec_t &p2, const vec_t &q2, const vec_t &r2 )
+{
+    const int a0 = sign_of( orient3( p2, q2, r2, p1 ) ), a1 = sign_of( orient3( p2, q2, r2, q1 ) ), a2 = sign_of( orient3( p2, q2, r2, r1 ) );
+
+    //one triangle on one side of the plane of the other
+    if( (a0 > 0 && a1 > 0 && a2 > 0) || (a0 < 0 && a1 < 0 && a2 < 0) )
+        return false;
+
+    const int b0 = sign_of( orient3( p1, q1, r1, p2 ) ), b1 = sign_of( orient3( p1, q1, r1, q2 ) ), b2 = sign_of( orient3( p1, q1, r1, r2 ) );
+
+    if( (b0 > 0 && b1 > 0 && b2 > 0) || (b0 < 0 && b1 < 0 && b2 < 0) )
+        return false;
+
+    if( a0 == 0 && a1 == 0 && a2 == 0 )
+    {
+        plane_projection proj( p2, q2, r2 );
+
+        if( proj.Degenerate )
+            proj = plane_projection( p1, q1, r1 );
+
+        if( proj.Degenerate )
+            return false;
+
+        const math::vec2<double> u[3] = { proj( p1 ), proj( q1 ), proj( r1 ) };
+        const math::vec2<double> v[3] = { proj( p2 ), proj( q2 ), proj( r2 ) };
+
+        for( int i = 0; i < 3; ++i )
+            for( int j = 0; j < 3; ++j )
+                if( segments_intersect( u[i], u[(i+1)%3], v[j], v[(j+1)%3] ) )
+                    return true;
+
+        return point_in_triangle_2d( u[0], v[0], v[1], v[2] ) || point_in_triangle_2d( v[0], u[0], u[1], u[2] );
+    }
+
+    return segment_triangle_intersect( p1, q1, p2, q2, r2 ) || segment_triangle_intersect( q1, r1, p2, q2, r2 ) ||
+           segment_triangle_intersect( r1, p1, p2, q2, r2 ) || segment_triangle_intersect( p2, q2, p1, q1, r1 ) ||
+           segment_triangle_intersect( q2, r2, p1, q1, r1 ) || segment_triangle_intersect( r2, p2, p1, q1, r1 );
+}
+
+//!Cell index of a coordinate in a uniform grid of the given resolution
+template<typename Real>
+std::size_t grid_cell( const Real &v, const Real &origin, const Real &scale, std::size_t grid )
+{
+    using std::max;
+    using std::min;
+
+    return min( grid - 1, std::size_t( max( Real(0.0), (v - origin) * scale ) ) );
+}
+
+/*!
+\brief Triangulates a simple planar polygon using ear clipping
+\param poly a vector of points
+\param triangles a list to store the polygon indices of the triangles, three per triangle
+\return false if the polygon could not be clipped to the end (e.g. self intersections), the remainder is fanned
+
+The polygon is projected on the plane of the dominant normal axis and kept in an indexed
+doubly linked list. Only reflex vertices can lie inside an ear, so they are the only ones 
+stored, in a uniform grid that the ear test queries with the triangle bounding box. 
+The ear search advances around the polygon instead of restarting after every clip, which gives
+near-linear behaviour for polygons with thousands of vertices.
+*/
+template<typename PointVectorType, typename IndexListType>
+bool triangulate_polygon( const PointVectorType &poly, IndexListType &triangles )
+{
+    typedef typename PointVectorType::value_type vec_t;
+    typedef typename vec_t::real_t real_t;
+    typedef math::vec2<real_t> vec2_t;
+    using std::abs;
+    using std::min;
+    using std::max;
+
+    const std::size_t n = poly.size();
+
+    if( n < 3 )
+        return false;
+
+    if( n == 3 )
+    {
+        triangles.push_back(0);
+        triangles.push_back(1);
+        triangles.push_back(2);
+        return true;
+    }
+
+    //polygon normal, projected on the plane of its dominant axis
+    const vec_t &p0 = poly[0];
+    vec_t nrm = math::cross( poly[2] - p0, poly[1] - p0 );
+    for( std::size_t i = 2; (i+1) < n; ++i )
+        nrm += math::cross( poly[i+1] - p0, poly[i] - p0 );
+
+    unsigned int axis = 2;
+    if( abs( nrm.x ) > abs( nrm.y ) && abs( nrm.x ) > abs( nrm.z ) ) axis = 0;
+    else if( abs( nrm.y ) > abs( nrm.z ) ) axis = 1;
+
+    const unsigned int iu = (axis+1)%3, iv = (axis+2)%3;
+
+    std::vector< vec2_t > pts;
+    real_t area2 = real_t(0.0);
+
+    pts.reserve( n );
+    for( std::size_t i = 0; i < n; ++i )
+        pts.push_back( vec2_t( poly[i][iu], poly[i][iv] ) );
+
+    for( std::size_t i = 0, j = n-1; i < n; j = i++ )
+        area2 += (pts[j].x - pts[i].x) * (pts[j].y + pts[i].y);
+
+    //orientation of the projected polygon, the turns of convex vertices have this sign
+    const real_t sign = area2 < real_t(0.0) ? real_t(-1.0) : real_t(1.0);
+
+    std::vector< std::size_t > prev( n ), next( n );
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        prev[i] = (i + n - 1) % n;
+        next[i] = (i + 1) % n;
+    }
+
+    //reflex (and flat) vertices are the only ones that can block an ear
+    std::vector< char > blocker( n, 0 );
+    std::vector< std::size_t > reflex;
+
+    vec2_t bmin = pts[0], bmax = pts[0];
+
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        bmin.x = min( bmin.x, pts[i].x ); bmin.y = min( bmin.y, pts[i].y );
+        bmax.x = max( bmax.x, pts[i].x ); bmax.y = max( bmax.y, pts[i].y );
+
+        if( sign * orient2( pts[prev[i]], pts[i], pts[next[i]] ) <= real_t(0.0) )
+        {
+            blocker[i] = 1;
+            reflex.push_back( i );
+        }
+    }
+
+    //bucket the reflex vertices in a uniform grid with about one vertex per cell
+    std::size_t grid = 1;
+    while( grid * grid < reflex.size() ) ++grid;
+
+    const real_t su = (bmax.x > bmin.x) ? real_t(grid) / (bmax.x - bmin.x) : real_t(0.0);
+    const real_t sv = (bmax.y > bmin.y) ? real_t(grid) / (bmax.y - bmin.y) : real_t(0.0);
+
+    std::vector< std::size_t > cell_start( grid * grid + 1, 0 );
+    std::vector< std::size_t > cell_items( reflex.size() );
+    std::vector< std::size_t > reflex_cell( reflex.size() );
+
+    for( std::size_t k = 0; k < reflex.size(); ++k )
+    {
+        const vec2_t &p = pts[ reflex[k] ];
+        reflex_cell[k] = grid_cell( p.y, bmin.y, sv, grid ) * grid + grid_cell( p.x, bmin.x, su, grid );
+        ++cell_start[ reflex_cell[k] + 1 ];
+    }
+
+    for( std::size_t c = 0; c < grid * grid; ++c )
+        cell_start[c+1] += cell_start[c];
+
+    std::vector< std::size_t > cell_fill( cell_start.begin(), cell_start.end() - 1 );
+    for( std::size_t k = 0; k < reflex.size(); ++k )
+        cell_items[ cell_fill[ reflex_cell[k] ]++ ] = reflex[k];
+
+    std::size_t remaining = n;
+    std::size_t cur = 0, stop = 0;
+    bool allow_flat = false;        //second pass that also clips degenerate ears
+    bool success = true;
+
+    while( remaining > 3 )
+    {
+        const std::size_t a = prev[cur], b = cur, c = next[cur];
+        const double turn = sign * orient2( pts[a], pts[b], pts[c] );
+        bool ear = turn > 0.0 || (allow_flat && turn == 0.0);
+
+        if( ear && !reflex.empty() )
+        {
+            //check that no blocking vertex lies inside the triangle
+            const std::size_t cu0 = grid_cell( min( pts[a].x, min( pts[b].x, pts[c].x ) ), bmin.x, su, grid );
+            const std::size_t cu1 = grid_cell( max( pts[a].x, max( pts[b].x, pts[c].x ) ), bmin.x, su, grid );
+            const std::size_t cv0 = grid_cell( min( pts[a].y, min( pts[b].y, pts[c].y ) ), bmin.y, sv, grid );
+            const std::size_t cv1 = grid_cell( max( pts[a].y, max( pts[b].y, pts[c].y ) ), bmin.y, sv, grid );
+
+            for( std::size_t cv = cv0; ear && cv <= cv1; ++cv )
+                for( std::size_t cu = cu0; ear && cu <= cu1; ++cu )
+                {
+                    const std::size_t cell = cv * grid + cu;
+
+                    for( std::size_t k = cell_start[cell]; k < cell_start[cell+1]; ++k )
+                    {
+                        const std::size_t p = cell_items[k];
+
+                        if( !blocker[p] || p == a || p == b || p == c )
+                            continue;
+
+                        if( sign * orient2( pts[a], pts[b], pts[p] ) >= real_t(0.0) && 
+                            sign * orient2( pts[b], pts[c], pts[p] ) >= real_t(0.0) && 
+                            sign * orient2( pts[c], pts[a], pts[p] ) >= real_t(0.0) )
+                        {
+                            ear = false;
+                            break;
+                        }
+                    }
+                }
+        }
+
+        if( ear )
+        {
+            triangles.push_back(a);
+            triangles.push_back(b);
+            triangles.push_back(c);
+
+            //unlink the ear tip
+            next[a] = c;
+            prev[c] = a;
+            blocker[b] = 0;
+            --remaining;
+
+            //clipping only makes the neighbours more convex
+            if( blocker[a] && sign * orient2( pts[prev[a]], pts[a], pts[c] ) > real_t(0.0) ) blocker[a] = 0;
+            if( blocker[c] && sign * orient2( pts[a], pts[c], pts[next[c]] ) > real_t(0.0) ) blocker[c] = 0;
+
+            cur = stop = c;
+            allow_flat = false;
+            continue;
+        }
+
+        cur = c;
+
+        //a complete loop without any ear
+        if( cur == stop )
+        {
+            if( !allow_flat )
+            {
+                allow_flat = true;
+                continue;
+            }
+
+            std::cerr << "Failed to finish triangulation : " << remaining << "\n";
+            success = false;
+            break;
+        }
+    }
+
+    //add the remaining vertices as a fan
+    for( std::size_t i = next[cur]; next[i] != cur; i = next[i] )
+    {
+        triangles.push_back(cur);
+        triangles.push_back(i);
+        triangles.push_back(next[i]);
+    }
+
+    return success;
+}
+
 /*!
 \brief Triangulates a non-convex polygonal face using the ear-clipping algorithm
 \param f the face to triangulate
@@ -274,89 +810,117 @@ void triangulate( const FacePtr &f, VertexListType &triangles )
     typedef typename FacePtr::element_type face_t;
     typedef typename face_t::point_t vec_t;
     typedef typename face_t::vertex_ptr_t vertex_ptr_t;
-    typedef typename face_t::real_t real_t;
-    typedef std::pair< vertex_ptr_t, bool > vertex;
-    typedef std::list< vertex > list_t;
-    
-    list_t poly;
-
-    for( typename face_t::vertex_iterator_t i = f->verts_begin(); i != f->verts_end(); ++i )
-        poly.push_back( vertex( (*i), false ) );
 
+    std::vector< vertex_ptr_t > verts( f->verts_begin(), f->verts_end() );
     std::vector< vec_t > poly_points( f->points_begin(), f->points_end() );
+    std::vector< std::size_t > indices;
+
+    indices.reserve( 3 * verts.size() );
+    triangulate_polygon( poly_points, indices );
+
+    for( std::size_t i = 0; i < indices.size(); ++i )
+        triangles.push_back( verts[ indices[i] ] );
+}
+
+//!Options of the whole mesh triangulation
+struct triangulate_options
+{
+    triangulate_options() : keep_quads(false), threads(0) {}
+
+    //!leave the quads untouched
+    bool keep_quads;
+
+    //!number of threads, 0 for the default
+    int threads;
+};
+
+/*!
+\brief Triangulates all the polygonal faces of a mesh
+\param m the mesh
+\param options the triangulation options
+\return the number of faces that were triangulated
+
+The faces are triangulated in parallel into a staging buffer and the mesh connectivity is
+rebuilt once. Every polygon is replaced in place by its triangles, so the face order of the
+result depends only on the input and not on the number of threads.
+*/
+template<typename MeshType>
+std::size_t triangulate_mesh( MeshType &m, const triangulate_options &options = triangulate_options() )
+{
+    typedef typename MeshType::real_t real_t;
+    typedef typename MeshType::point_t point_t;
+
+    indexed_mesh< real_t > im;
+    make_indexed( m, im, options.threads );
+
+    const std::size_t faces = im.faces_size();
+
+    //every split polygon of n vertices is replaced by n-2 triangles
+    std::vector< char > split( faces, 0 );
+    std::vector< std::size_t > out_start( faces + 1, 0 );
+    std::vector< std::size_t > sizes;
+    std::size_t triangulated = 0;
 
-    //calculate a poly normal
-    const vec_t &p0 = poly_points[0];
-    vec_t n = math::cross( poly_points[2] - p0, poly_points[1] - p0 );
-    for( std::size_t i = 2; (i+1) < poly_points.size(); ++i )
-        n += math::cross( poly_points[i+1] - p0, poly_points[i] - p0 );
+    sizes.reserve( faces );
 
-    std::size_t reflex_vertices = 0;
-    for( typename list_t::iterator i = poly.begin(); i != poly.end(); ++i )
+    for( std::size_t f = 0; f < faces; ++f )
     {
-        typename list_t::iterator prev = i, next = i;
+        const std::size_t n = im.face_size( f );
 
-        const vertex_ptr_t &v0 = (prev == poly.begin() ? poly.back().first : (--prev)->first );
-        const vertex_ptr_t &v1 = i->first;
-        const vertex_ptr_t &v2 = (++next == poly.end() ? poly.front().first : next->first );
+        split[f] = n > 4 || (n == 4 && !options.keep_quads);
 
-        vec_t cs = math::cross( v0->point() - v1->point(), v2->point() - v1->point() );
-        if( dot( cs, n ) < -math::traits<real_t>::zero_tol )        //reflex vertex
+        if( split[f] )
         {
-            (*i).second = true;
-            ++reflex_vertices;
+            sizes.insert( sizes.end(), n - 2, 3 );
+            out_start[f+1] = out_start[f] + 3 * (n - 2);
+            ++triangulated;
+        }
+        else
+        {
+            sizes.push_back( n );
+            out_start[f+1] = out_start[f] + n;
         }
     }
 
-    //std::clog << "Reflex vertices : " << reflex_vertices << "\n";
-    bool ear_found = true;
+    if( triangulated == 0 )
+        return 0;
+
+    std::vector< uid_t > indices( out_start.back() );
 
-    while( poly.size() > 3 && ear_found )
+    #pragma omp parallel num_threads( parallel_threads( options.threads ) )
     {
-        ear_found = false;
+        std::vector< point_t > poly;
+        std::vector< std::size_t > tris;
 
-        for( typename list_t::iterator i = poly.begin(); i != poly.end(); ++i )
+        #pragma omp for schedule(dynamic,256)
+        for( std::ptrdiff_t f = 0; f < std::ptrdiff_t( faces ); ++f )
         {
-            typename list_t::iterator prev = i, next = i;
-
-            const vertex_ptr_t &v0 = (prev == poly.begin() ? poly.back().first : (--prev)->first );
-            const vertex_ptr_t &v1 = i->first;
-            const vertex_ptr_t &v2 = (++next == poly.end() ? poly.front().first : next->first );
-
-            vec_t cs = math::cross( v0->point() - v1->point(), v2->point() - v1->point() );
-            
-            //if( dot( cs, n ) >= real_t(-0.000001) )       //convex vertex
-            if( dot( cs, n ) >= -math::traits<real_t>::zero_tol )       //convex vertex
-            {       
-                if( is_ear(poly.begin(),poly.end(), v0, v1, v2) )
-                {
-                    ear_found = true;
+            const uid_t *fv = &im.face_verts[ im.face_start[f] ];
+            const std::size_t n = im.face_size( f );
+            uid_t *out = &indices[ out_start[f] ];
 
-                    triangles.push_back(v0);
-                    triangles.push_back(v1);
-                    triangles.push_back(v2);
+            if( !split[f] )
+            {
+                std::copy( fv, fv + n, out );
+                continue;
+            }
 
-                    poly.erase( i );
-                    break;
-                }
+            poly.resize( n );
+            for( std::size_t k = 0; k < n; ++k )
+                poly[k] = im.points[ fv[k] ];
 
-                (*i).second = false;        //convex vertex
-            }
+            tris.clear();
+            triangulate_polygon( poly, tris );
+
+            for( std::size_t k = 0; k < tris.size(); ++k )
+                out[k] = fv[ tris[k] ];
         }
     }
 
-    if( poly.size() > 3 )
-        std::cerr << "Failed to finish triangulation : " << poly.size() << "\n";
+    typename MeshType::vertex_array_t verts( m.verts_begin(), m.verts_end() );
+    m.rebuild( verts, sizes, indices );
 
-    //add the last 3 vertices as a triangle
-    typename list_t::iterator i = poly.begin();
-    const vertex_ptr_t &v0 = i->first; 
-    const vertex_ptr_t &v1 = (++i)->first;
-    const vertex_ptr_t &v2 = (++i)->first;
-    
-    triangles.push_back(v0);
-    triangles.push_back(v1);
-    triangles.push_back(v2);
+    return triangulated;
 }
 
 }
@@ -0,0 +1,252 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#ifndef GEOMETRY_BOUNDARY_H
+#define GEOMETRY_BOUNDARY_H
+
+#include "Algorithms.h"
+#include "Indexed.h"
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <vector>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Calculates the length of a closed loop of vertices
+\param loop a vector of vertices
+*/
+template<typename VertexVectorType>
+double perimeter( const VertexVectorType &loop )
+{
+    double length = 0.0;
+
+    for( std::size_t i = 0; i < loop.size(); ++i )
+        length += math::distance( loop[i]->point(), loop[ (i + 1) % loop.size() ]->point() );
+
+    return length;
+}
+
+/*!
+\brief Extracts the closed loops of the free edges of a mesh
+\param m the mesh
+\param loops the vertices of every closed loop in order
+\return the number of loops found
+
+The loops are followed in a single pass over the free edges with a bitset of the visited
+ones. Each loop runs opposite to the faces of its edges, so it can be added as a face
+with the orientation of the surface. At a vertex shared by several holes the loop turns
+through the fan of faces to the free edge of the same hole. Open chains of free edges
+are skipped.
+*/
+template<typename MeshType>
+std::size_t boundary_loops( const MeshType &m, std::vector< typename MeshType::vertex_array_t > &loops )
+{
+    typedef typename MeshType::vertex_array_t vertex_array_t;
+
+    loops.clear();
+
+    indexed_mesh< typename MeshType::real_t > im;
+    make_indexed( m, im );
+
+    const std::size_t verts = im.verts_size();
+    const std::size_t edges = im.edges_size();
+
+    //the number of faces and the direction of the free edges in their face
+    std::vector< unsigned int > edge_faces( edges, 0 );
+    std::vector< uid_t > edge_from( edges, NO_ID );
+
+    //the face of every corner and the corners of the manifold edges
+    std::vector< uid_t > corner_face( im.face_verts.size() );
+    std::vector< uid_t > edge_corners( 2 * edges, NO_ID );
+
+    for( std::size_t f = 0; f < im.faces_size(); ++f )
+    {
+        for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+        {
+            const uid_t e = im.face_edges[k];
+
+            if( edge_faces[e] < 2 )
+                edge_corners[ 2 * e + edge_faces[e] ] = k;
+
+            ++edge_faces[e];
+            edge_from[e] = im.face_verts[k];
+            corner_face[k] = f;
+        }
+    }
+
+    //the free edges around every vertex
+    std::vector< uid_t > vert_start( verts + 1, 0 );
+
+    for( std::size_t e = 0; e < edges; ++e )
+    {
+        if( edge_faces[e] != 1 )
+            continue;
+
+        ++vert_start[ im.edge_verts[ 2 * e ] + 1 ];
+        ++vert_start[ im.edge_verts[ 2 * e + 1 ] + 1 ];
+    }
+
+    for( std::size_t v = 0; v < verts; ++v )
+        vert_start[v+1] += vert_start[v];
+
+    std::vector< uid_t > vert_edges( vert_start.back() );
+    std::vector< uid_t > fill( vert_start.begin(), vert_start.end() - 1 );
+
+    for( std::size_t e = 0; e < edges; ++e )
+    {
+        if( edge_faces[e] != 1 )
+            continue;
+
+        vert_edges[ fill[ im.edge_verts[ 2 * e ] ]++ ] = e;
+        vert_edges[ fill[ im.edge_verts[ 2 * e + 1 ] ]++ ] = e;
+    }
+
+    boost::dynamic_bitset<> visited( edges );
+    std::vector< uid_t > loop;
+
+    for( std::size_t e = 0; e < edges; ++e )
+    {
+        if( edge_faces[e] != 1 || visited[e] )
+            continue;
+
+        visited[e] = true;
+
+        //walk against the direction of the face
+        const uid_t start = (edge_from[e] == im.edge_verts[ 2 * e ]) ? im.edge_verts[ 2 * e + 1 ] : im.edge_verts[ 2 * e ];
+        uid_t v = edge_from[e];
+        uid_t cur = e;
+        bool closed = true;
+
+        loop.clear();
+        loop.push_back( start );
+
+        while( v != start )
+        {
+            loop.push_back( v );
+
+            //turn around v through the faces of the fan until the next free edge,
+            //so two holes pinched at v are not joined into a single loop
+            uid_t next = NO_ID;
+            uid_t k = edge_corners[ 2 * cur ];
+
+            for( std::size_t turns = 0; turns < corner_face.size(); ++turns )
+            {
+                const uid_t f = corner_face[k];
+                const uid_t p = (k == im.face_start[f]) ? im.face_start[f+1] - 1 : k - 1;
+                const uid_t pe = im.face_edges[p];
+
+                if( edge_faces[pe] == 1 )
+                {
+                    if( !visited[pe] )
+                        next = pe;
+                    break;
+                }
+
+                const uid_t o = (edge_corners[ 2 * pe ] == p) ? edge_corners[ 2 * pe + 1 ] : edge_corners[ 2 * pe ];
+                if( edge_faces[pe] != 2 || im.face_verts[o] != v )
+                    break;
+
+                k = o;
+            }
+
+            //non manifold or flipped fans fall back to any free edge ending at v
+            for( uid_t j = vert_start[v]; next == NO_ID && j < vert_start[v+1]; ++j )
+            {
+                if( !visited[ vert_edges[j] ] && edge_from[ vert_edges[j] ] != v )
+                    next = vert_edges[j];
+            }
+
+            if( next == NO_ID )
+            {
+                closed = false;
+                break;
+            }
+
+            visited[next] = true;
+            cur = next;
+            v = (im.edge_verts[ 2 * next ] == v) ? im.edge_verts[ 2 * next + 1 ] : im.edge_verts[ 2 * next ];
+        }
+
+        if( !closed )
+            continue;
+
+        loops.push_back( vertex_array_t() );
+        loops.back().reserve( loop.size() );
+
+        for( std::size_t i = 0; i < loop.size(); ++i )
+            loops.back().push_back( *(m.verts_begin() + loop[i]) );
+    }
+
+    return loops.size();
+}
+
+/*!
+\brief Covers the holes of a mesh with triangles
+\param m the mesh
+\param max_perimeter only the holes with a smaller perimeter are filled
+\return the number of holes filled
+\note there is no check for non planar holes or for the shape of the hole
+*/
+template<typename MeshType>
+std::size_t fill_holes( MeshType &m, double max_perimeter )
+{
+    typedef typename MeshType::vertex_array_t vertex_array_t;
+    typedef typename MeshType::face_t face_t;
+    typedef typename MeshType::face_ptr_t face_ptr_t;
+
+    std::vector< vertex_array_t > loops;
+    boundary_loops( m, loops );
+
+    std::size_t filled = 0;
+    vertex_array_t triangles;
+
+    for( std::size_t i = 0; i < loops.size(); ++i )
+    {
+        if( loops[i].size() < 3 || perimeter( loops[i] ) > max_perimeter )
+            continue;
+
+        face_ptr_t hole( new face_t( loops[i].begin(), loops[i].end() ) );
+
+        triangles.clear();
+        triangulate( hole, triangles );
+
+        for( std::size_t k = 0; k + 2 < triangles.size(); k += 3 )
+            m.add_face( face_ptr_t( new face_t( triangles.begin() + k, triangles.begin() + k + 3 ) ) );
+
+        ++filled;
+    }
+
+    return filled;
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,1003 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_BVH_H
+#define GEOMETRY_BVH_H
+
+#include "Algorithms.h"
+#include "Indexed.h"
+#include "Parallel.h"
+#include "../Math/Simd.h"
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Axis aligned box in single precision, rounded outwards from the points it bounds
+struct bvh_box
+{
+    bvh_box() { clear(); }
+
+    void clear()
+    {
+        lo[0] = lo[1] = lo[2] = FLT_MAX;
+        hi[0] = hi[1] = hi[2] = -FLT_MAX;
+    }
+
+    template<typename vec_t>
+    void grow( const vec_t &p )
+    {
+        grow( 0, p.x ); grow( 1, p.y ); grow( 2, p.z );
+    }
+
+    void grow( const bvh_box &b )
+    {
+        for( int k = 0; k < 3; ++k )
+        {
+            lo[k] = std::min( lo[k], b.lo[k] );
+            hi[k] = std::max( hi[k], b.hi[k] );
+        }
+    }
+
+    //!half of the surface area, the surface area heuristic only compares them
+    float area()const
+    {
+        if( lo[0] > hi[0] )
+            return 0.0f;
+
+        const float dx = hi[0] - lo[0], dy = hi[1] - lo[1], dz = hi[2] - lo[2];
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    bool overlaps( const bvh_box &b )const
+    {
+        return lo[0] <= b.hi[0] && b.lo[0] <= hi[0] && 
+               lo[1] <= b.hi[1] && b.lo[1] <= hi[1] && 
+               lo[2] <= b.hi[2] && b.lo[2] <= hi[2];
+    }
+
+    float lo[3], hi[3];
+
+private:
+    template<typename Real>
+    void grow( int k, Real v )
+    {
+        //the float next to v on the outer side keeps the box conservative for double points
+        float down = float( v ), up = float( v );
+
+        if( Real( down ) > v )
+            down -= std::fabs( down ) * FLT_EPSILON + FLT_MIN;
+        if( Real( up ) < v )
+            up += std::fabs( up ) * FLT_EPSILON + FLT_MIN;
+
+        lo[k] = std::min( lo[k], down );
+        hi[k] = std::max( hi[k], up );
+    }
+};
+
+/*!
+\brief Node of the flattened hierarchy
+
+The nodes are stored in depth first order so the left child of an inner node is the next node 
+and only the right child is stored. 32 bytes per node, two nodes per cache line.
+*/
+struct bvh_node
+{
+    float lo[3];
+
+    //!right child of an inner node, first triangle of a leaf
+    boost::uint32_t offset;
+
+    float hi[3];
+
+    //!number of triangles of a leaf, 0 for the inner nodes
+    boost::uint32_t count;
+
+    bool leaf()const { return count != 0; }
+};
+
+//!Triangle of a face, the polygons are split in triangles that keep the id of their face
+struct bvh_triangle
+{
+    uid_t v[3];
+    uid_t face;
+};
+
+/*!
+\brief Bounding volume hierarchy over the faces of a mesh
+
+The hierarchy is built with the surface area heuristic over 12 bins per axis. The top levels are 
+split with the binning in parallel and the subtrees below them are built in parallel, then the 
+whole tree is flattened to depth first order with single precision boxes. The queries are 
+const and can run from many threads at once.
+
+refit() updates the boxes after the vertices were moved with set_point, the topology and the 
+tree structure are kept.
+*/
+template<typename Real>
+class face_bvh
+{
+public:
+    typedef Real real_t;
+    typedef math::vec3< Real > point_t;
+
+    //!Result of the closest point query
+    struct closest_t
+    {
+        uid_t face;
+        point_t point;
+        real_t distance;
+    };
+
+    //!Result of the ray query
+    struct hit_t
+    {
+        uid_t face;
+        real_t t, u, v;
+    };
+
+    face_bvh() : Threads(0) {}
+
+    //!builds the hierarchy of a mesh
+    template<typename MeshType>
+    explicit face_bvh( const MeshType &m, int threads = 0 ) : Threads( threads )
+    {
+        indexed_mesh< Real > im;
+        make_indexed( m, im, threads );
+        build( im );
+    }
+
+    //!builds the hierarchy of an indexed mesh
+    explicit face_bvh( const indexed_mesh< Real > &im, int threads = 0 ) : Threads( threads )
+    {
+        build( im );
+    }
+
+    void build( const indexed_mesh< Real > &im );
+
+    //!reads the moved vertex coordinates of the mesh and updates the boxes
+    template<typename MeshType>
+    void refit( const MeshType &m )
+    {
+        typename MeshType::vertex_iterator_t vb = m.verts_begin();
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+        for( std::ptrdiff_t i = 0; i < std::ptrdiff_t( Points.size() ); ++i )
+            Points[ vb[i]->id() ] = vb[i]->point();
+
+        refit_boxes();
+    }
+
+    //!updates the boxes after changing the coordinates in points()
+    void refit_boxes();
+
+    /*!
+    \brief The point of the surface closest to p
+    \param p the query point
+    \param r the face, the point and its distance
+    \param max_distance only points closer than this are searched
+    \return false if there is no face closer than max_distance
+    */
+    bool closest_point( const point_t &p, closest_t &r, real_t max_distance = std::numeric_limits< Real >::max() )const;
+
+    /*!
+    \brief The first face hit by a ray
+    \param origin the origin of the ray
+    \param dir the direction of the ray, t is measured in its length
+    \param r the face, the ray parameter and the barycentric coordinates of the hit
+    \param max_t only hits before this parameter are searched
+    \return false if the ray hits no face
+    */
+    bool ray_hit( const point_t &origin, const point_t &dir, hit_t &r, real_t max_t = std::numeric_limits< Real >::max() )const;
+
+    /*!
+    \brief The faces with a triangle whose box overlaps a box
+    \param lo the lower corner of the box
+    \param hi the upper corner of the box
+    \param faces the face ids are appended once each in increasing order
+    \return the number of faces found
+    */
+    std::size_t box_overlap( const point_t &lo, const point_t &hi, std::vector< uid_t > &faces )const;
+
+    const std::vector< bvh_node > &nodes()const { return Nodes; }
+    const std::vector< bvh_triangle > &triangles()const { return Triangles; }
+    std::vector< point_t > &points() { return Points; }
+    const std::vector< point_t > &points()const { return Points; }
+
+    //!box of a triangle of triangles()
+    bvh_box triangle_box( const bvh_triangle &t )const
+    {
+        bvh_box b;
+        b.grow( Points[ t.v[0] ] );
+        b.grow( Points[ t.v[1] ] );
+        b.grow( Points[ t.v[2] ] );
+        return b;
+    }
+
+private:
+    enum { BINS = 12, MAX_LEAF = 8, MAX_SAH_DEPTH = 48, STACK = 128 };
+
+    //!box of a triangle and its index while building, the ranges of nodes are partitioned in place
+    struct build_ref
+    {
+        bvh_box box;
+        uid_t index;
+
+        //!twice the centroid, only the order matters to the binning
+        float center( int k )const { return box.lo[k] + box.hi[k]; }
+    };
+
+    //!boxes, boxes of the centers and counts of the bins
+    struct bin_set
+    {
+        bin_set() { std::fill( count, count + BINS, uid_t( 0 ) ); }
+
+        void merge( const bin_set &o )
+        {
+            for( int b = 0; b < BINS; ++b )
+            {
+                box[b].grow( o.box[b] );
+                center[b].grow( o.center[b] );
+                count[b] += o.count[b];
+            }
+        }
+
+        bvh_box box[BINS], center[BINS];
+        uid_t count[BINS];
+    };
+
+    //!orders the triangles by their center along an axis
+    struct center_less
+    {
+        explicit center_less( int axis ) : Axis( axis ) {}
+
+        bool operator()( const build_ref &a, const build_ref &b )const { return a.center( Axis ) < b.center( Axis ); }
+
+        int Axis;
+    };
+
+    //!true for the triangles whose center falls in the bins up to bin
+    struct bin_less
+    {
+        bin_less( int axis, float lo, float scale, int bin ) : Axis( axis ), Lo( lo ), Scale( scale ), Bin( bin ) {}
+
+        bool operator()( const build_ref &r )const { return bin_of( r.center( Axis ), Lo, Scale ) <= Bin; }
+
+        int Axis;
+        float Lo, Scale;
+        int Bin;
+    };
+
+    //!node of the tree under construction, left is NO_ID for the leaves
+    struct build_node
+    {
+        bvh_box box;
+        uid_t left, right;
+        uid_t begin, end;
+    };
+
+    //!subtree left for the parallel phase
+    struct build_task
+    {
+        uid_t node;
+        uid_t begin, end;
+        int depth;
+        bvh_box box, center;
+    };
+
+    static int bin_of( float c, float lo, float scale )
+    {
+        return std::min( int( (c - lo) * scale ), int( BINS ) - 1 );
+    }
+
+    void bin( uid_t begin, uid_t end, int axis, float lo, float scale, bin_set &bins )const;
+    void range_boxes( uid_t begin, uid_t end, bvh_box &box, bvh_box &center )const;
+    bool split( uid_t begin, uid_t end, int depth, const bvh_box &box, const bvh_box &center, uid_t &mid, 
+                bvh_box *child_box, bvh_box *child_center );
+    void build_subtree( std::vector< build_node > &nodes, uid_t node, uid_t begin, uid_t end, int depth, 
+                        const bvh_box &box, const bvh_box &center, std::vector< build_task > *tasks, int task_depth );
+    void flatten( const std::vector< build_node > &nodes );
+
+    static float box_distance( const bvh_node &n, const point_t &p )
+    {
+        float d = 0.0f;
+
+        for( int k = 0; k < 3; ++k )
+        {
+            const float v = float( p[k] );
+            const float e = std::max( std::max( n.lo[k] - v, v - n.hi[k] ), 0.0f );
+            d += e * e;
+        }
+
+        return d;
+    }
+
+    int Threads;
+
+    std::vector< point_t > Points;
+    std::vector< bvh_triangle > Triangles;
+    std::vector< bvh_node > Nodes;
+
+    //!build state
+    std::vector< build_ref > Refs;
+};
+
+template<typename Real>
+void face_bvh<Real>::build( const indexed_mesh< Real > &im )
+{
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+
+    Points = im.points;
+
+    //a polygon of n vertices gives n-2 triangles
+    std::vector< uid_t > start( nf + 1, 0 );
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        start[f+1] = start[f] + (im.face_size( f ) >= 3 ? im.face_size( f ) - 2 : 0);
+
+    Triangles.resize( start[nf] );
+
+    #pragma omp parallel num_threads( parallel_threads( Threads ) )
+    {
+        std::vector< point_t > poly;
+        std::vector< std::size_t > tris;
+
+        #pragma omp for schedule(dynamic,1024)
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+        {
+            const uid_t *fv = &im.face_verts[0] + im.face_start[f];
+            const std::size_t n = im.face_size( f );
+            bvh_triangle *out = &Triangles[0] + start[f];
+
+            if( n < 3 )
+                continue;
+
+            tris.clear();
+
+            if( n > 3 )
+            {
+                poly.resize( n );
+                for( std::size_t k = 0; k < n; ++k )
+                    poly[k] = im.points[ fv[k] ];
+
+                triangulate_polygon( poly, tris );
+            }
+
+            //a fan if the polygon could not be triangulated completely
+            if( tris.size() != 3 * (n - 2) )
+            {
+                tris.clear();
+                for( std::size_t k = 1; k + 1 < n; ++k )
+                {
+                    tris.push_back( 0 );
+                    tris.push_back( k );
+                    tris.push_back( k + 1 );
+                }
+            }
+
+            for( std::size_t k = 0; k < n - 2; ++k, ++out )
+            {
+                out->v[0] = fv[ tris[ 3 * k ] ];
+                out->v[1] = fv[ tris[ 3 * k + 1 ] ];
+                out->v[2] = fv[ tris[ 3 * k + 2 ] ];
+                out->face = uid_t( f );
+            }
+        }
+    }
+
+    const std::ptrdiff_t nt = std::ptrdiff_t( Triangles.size() );
+
+    Refs.resize( nt );
+
+    #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+    for( std::ptrdiff_t i = 0; i < nt; ++i )
+    {
+        Refs[i].box = triangle_box( Triangles[i] );
+        Refs[i].index = uid_t( i );
+    }
+
+    Nodes.clear();
+
+    if( nt == 0 )
+    {
+        Refs.clear();
+        return;
+    }
+
+    //the top levels are split serially until there are a few subtrees per thread
+    const int threads = parallel_threads( Threads );
+    int task_depth = 0;
+    while( (1 << task_depth) < 4 * threads && task_depth < 16 )
+        ++task_depth;
+
+    std::vector< build_node > nodes( 1 );
+    std::vector< build_task > tasks;
+    bvh_box box, center;
+
+    range_boxes( 0, uid_t( nt ), box, center );
+    build_subtree( nodes, 0, 0, uid_t( nt ), 0, box, center, threads > 1 ? &tasks : 0, task_depth );
+
+    if( !tasks.empty() )
+    {
+        std::vector< std::vector< build_node > > local( tasks.size() );
+
+        #pragma omp parallel for num_threads( threads ) schedule(dynamic,1)
+        for( std::ptrdiff_t t = 0; t < std::ptrdiff_t( tasks.size() ); ++t )
+        {
+            const build_task &task = tasks[t];
+
+            local[t].resize( 1 );
+            build_subtree( local[t], 0, task.begin, task.end, task.depth, task.box, task.center, 0, 0 );
+        }
+
+        //the root of a subtree replaces its placeholder and the other nodes are appended
+        for( std::size_t t = 0; t < tasks.size(); ++t )
+        {
+            const uid_t base = uid_t( nodes.size() ) - 1;
+
+            for( std::size_t i = 0; i < local[t].size(); ++i )
+            {
+                build_node n = local[t][i];
+
+                if( n.left != NO_ID )
+                {
+                    n.left += base;
+                    n.right += base;
+                }
+
+                if( i == 0 )
+                    nodes[ tasks[t].node ] = n;
+                else
+                    nodes.push_back( n );
+            }
+        }
+    }
+
+    flatten( nodes );
+
+    //the triangles follow the order of the leaves
+    std::vector< bvh_triangle > sorted( nt );
+
+    #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+    for( std::ptrdiff_t i = 0; i < nt; ++i )
+        sorted[i] = Triangles[ Refs[i].index ];
+
+    Triangles.swap( sorted );
+    std::vector< build_ref >().swap( Refs );
+}
+
+template<typename Real>
+void face_bvh<Real>::range_boxes( uid_t begin, uid_t end, bvh_box &box, bvh_box &center )const
+{
+    box.clear();
+    center.clear();
+
+    for( uid_t i = begin; i < end; ++i )
+    {
+        const build_ref &r = Refs[i];
+
+        box.grow( r.box );
+
+        for( int k = 0; k < 3; ++k )
+        {
+            center.lo[k] = std::min( center.lo[k], r.center( k ) );
+            center.hi[k] = std::max( center.hi[k], r.center( k ) );
+        }
+    }
+}
+
+//!the large ranges of the top levels are binned in parallel
+template<typename Real>
+void face_bvh<Real>::bin( uid_t begin, uid_t end, int axis, float lo, float scale, bin_set &bins )const
+{
+    const std::ptrdiff_t n = std::ptrdiff_t( end - begin );
+    const int threads = n > 65536 ? parallel_threads( Threads ) : 1;
+
+    std::vector< bin_set > partial( threads - 1 );
+
+    #pragma omp parallel num_threads( threads )
+    {
+        const int id = parallel_thread_id();
+        bin_set &b = id == 0 ? bins : partial[ id - 1 ];
+
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t i = 0; i < n; ++i )
+        {
+            const build_ref &r = Refs[ begin + i ];
+            const int k = bin_of( r.center( axis ), lo, scale );
+
+            b.box[k].grow( r.box );
+            ++b.count[k];
+
+            for( int c = 0; c < 3; ++c )
+            {
+                b.center[k].lo[c] = std::min( b.center[k].lo[c], r.center( c ) );
+                b.center[k].hi[c] = std::max( b.center[k].hi[c], r.center( c ) );
+            }
+        }
+    }
+
+    for( std::size_t i = 0; i < partial.size(); ++i )
+        bins.merge( partial[i] );
+}
+
+/*!
+Partitions Refs[begin,end) and returns false if the range should be a leaf. Below 
+MAX_SAH_DEPTH the split is the best plane of the binned surface area heuristic along the 
+widest axis of the centers, deeper or when all the centers coincide the range is split at the 
+median. The boxes of the children come from the bins so every node reads its triangles once.
+*/
+template<typename Real>
+bool face_bvh<Real>::split( uid_t begin, uid_t end, int depth, const bvh_box &box, const bvh_box &center, uid_t &mid, 
+                            bvh_box *child_box, bvh_box *child_center )
+{
+    const uid_t n = end - begin;
+
+    if( n <= 4 )
+        return false;
+
+    int axis = 0;
+    for( int k = 1; k < 3; ++k )
+        if( center.hi[k] - center.lo[k] > center.hi[axis] - center.lo[axis] )
+            axis = k;
+
+    const float extent = center.hi[axis] - center.lo[axis];
+
+    if( depth < MAX_SAH_DEPTH && extent > 0.0f )
+    {
+        const float scale = float( BINS ) / extent;
+        bin_set bins;
+
+        bin( begin, end, axis, center.lo[axis], scale, bins );
+
+        //sweep from the right, then from the left evaluating every plane between the bins
+        float right_area[BINS];
+        uid_t right_count[BINS];
+        bvh_box acc;
+        uid_t count = 0;
+
+        for( int b = BINS - 1; b > 0; --b )
+        {
+            acc.grow( bins.box[b] );
+            count += bins.count[b];
+            right_area[b] = acc.area();
+            right_count[b] = count;
+        }
+
+        int best_bin = -1;
+        float best_cost = std::numeric_limits< float >::max();
+
+        acc.clear();
+        count = 0;
+
+        for( int b = 0; b < BINS - 1; ++b )
+        {
+            acc.grow( bins.box[b] );
+            count += bins.count[b];
+
+            if( count == 0 || right_count[b+1] == 0 )
+                continue;
+
+            const float cost = acc.area() * float( count ) + right_area[b+1] * float( right_count[b+1] );
+
+            if( cost < best_cost )
+            {
+                best_cost = cost;
+                best_bin = b;
+            }
+        }
+
+        if( best_bin >= 0 )
+        {
+            //a small range stays a leaf if intersecting all its triangles is cheaper than a traversal step
+            if( n <= MAX_LEAF && best_cost + box.area() >= box.area() * float( n ) )
+                return false;
+
+            build_ref *m = std::partition( &Refs[0] + begin, &Refs[0] + end, 
+                bin_less( axis, center.lo[axis], scale, best_bin ) );
+
+            mid = uid_t( m - &Refs[0] );
+
+            for( int c = 0; c < 2; ++c )
+            {
+                child_box[c].clear();
+                child_center[c].clear();
+            }
+
+            for( int b = 0; b < BINS; ++b )
+            {
+                const int c = b <= best_bin ? 0 : 1;
+
+                child_box[c].grow( bins.box[b] );
+                child_center[c].grow( bins.center[b] );
+            }
+
+            return true;
+        }
+    }
+
+    if( n <= MAX_LEAF )
+        return false;
+
+    mid = begin + n / 2;
+    std::nth_element( &Refs[0] + begin, &Refs[0] + mid, &Refs[0] + end, center_less( axis ) );
+
+    range_boxes( begin, mid, child_box[0], child_center[0] );
+    range_boxes( mid, end, child_box[1], child_center[1] );
+
+    return true;
+}
+
+template<typename Real>
+void face_bvh<Real>::build_subtree( std::vector< build_node > &nodes, uid_t node, uid_t begin, uid_t end, int depth, 
+                                    const bvh_box &box, const bvh_box &center, std::vector< build_task > *tasks, int task_depth )
+{
+    nodes[node].box = box;
+    nodes[node].begin = begin;
+    nodes[node].end = end;
+    nodes[node].left = nodes[node].right = NO_ID;
+
+    if( tasks && depth >= task_depth )
+    {
+        build_task t = { node, begin, end, depth, box, center };
+        tasks->push_back( t );
+        return;
+    }
+
+    uid_t mid = 0;
+    bvh_box child_box[2], child_center[2];
+
+    if( !split( begin, end, depth, box, center, mid, child_box, child_center ) )
+        return;
+
+    const uid_t left = uid_t( nodes.size() );
+    nodes.resize( nodes.size() + 2 );
+    nodes[node].left = left;
+    nodes[node].right = left + 1;
+
+    build_subtree( nodes, left, begin, mid, depth + 1, child_box[0], child_center[0], tasks, task_depth );
+    build_subtree( nodes, left + 1, mid, end, depth + 1, child_box[1], child_center[1], tasks, task_depth );
+}
+
+template<typename Real>
+void face_bvh<Real>::flatten( const std::vector< build_node > &nodes )
+{
+    Nodes.resize( nodes.size() );
+
+    //depth first, the right child is pushed first and patched into its parent when it is written
+    std::vector< std::pair< uid_t, uid_t > > stack( 1, std::make_pair( uid_t( 0 ), NO_ID ) );
+    boost::uint32_t next = 0;
+
+    while( !stack.empty() )
+    {
+        const uid_t i = stack.back().first, parent = stack.back().second;
+        stack.pop_back();
+
+        const build_node &b = nodes[i];
+        bvh_node &n = Nodes[next];
+
+        for( int k = 0; k < 3; ++k )
+        {
+            n.lo[k] = b.box.lo[k];
+            n.hi[k] = b.box.hi[k];
+        }
+
+        if( parent != NO_ID )
+            Nodes[ parent ].offset = next;
+
+        if( b.left == NO_ID )
+        {
+            n.offset = boost::uint32_t( b.begin );
+            n.count = boost::uint32_t( b.end - b.begin );
+        }
+        else
+        {
+            n.count = 0;
+            stack.push_back( std::make_pair( b.right, uid_t( next ) ) );
+            stack.push_back( std::make_pair( b.left, NO_ID ) );
+        }
+
+        ++next;
+    }
+}
+
+template<typename Real>
+void face_bvh<Real>::refit_boxes()
+{
+    const std::ptrdiff_t nn = std::ptrdiff_t( Nodes.size() );
+
+    //the leaves in parallel, then the inner nodes after their children which come later
+    #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(dynamic,1024)
+    for( std::ptrdiff_t i = 0; i < nn; ++i )
+    {
+        bvh_node &n = Nodes[i];
+
+        if( !n.leaf() )
+            continue;
+
+        bvh_box b;
+        for( boost::uint32_t t = n.offset; t < n.offset + n.count; ++t )
+            b.grow( triangle_box( Triangles[t] ) );
+
+        for( int k = 0; k < 3; ++k )
+        {
+            n.lo[k] = b.lo[k];
+            n.hi[k] = b.hi[k];
+        }
+    }
+
+    for( std::ptrdiff_t i = nn - 1; i >= 0; --i )
+    {
+        bvh_node &n = Nodes[i];
+
+        if( n.leaf() )
+            continue;
+
+        const bvh_node &l = Nodes[ i + 1 ], &r = Nodes[ n.offset ];
+
+        for( int k = 0; k < 3; ++k )
+        {
+            n.lo[k] = std::min( l.lo[k], r.lo[k] );
+            n.hi[k] = std::max( l.hi[k], r.hi[k] );
+        }
+    }
+}
+
+template<typename Real>
+bool face_bvh<Real>::closest_point( const point_t &p, closest_t &r, real_t max_distance )const
+{
+    if( Nodes.empty() )
+        return false;
+
+    real_t best = max_distance < std::sqrt( std::numeric_limits< Real >::max() ) ? 
+        max_distance * max_distance : std::numeric_limits< Real >::max();
+    bool found = false;
+
+    boost::uint32_t stack[STACK];
+    int top = 0;
+    stack[top++] = 0;
+
+    while( top > 0 )
+    {
+        const bvh_node &n = Nodes[ stack[--top] ];
+
+        if( real_t( box_distance( n, p ) ) > best )
+            continue;
+
+        if( n.leaf() )
+        {
+            for( boost::uint32_t i = n.offset; i < n.offset + n.count; ++i )
+            {
+                const bvh_triangle &t = Triangles[i];
+                const point_t q = closest_point_triangle( p, Points[ t.v[0] ], Points[ t.v[1] ], Points[ t.v[2] ] );
+                const point_t d = q - p;
+                const real_t d2 = math::dot( d, d );
+
+                if( d2 <= best )
+                {
+                    best = d2;
+                    r.face = t.face;
+                    r.point = q;
+                    found = true;
+                }
+            }
+
+            continue;
+        }
+
+        //the nearer child is visited first
+        const boost::uint32_t left = boost::uint32_t( &n - &Nodes[0] ) + 1, right = n.offset;
+
+        if( box_distance( Nodes[left], p ) <= box_distance( Nodes[right], p ) )
+        {
+            stack[top++] = right;
+            stack[top++] = left;
+        }
+        else
+        {
+            stack[top++] = left;
+            stack[top++] = right;
+        }
+    }
+
+    if( found )
+        r.distance = std::sqrt( best );
+
+    return found;
+}
+
+/*!
+The ray is tested against the boxes four lanes at a time with SSE, the fourth lane carries the 
+offset and count words of the node and is masked out.
+*/
+template<typename Real>
+bool face_bvh<Real>::ray_hit( const point_t &origin, const point_t &dir, hit_t &r, real_t max_t )const
+{
+    if( Nodes.empty() )
+        return false;
+
+    float o[4], inv[4];
+    for( int k = 0; k < 3; ++k )
+    {
+        o[k] = float( origin[k] );
+        inv[k] = 1.0f / float( dir[k] );
+    }
+    o[3] = inv[3] = 0.0f;
+
+    real_t best = max_t;
+    bool found = false;
+
+#ifdef ARCH_SSE
+    const __m128 so = _mm_loadu_ps( o ), sinv = _mm_loadu_ps( inv );
+    const __m128 mask = _mm_castsi128_ps( _mm_set_epi32( 0, -1, -1, -1 ) );
+    const __m128 neg_inf = _mm_set1_ps( -FLT_MAX ), pos_inf = _mm_set1_ps( FLT_MAX );
+#endif
+
+    boost::uint32_t stack[STACK];
+    int top = 0;
+    stack[top++] = 0;
+
+    while( top > 0 )
+    {
+        const boost::uint32_t index = stack[--top];
+        const bvh_node &n = Nodes[index];
+        const float far_t = best < real_t( FLT_MAX ) ? float( best ) * (1.0f + 4.0f * FLT_EPSILON) : FLT_MAX;
+        float tnear, tfar;
+
+#ifdef ARCH_SSE
+        const __m128 t1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( n.lo ), so ), sinv );
+        const __m128 t2 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( n.hi ), so ), sinv );
+
+        __m128 vn = _mm_or_ps( _mm_and_ps( mask, _mm_min_ps( t1, t2 ) ), _mm_andnot_ps( mask, neg_inf ) );
+        __m128 vf = _mm_or_ps( _mm_and_ps( mask, _mm_max_ps( t1, t2 ) ), _mm_andnot_ps( mask, pos_inf ) );
+
+        vn = _mm_max_ps( vn, _mm_shuffle_ps( vn, vn, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        vn = _mm_max_ps( vn, _mm_shuffle_ps( vn, vn, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+        vf = _mm_min_ps( vf, _mm_shuffle_ps( vf, vf, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        vf = _mm_min_ps( vf, _mm_shuffle_ps( vf, vf, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+
+        tnear = _mm_cvtss_f32( vn );
+        tfar = _mm_cvtss_f32( vf );
+#else
+        tnear = -FLT_MAX;
+        tfar = FLT_MAX;
+
+        for( int k = 0; k < 3; ++k )
+        {
+            const float a = (n.lo[k] - o[k]) * inv[k], b = (n.hi[k] - o[k]) * inv[k];
+            tnear = std::max( tnear, std::min( a, b ) );
+            tfar = std::min( tfar, std::max( a, b ) );
+        }
+#endif
+
+        if( !(tnear <= tfar) || tfar < 0.0f || tnear > far_t )
+            continue;
+
+        if( n.leaf() )
+        {
+            for( boost::uint32_t i = n.offset; i < n.offset + n.count; ++i )
+            {
+                const bvh_triangle &t = Triangles[i];
+                real_t th, u, v;
+
+                if( ray_triangle( origin, dir, Points[ t.v[0] ], Points[ t.v[1] ], Points[ t.v[2] ], th, u, v ) && th <= best )
+                {
+                    best = th;
+                    r.face = t.face;
+                    r.t = th;
+                    r.u = u;
+                    r.v = v;
+                    found = true;
+                }
+            }
+
+            continue;
+        }
+
+        //the child on the side the ray comes from is visited first
+        const boost::uint32_t left = index + 1, right = n.offset;
+        const int axis = std::fabs( n.hi[0] - n.lo[0] ) >= std::fabs( n.hi[1] - n.lo[1] ) ? 
+            (std::fabs( n.hi[0] - n.lo[0] ) >= std::fabs( n.hi[2] - n.lo[2] ) ? 0 : 2) : 
+            (std::fabs( n.hi[1] - n.lo[1] ) >= std::fabs( n.hi[2] - n.lo[2] ) ? 1 : 2);
+
+        if( dir[axis] >= real_t( 0.0 ) )
+        {
+            stack[top++] = right;
+            stack[top++] = left;
+        }
+        else
+        {
+            stack[top++] = left;
+            stack[top++] = right;
+        }
+    }
+
+    return found;
+}
+
+template<typename Real>
+std::size_t face_bvh<Real>::box_overlap( const point_t &lo, const point_t &hi, std::vector< uid_t > &faces )const
+{
+    if( Nodes.empty() )
+        return 0;
+
+    bvh_box q;
+    q.grow( lo );
+    q.grow( hi );
+
+    const std::size_t first = faces.size();
+
+    boost::uint32_t stack[STACK];
+    int top = 0;
+    stack[top++] = 0;
+
+    while( top > 0 )
+    {
+        const boost::uint32_t index = stack[--top];
+        const bvh_node &n = Nodes[index];
+        bvh_box b;
+
+        for( int k = 0; k < 3; ++k )
+        {
+            b.lo[k] = n.lo[k];
+            b.hi[k] = n.hi[k];
+        }
+
+        if( !b.overlaps( q ) )
+            continue;
+
+        if( n.leaf() )
+        {
+            for( boost::uint32_t i = n.offset; i < n.offset + n.count; ++i )
+                if( triangle_box( Triangles[i] ).overlaps( q ) )
+                    faces.push_back( Triangles[i].face );
+
+            continue;
+        }
+
+        stack[top++] = n.offset;
+        stack[top++] = index + 1;
+    }
+
+    std::sort( faces.begin() + first, faces.end() );
+    faces.erase( std::unique( faces.begin() + first, faces.end() ), faces.end() );
+
+    return faces.size() - first;
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,267 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_COMPONENTS_H
+#define GEOMETRY_COMPONENTS_H
+
+#include "Indexed.h"
+#include "UnionFind.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!What connects two faces into the same component
+enum component_connectivity
+{
+    //!faces that share an edge
+    CONNECT_EDGE,
+
+    //!faces that share a vertex
+    CONNECT_VERTEX
+};
+
+//!Options of the connected component labeling
+struct components_options
+{
+    components_options() : by(CONNECT_EDGE), sizes(true), bounds(false), threads(0) {}
+
+    component_connectivity by;
+
+    //!count the faces and the vertices of every component
+    bool sizes;
+
+    //!compute the bounding box of every component
+    bool bounds;
+
+    //!number of threads, 0 for the default
+    int threads;
+};
+
+/*!
+\brief Connected components of a mesh
+
+The components are numbered in the order of their first face. A vertex is labeled with the 
+smallest component number among its faces, the vertices without faces get NO_ID. The vertex 
+counts and the bounding boxes take all the vertices of the faces of a component, so a vertex 
+shared by components joined only at that vertex counts in each of them.
+*/
+template<typename Real>
+struct mesh_components
+{
+    typedef math::vec3< Real > point_t;
+
+    mesh_components() : count(0) {}
+
+    std::size_t count;
+
+    //!component of every face and every vertex by id
+    std::vector< uid_t > face_component;
+    std::vector< uid_t > vertex_component;
+
+    //!number of faces and of distinct face vertices of every component, filled if requested
+    std::vector< std::size_t > faces;
+    std::vector< std::size_t > verts;
+
+    //!corners of the bounding box of every component, filled if requested
+    std::vector< point_t > min;
+    std::vector< point_t > max;
+};
+
+/*!
+\brief Labels the connected components of a mesh
+\param m the mesh
+\param c the components
+\param options the labeling options
+\return the number of components
+
+The sets are joined with the lock-free union_find in a parallel pass over the edge array, the 
+faces around every edge when the faces connect by edges and the two vertices of every edge 
+when they connect by vertices. The labels do not depend on the number of threads.
+*/
+template<typename MeshType>
+std::size_t connected_components( const MeshType &m, mesh_components< typename MeshType::real_t > &c, 
+                                  const components_options &options = components_options() )
+{
+    typedef typename MeshType::real_t real_t;
+    typedef typename mesh_components< real_t >::point_t point_t;
+
+    const int threads = options.threads;
+
+    indexed_mesh< real_t > im;
+    make_indexed( m, im, threads );
+
+    const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+    const std::ptrdiff_t ne = std::ptrdiff_t( im.edges_size() );
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+
+    if( options.by == CONNECT_EDGE )
+    {
+        std::vector< uid_t > corner_face( im.face_verts.size() );
+        index_rows edge_corners;
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+            for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+                corner_face[k] = uid_t( f );
+
+        group_by_key( im.face_edges, ne, edge_corners, threads );
+
+        union_find sets( nf );
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t e = 0; e < ne; ++e )
+        {
+            const uid_t *k = edge_corners.row_begin( e );
+
+            for( std::size_t i = 1; i < edge_corners.row_size( e ); ++i )
+                sets.unite( corner_face[ k[0] ], corner_face[ k[i] ] );
+        }
+
+        c.count = sets.labels( c.face_component, threads );
+    }
+    else
+    {
+        union_find sets( nv );
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t e = 0; e < ne; ++e )
+            sets.unite( im.edge_verts[ 2 * e ], im.edge_verts[ 2 * e + 1 ] );
+
+        std::vector< uid_t > label;
+        sets.labels( label, threads );
+
+        //renumber in the order of the first faces
+        std::vector< uid_t > number( nv, NO_ID );
+        c.face_component.resize( nf );
+        c.count = 0;
+
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+        {
+            const uid_t l = label[ im.face_verts[ im.face_start[f] ] ];
+
+            if( number[l] == NO_ID )
+                number[l] = uid_t( c.count++ );
+
+            c.face_component[f] = number[l];
+        }
+    }
+
+    //a vertex takes the smallest component number among its faces
+    c.vertex_component.assign( nv, NO_ID );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+            atomic_min( &c.vertex_component[ im.face_verts[k] ], c.face_component[f] );
+
+    c.faces.clear();
+    c.verts.clear();
+    c.min.clear();
+    c.max.clear();
+
+    if( options.sizes )
+    {
+        c.faces.assign( c.count, 0 );
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+            atomic_add( &c.faces[ c.face_component[f] ], std::size_t( 1 ) );
+    }
+
+    if( options.sizes || options.bounds )
+    {
+        //the corners of the faces of every component
+        std::vector< uid_t > corner_component( im.face_verts.size() );
+        index_rows component_corners;
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+            for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+                corner_component[k] = c.face_component[f];
+
+        group_by_key( corner_component, c.count, component_corners, threads );
+
+        if( options.sizes )
+            c.verts.resize( c.count );
+
+        if( options.bounds )
+        {
+            c.min.resize( c.count );
+            c.max.resize( c.count );
+        }
+
+        #pragma omp parallel num_threads( parallel_threads( threads ) )
+        {
+            std::vector< uid_t > verts;
+
+            #pragma omp for schedule(dynamic,256)
+            for( std::ptrdiff_t i = 0; i < std::ptrdiff_t( c.count ); ++i )
+            {
+                verts.clear();
+
+                for( const uid_t *k = component_corners.row_begin( i ); k != component_corners.row_end( i ); ++k )
+                    verts.push_back( im.face_verts[*k] );
+
+                std::sort( verts.begin(), verts.end() );
+                verts.erase( std::unique( verts.begin(), verts.end() ), verts.end() );
+
+                if( options.sizes )
+                    c.verts[i] = verts.size();
+
+                if( !options.bounds )
+                    continue;
+
+                point_t lo( std::numeric_limits< real_t >::max() ), hi( -std::numeric_limits< real_t >::max() );
+
+                for( std::size_t j = 0; j < verts.size(); ++j )
+                {
+                    const point_t &p = im.points[ verts[j] ];
+
+                    lo = point_t( std::min( lo.x, p.x ), std::min( lo.y, p.y ), std::min( lo.z, p.z ) );
+                    hi = point_t( std::max( hi.x, p.x ), std::max( hi.y, p.y ), std::max( hi.z, p.z ) );
+                }
+
+                c.min[i] = lo;
+                c.max[i] = hi;
+            }
+        }
+    }
+
+    return c.count;
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,316 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_CURVATURE_H
+#define GEOMETRY_CURVATURE_H
+
+#include "Indexed.h"
+#include "Parallel.h"
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Discrete curvatures of the vertices and dihedral angles of the edges of a mesh
+
+The arrays are indexed by the entity ids. The curvatures follow Meyer, Desbrun, Schroder and 
+Barr (2002): the mean curvature comes from the cotangent Laplacian of the positions and the 
+Gaussian curvature from the angle defect, both divided by the mixed Voronoi area of the vertex, 
+the principal curvatures are the roots of k^2 - 2Hk + K. The mean curvature is positive on 
+convex parts with outward faces. On the boundary the angle defect is taken from pi and the 
+values are one sided estimates.
+
+The dihedral angle is the angle in degrees between the normals of the two faces of an edge, 
+0 for flat edges, positive for convex and negative for concave ones. Edges with other than two 
+faces get an infinite angle so they pass any feature threshold, as in improve() and decimate().
+*/
+struct mesh_curvature
+{
+    typedef boost::dynamic_bitset< unsigned char > bitset_t;
+
+    //!mean curvature of every vertex
+    std::vector< double > mean;
+
+    //!Gaussian curvature of every vertex
+    std::vector< double > gaussian;
+
+    //!principal curvatures of every vertex, kmax >= kmin
+    std::vector< double > kmax, kmin;
+
+    //!mixed Voronoi area of every vertex, the areas add up to the area of the mesh
+    std::vector< double > area;
+
+    //!signed dihedral angle of every edge in degrees
+    std::vector< double > dihedral;
+
+    /*!
+    \brief The edges sharper than an angle
+    \param angle the feature angle in degrees, as feature_angle of the improve and decimate options
+    \param threads number of threads, 0 for the default
+    \return a bitset indexed by the edge ids
+    */
+    bitset_t feature_edges( double angle, int threads = 0 )const
+    {
+        const std::ptrdiff_t ne = std::ptrdiff_t( dihedral.size() );
+        const std::ptrdiff_t bytes = (ne + 7) / 8;
+
+        std::vector< unsigned char > bits( bytes );
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t b = 0; b < bytes; ++b )
+        {
+            unsigned char bb = 0;
+
+            for( std::ptrdiff_t j = 0; j < 8 && 8 * b + j < ne; ++j )
+                if( std::fabs( dihedral[ 8 * b + j ] ) > angle )
+                    bb |= (unsigned char)( 1u << j );
+
+            bits[b] = bb;
+        }
+
+        bitset_t r( bits.begin(), bits.end() );
+        r.resize( ne );
+
+        return r;
+    }
+};
+
+/*!
+\brief Computes the curvatures and the dihedral angles of an indexed mesh
+\param im the indexed mesh
+\param c the curvatures
+\param threads number of threads, 0 for the default
+
+Polygons are split into fans of triangles from their first vertex. Every vertex gathers the 
+terms of the triangles around it and every edge reads the normals of its faces, so each value 
+is written by a single thread and the result does not depend on the number of threads.
+*/
+template<typename Real>
+void compute_curvature( const indexed_mesh< Real > &im, mesh_curvature &c, int threads = 0 )
+{
+    typedef math::vec3< double > point_t;
+
+    const double pi = 3.14159265358979323846;
+    const double to_degrees = 180.0 / pi;
+
+    const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+    const std::ptrdiff_t ne = std::ptrdiff_t( im.edges_size() );
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+
+    threads = parallel_threads( threads );
+
+    std::vector< point_t > points( nv );
+    std::vector< point_t > normals( nf );
+    std::vector< uid_t > corner_face( im.face_verts.size() );
+
+    #pragma omp parallel num_threads( threads )
+    {
+        #pragma omp for schedule(static) nowait
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+            points[v] = point_t( im.points[v].x, im.points[v].y, im.points[v].z );
+
+        //unit normals from the vector area, which works for polygons of any orientation
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+        {
+            const uid_t *fv = &im.face_verts[0] + im.face_start[f];
+            const std::size_t n = im.face_size( f );
+
+            point_t normal( 0.0 );
+
+            for( std::size_t k = 0; k < n; ++k )
+            {
+                const typename indexed_mesh< Real >::point_t &a = im.points[ fv[k] ], &b = im.points[ fv[ (k + 1) % n ] ];
+                normal += math::cross( point_t( a.x, a.y, a.z ), point_t( b.x, b.y, b.z ) );
+
+                corner_face[ im.face_start[f] + k ] = uid_t( f );
+            }
+
+            const double len = math::magnitude( normal );
+            normals[f] = (len > 0.0) ? normal / len : point_t( 0.0 );
+        }
+    }
+
+    index_rows edge_corners;
+    group_by_key( im.face_edges, ne, edge_corners, threads );
+
+    c.dihedral.resize( ne );
+
+    //the boundary vertices are on edges with a single face
+    std::vector< uid_t > boundary( nv, 0 );
+
+    #pragma omp parallel for num_threads( threads ) schedule(static)
+    for( std::ptrdiff_t e = 0; e < ne; ++e )
+    {
+        if( edge_corners.row_size( e ) == 1 )
+        {
+            atomic_add( &boundary[ im.edge_verts[ 2 * e ] ], uid_t( 1 ) );
+            atomic_add( &boundary[ im.edge_verts[ 2 * e + 1 ] ], uid_t( 1 ) );
+        }
+
+        if( edge_corners.row_size( e ) != 2 )
+        {
+            c.dihedral[e] = std::numeric_limits< double >::infinity();
+            continue;
+        }
+
+        const uid_t ka = edge_corners.row_begin( e )[0], kb = edge_corners.row_begin( e )[1];
+        const uid_t fa = corner_face[ka], fb = corner_face[kb];
+
+        //the faces are oriented alike when they walk the edge in opposite directions
+        const point_t na = normals[fa];
+        const point_t nb = (im.face_verts[ka] == im.face_verts[kb]) ? -normals[fb] : normals[fb];
+
+        //the direction of the edge in the first face
+        const uid_t v0 = im.face_verts[ka];
+        const uid_t v1 = (v0 == im.edge_verts[ 2 * e ]) ? im.edge_verts[ 2 * e + 1 ] : im.edge_verts[ 2 * e ];
+
+        point_t d = points[v1] - points[v0];
+        const double len = math::magnitude( d );
+
+        if( len > 0.0 )
+            d /= len;
+
+        c.dihedral[e] = std::atan2( math::dot( math::cross( na, nb ), d ), math::dot( na, nb ) ) * to_degrees;
+    }
+
+    //fans of triangles from the first vertex of every face
+    std::vector< uid_t > tri_start( nf + 1, 0 );
+
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        tri_start[f+1] = tri_start[f] + uid_t( im.face_size( f ) >= 3 ? im.face_size( f ) - 2 : 0 );
+
+    std::vector< uid_t > tris( 3 * tri_start.back() );
+
+    #pragma omp parallel for num_threads( threads ) schedule(static)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+    {
+        const uid_t *v = &im.face_verts[0] + im.face_start[f];
+
+        for( uid_t t = tri_start[f], i = 1; t < tri_start[f+1]; ++t, ++i )
+        {
+            tris[ 3 * t ] = v[0];
+            tris[ 3 * t + 1 ] = v[i];
+            tris[ 3 * t + 2 ] = v[i+1];
+        }
+    }
+
+    index_rows vertex_corners;
+    group_by_key( tris, nv, vertex_corners, threads );
+
+    c.mean.assign( nv, 0.0 );
+    c.gaussian.assign( nv, 0.0 );
+    c.kmax.assign( nv, 0.0 );
+    c.kmin.assign( nv, 0.0 );
+    c.area.assign( nv, 0.0 );
+
+    #pragma omp parallel for num_threads( threads ) schedule(dynamic,1024)
+    for( std::ptrdiff_t v = 0; v < nv; ++v )
+    {
+        const point_t &p = points[v];
+
+        point_t laplace( 0.0 ), normal( 0.0 );
+        double area = 0.0, angles = 0.0;
+
+        for( const uid_t *k = vertex_corners.row_begin( v ); k != vertex_corners.row_end( v ); ++k )
+        {
+            const uid_t t = *k / 3, l = *k % 3;
+
+            const point_t &pj = points[ tris[ 3 * t + (l + 1) % 3 ] ];
+            const point_t &pk = points[ tris[ 3 * t + (l + 2) % 3 ] ];
+
+            const point_t eij = pj - p, eik = pk - p, ejk = pk - pj;
+            const point_t n = math::cross( eij, eik );
+            const double twice_area = math::magnitude( n );
+
+            const double lij = math::dot( eij, eij ), lik = math::dot( eik, eik ), ljk = math::dot( ejk, ejk );
+
+            if( !(twice_area > std::numeric_limits< double >::epsilon() * std::max( lij, std::max( lik, ljk ) )) )
+                continue;
+
+            //the cosines of the angles over twice the area are the cotangents over twice the area
+            const double di = math::dot( eij, eik ), dj = -math::dot( eij, ejk ), dk = math::dot( eik, ejk );
+            const double cot_j = dj / twice_area, cot_k = dk / twice_area;
+
+            laplace += cot_k * (p - pj) + cot_j * (p - pk);
+            normal += n;
+            angles += std::atan2( twice_area, di );
+
+            //mixed area, the Voronoi region of the corner or a share of the obtuse triangles
+            if( di < 0.0 )
+                area += 0.25 * twice_area;
+            else if( dj < 0.0 || dk < 0.0 )
+                area += 0.125 * twice_area;
+            else
+                area += 0.125 * (lij * cot_k + lik * cot_j);
+        }
+
+        if( !(area > 0.0) )
+            continue;
+
+        //the Laplacian is twice the mean curvature along the normal
+        const double h = 0.25 * math::magnitude( laplace ) / area;
+        const double mean = (math::dot( laplace, normal ) < 0.0) ? -h : h;
+        const double gaussian = ((boundary[v] ? pi : 2.0 * pi) - angles) / area;
+        const double root = std::sqrt( std::max( mean * mean - gaussian, 0.0 ) );
+
+        c.area[v] = area;
+        c.mean[v] = mean;
+        c.gaussian[v] = gaussian;
+        c.kmax[v] = mean + root;
+        c.kmin[v] = mean - root;
+    }
+}
+
+/*!
+\brief Computes the curvatures and the dihedral angles of a mesh
+\param m the mesh
+\param c the curvatures
+\param threads number of threads, 0 for the default
+*/
+template<typename MeshType>
+void compute_curvature( const MeshType &m, mesh_curvature &c, int threads = 0 )
+{
+    indexed_mesh< typename MeshType::real_t > im;
+    make_indexed( m, im, threads );
+
+    compute_curvature( im, c, threads );
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,848 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#ifndef GEOMETRY_DECIMATE_H
+#define GEOMETRY_DECIMATE_H
+
+#include "Algorithms.h"
+#include "Indexed.h"
+#include "PriorityQueue.h"
+#include "Parallel.h"
+#include "../Math/Quadric.h"
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Options of the quadric decimation
+struct decimate_options
+{
+    decimate_options() : 
+        lock_boundary(true), feature_angle(60.0), feature_weight(1000.0), max_error(-1.0), 
+        parallel(false), round_fraction(0.25), threads(0) {}
+
+    //!keep the vertices of the boundary edges fixed
+    bool lock_boundary;
+
+    //!dihedral angle in degrees above which an edge is a feature
+    double feature_angle;
+
+    //!weight of the constraint planes that keep the features (and the unlocked boundary) in place
+    double feature_weight;
+
+    //!stop when the cheapest collapse has a larger error, negative for no limit
+    double max_error;
+
+    //!collapse independent sets of edges concurrently instead of one edge at a time
+    bool parallel;
+
+    //!fraction of the cheapest collapses that compete in each parallel round
+    double round_fraction;
+
+    //!number of threads of the parallel mode, 0 for the default
+    int threads;
+};
+
+/*!
+\brief Quadric edge collapse on a flat triangle copy of a mesh (see 'Surface Simplification Using Quadric Error Metrics' of Garland and Heckbert)
+
+Every vertex keeps the cheapest collapse to one of its neighbours in a mutable priority queue,
+so a collapse only re-evaluates the 1-ring of the surviving vertex. The connectivity is
+kept as triangle indices and vertex to face lists, the mesh is rebuilt once at the end.
+
+The parallel mode works in rounds instead: the cheapest collapses claim the faces around
+their two vertices and the ones that own all of them are applied concurrently, since they
+read and write disjoint parts of the mesh. The rounds give the same result for any number
+of threads.
+*/
+template<typename Real>
+class quadric_decimator
+{
+public:
+    typedef Real real_t;
+    typedef math::vec3<double> point_t;
+    typedef math::quadric<double> quadric_t;
+
+    //!loads the triangles of the indexed mesh, polygons are triangulated
+    quadric_decimator( const indexed_mesh<Real> &im, const decimate_options &options = decimate_options() )
+        : Options( options ), FacesAlive( 0 )
+    {
+        const std::size_t verts = im.verts_size();
+
+        Points.resize( verts );
+        for( std::size_t i = 0; i < verts; ++i )
+            Points[i] = point_t( im.points[i] );
+
+        std::vector< typename indexed_mesh<Real>::point_t > poly;
+        std::vector< std::size_t > tris;
+
+        for( std::size_t f = 0; f < im.faces_size(); ++f )
+        {
+            const uid_t *fv = &im.face_verts[ im.face_start[f] ];
+            const std::size_t n = im.face_size( f );
+
+            if( n == 3 )
+            {
+                Triangles.insert( Triangles.end(), fv, fv + 3 );
+                continue;
+            }
+
+            if( n < 3 )
+                continue;
+
+            poly.resize( n );
+            for( std::size_t k = 0; k < n; ++k )
+                poly[k] = im.points[ fv[k] ];
+
+            tris.clear();
+            triangulate_polygon( poly, tris );
+
+            for( std::size_t k = 0; k < tris.size(); ++k )
+                Triangles.push_back( fv[ tris[k] ] );
+        }
+
+        init();
+    }
+
+    //!number of triangles left
+    std::size_t faces_size()const { return FacesAlive; }
+
+    /*!
+    \brief Collapses edges until the target number of faces is reached
+    \param target_faces the number of faces to stop at
+    \return the number of collapses performed
+    */
+    std::size_t run( std::size_t target_faces )
+    {
+        std::size_t collapses = 0;
+
+        Queue.reset( Points.size() );
+
+        for( std::size_t v = 0; v < Points.size(); ++v )
+            update( v );
+
+        while( FacesAlive > target_faces && !Queue.empty() )
+        {
+            if( Options.max_error >= 0.0 && Queue.top_priority() > Options.max_error )
+                break;
+
+            uid_t a = Queue.top();
+            uid_t b = Target[a];
+
+            if( !can_collapse( a, b, Optimal[a], RingA, RingB ) )
+            {
+                //wait until the neighbourhood changes
+                Queue.remove( a );
+                continue;
+            }
+
+            collapse( a, b, Optimal[a] );
+            ++collapses;
+        }
+
+        return collapses;
+    }
+
+    /*!
+    \brief Collapses independent sets of edges in parallel rounds until the target number of faces is reached
+    \param target_faces the number of faces to stop at
+    \return the number of collapses performed
+    */
+    std::size_t run_parallel( std::size_t target_faces )
+    {
+        const std::ptrdiff_t verts = std::ptrdiff_t( Points.size() );
+        const int threads = parallel_threads( Options.threads );
+
+        //the cheapest collapse of every vertex, negative if there is none
+        std::vector< double > costs( verts, -1.0 );
+        std::vector< char > dirty( verts, 1 );
+        std::vector< boost::uint64_t > claims( FaceAlive.size() );
+        std::vector< char > won( verts );
+        std::vector< double > candidates;
+        std::vector< boost::uint64_t > winners;
+        std::vector< uid_t > dead;
+
+        std::size_t collapses = 0;
+
+        while( FacesAlive > target_faces )
+        {
+            #pragma omp parallel num_threads( threads )
+            {
+                std::vector< uid_t > ring_a;
+
+                #pragma omp for schedule(static)
+                for( std::ptrdiff_t f = 0; f < std::ptrdiff_t( claims.size() ); ++f )
+                    claims[f] = ~boost::uint64_t( 0 );
+
+                //re-evaluate the vertices whose neighbourhood changed
+                #pragma omp for schedule(dynamic,1024)
+                for( std::ptrdiff_t v = 0; v < verts; ++v )
+                {
+                    won[v] = 0;
+
+                    if( !dirty[v] )
+                        continue;
+
+                    dirty[v] = 0;
+                    costs[v] = best_collapse( v, Target[v], Optimal[v], ring_a );
+
+                    if( Options.max_error >= 0.0 && costs[v] > Options.max_error )
+                        costs[v] = -1.0;
+                }
+            }
+
+            //only the cheapest collapses compete in this round
+            candidates.clear();
+            for( std::ptrdiff_t v = 0; v < verts; ++v )
+            {
+                if( costs[v] >= 0.0 )
+                    candidates.push_back( costs[v] );
+            }
+
+            if( candidates.empty() )
+                break;
+
+            std::size_t quantile = std::size_t( double( candidates.size() ) * Options.round_fraction );
+            quantile = std::min( quantile, candidates.size() - 1 );
+
+            std::nth_element( candidates.begin(), candidates.begin() + quantile, candidates.end() );
+            const double threshold = candidates[ quantile ];
+
+            #pragma omp parallel num_threads( threads )
+            {
+                std::vector< uid_t > ring_a, ring_b;
+
+                //every collapse claims the faces around its edge, the keys are pseudo random to find many independent ones
+                #pragma omp for schedule(dynamic,1024)
+                for( std::ptrdiff_t v = 0; v < verts; ++v )
+                {
+                    if( costs[v] < 0.0 || costs[v] > threshold )
+                        continue;
+
+                    const boost::uint64_t key = claim_key( v );
+
+                    for( std::size_t i = 0; i < VertexFaces[v].size(); ++i )
+                        atomic_min( &claims[ VertexFaces[v][i] ], key );
+
+                    for( std::size_t i = 0; i < VertexFaces[ Target[v] ].size(); ++i )
+                        atomic_min( &claims[ VertexFaces[ Target[v] ][i] ], key );
+                }
+
+                //the collapses that hold all their faces read and write disjoint data
+                #pragma omp for schedule(dynamic,1024)
+                for( std::ptrdiff_t v = 0; v < verts; ++v )
+                {
+                    if( costs[v] < 0.0 || costs[v] > threshold )
+                        continue;
+
+                    const boost::uint64_t key = claim_key( v );
+
+                    if( !owns( v, key, claims ) || !owns( Target[v], key, claims ) )
+                        continue;
+
+                    if( can_collapse( v, Target[v], Optimal[v], ring_a, ring_b ) )
+                        won[v] = 1;
+                    else
+                        costs[v] = -1.0; //wait until the neighbourhood changes
+                }
+            }
+
+            winners.clear();
+            for( std::ptrdiff_t v = 0; v < verts; ++v )
+            {
+                if( won[v] )
+                    winners.push_back( collapse_key( costs[v], v ) );
+            }
+
+            if( winners.empty() )
+            {
+                //all the competing collapses were rejected, try the next ones
+                continue;
+            }
+
+            //do not go below the target, a collapse removes up to two faces
+            const std::size_t needed = (FacesAlive - target_faces + 1) / 2;
+
+            if( winners.size() > needed )
+            {
+                std::nth_element( winners.begin(), winners.begin() + needed, winners.end() );
+                winners.resize( needed );
+            }
+
+            //the faces of the collapsed edges, at most two since non manifold edges are locked
+            dead.assign( 2 * winners.size(), NO_ID );
+
+            std::ptrdiff_t removed = 0;
+
+            #pragma omp parallel for num_threads( threads ) reduction(+:removed) schedule(dynamic,256)
+            for( std::ptrdiff_t i = 0; i < std::ptrdiff_t( winners.size() ); ++i )
+            {
+                const uid_t a = uid_t( winners[i] & 0xffffffff );
+                removed += std::ptrdiff_t( collapse_edge( a, Target[a], Optimal[a], &dead[ 2 * i ] ) );
+            }
+
+            FacesAlive -= removed;
+
+            //the neighbourhoods of the winners may overlap, so they are updated serially
+            std::vector< uid_t > neighbours;
+            for( std::size_t i = 0; i < winners.size(); ++i )
+            {
+                const uid_t a = uid_t( winners[i] & 0xffffffff );
+                const uid_t b = Target[a];
+
+                for( std::size_t j = 2 * i; j < 2 * i + 2 && dead[j] != NO_ID; ++j )
+                {
+                    const uid_t *t = &Triangles[ 3 * dead[j] ];
+
+                    for( std::size_t k = 0; k < 3; ++k )
+                    {
+                        if( t[k] != a && t[k] != b )
+                        {
+                            std::vector< uid_t > &vf = VertexFaces[ t[k] ];
+                            vf.erase( std::find( vf.begin(), vf.end(), dead[j] ) );
+                        }
+                    }
+                }
+
+                costs[b] = -1.0;
+                dirty[a] = 1;
+                ring( a, neighbours );
+
+                for( std::size_t k = 0; k < neighbours.size(); ++k )
+                    dirty[ neighbours[k] ] = 1;
+            }
+            collapses += winners.size();
+        }
+
+        return collapses;
+    }
+
+    /*!
+    \brief Writes the result back to the mesh it was loaded from
+    \note the removed vertices are deleted from the mesh and the rest keep their order
+    */
+    template<typename MeshType>
+    void apply( MeshType &m )const
+    {
+        typedef typename MeshType::point_t mesh_point_t;
+
+        typename MeshType::vertex_array_t verts;
+        std::vector< uid_t > index( Points.size(), NO_ID );
+
+        verts.reserve( Points.size() );
+
+        std::size_t i = 0;
+        for( typename MeshType::vertex_iterator_t v = m.verts_begin(); v != m.verts_end(); ++v, ++i )
+        {
+            if( Removed[i] )
+                continue;
+
+            index[i] = verts.size();
+            verts.push_back( *v );
+            m.set_point( *v, mesh_point_t( Points[i] ) );
+        }
+
+        std::vector< std::size_t > sizes( FacesAlive, 3 );
+        std::vector< uid_t > indices;
+
+        indices.reserve( 3 * FacesAlive );
+
+        for( std::size_t f = 0; f < FaceAlive.size(); ++f )
+        {
+            if( !FaceAlive[f] )
+                continue;
+
+            for( std::size_t k = 0; k < 3; ++k )
+                indices.push_back( index[ Triangles[ 3 * f + k ] ] );
+        }
+
+        m.rebuild( verts, sizes, indices );
+    }
+
+private:
+    void init()
+    {
+        const std::size_t verts = Points.size();
+        const std::size_t faces = Triangles.size() / 3;
+
+        Quadrics.assign( verts, quadric_t() );
+        VertexFaces.assign( verts, std::vector< uid_t >() );
+        Locked.assign( verts, 0 );
+        Boundary.assign( verts, 0 );
+        Removed.assign( verts, 0 );
+        Target.assign( verts, NO_ID );
+        Optimal.assign( verts, point_t( 0.0 ) );
+        FaceAlive.assign( faces, 1 );
+        FacesAlive = faces;
+
+        std::vector< point_t > normals( faces );
+
+        //the plane quadrics of the faces weighted by their area
+        for( std::size_t f = 0; f < faces; ++f )
+        {
+            const uid_t *t = &Triangles[ 3 * f ];
+            point_t n = math::cross( Points[t[1]] - Points[t[0]], Points[t[2]] - Points[t[0]] );
+            double len = math::magnitude( n );
+
+            normals[f] = len > 0.0 ? n / len : point_t( 0.0 );
+
+            quadric_t q( normals[f], Points[t[0]], 0.5 * len );
+
+            for( std::size_t k = 0; k < 3; ++k )
+            {
+                Quadrics[ t[k] ] += q;
+                VertexFaces[ t[k] ].push_back( f );
+            }
+        }
+
+        //sort the face edges to find the boundary, non manifold and feature edges
+        std::vector< face_edge > edges;
+        edges.reserve( 3 * faces );
+
+        for( std::size_t f = 0; f < faces; ++f )
+        {
+            for( std::size_t k = 0; k < 3; ++k )
+            {
+                face_edge e;
+                e.v0 = Triangles[ 3 * f + k ];
+                e.v1 = Triangles[ 3 * f + (k + 1) % 3 ];
+                e.f = f;
+
+                if( e.v1 < e.v0 )
+                    std::swap( e.v0, e.v1 );
+
+                edges.push_back( e );
+            }
+        }
+
+        std::sort( edges.begin(), edges.end() );
+
+        const double feature_cos = std::cos( Options.feature_angle * 3.14159265358979323846 / 180.0 );
+
+        for( std::size_t i = 0; i < edges.size(); )
+        {
+            std::size_t j = i + 1;
+            while( j < edges.size() && edges[j].v0 == edges[i].v0 && edges[j].v1 == edges[i].v1 )
+                ++j;
+
+            const uid_t v0 = edges[i].v0, v1 = edges[i].v1;
+
+            if( j - i == 1 )
+            {
+                Boundary[v0] = Boundary[v1] = 1;
+
+                if( Options.lock_boundary )
+                    Locked[v0] = Locked[v1] = 1;
+                else
+                    add_constraint( v0, v1, normals[ edges[i].f ] );
+            }
+            else if( j - i > 2 )
+            {
+                //non manifold edges are never collapsed
+                Locked[v0] = Locked[v1] = 1;
+            }
+            else if( math::dot( normals[ edges[i].f ], normals[ edges[i+1].f ] ) < feature_cos )
+            {
+                add_constraint( v0, v1, normals[ edges[i].f ] );
+                add_constraint( v0, v1, normals[ edges[i+1].f ] );
+            }
+
+            i = j;
+        }
+    }
+
+    //!adds the plane through the edge perpendicular to the face to the quadrics of its vertices
+    void add_constraint( uid_t v0, uid_t v1, const point_t &n )
+    {
+        point_t d = Points[v1] - Points[v0];
+        point_t c = math::cross( d, n );
+        double len = math::magnitude( c );
+
+        if( len <= 0.0 )
+            return;
+
+        quadric_t q( c / len, Points[v0], Options.feature_weight * math::dot( d, d ) );
+
+        Quadrics[v0] += q;
+        Quadrics[v1] += q;
+    }
+
+    //!the vertices of the faces around v except v
+    void ring( uid_t v, std::vector< uid_t > &verts )const
+    {
+        verts.clear();
+
+        for( std::size_t i = 0; i < VertexFaces[v].size(); ++i )
+        {
+            const uid_t *t = &Triangles[ 3 * VertexFaces[v][i] ];
+
+            for( std::size_t k = 0; k < 3; ++k )
+            {
+                if( t[k] != v && std::find( verts.begin(), verts.end(), t[k] ) == verts.end() )
+                    verts.push_back( t[k] );
+            }
+        }
+    }
+
+    //!finds the error and the optimal point of the collapse of the edge (a,b)
+    double cost( uid_t a, uid_t b, point_t &p )const
+    {
+        quadric_t q = Quadrics[a] + Quadrics[b];
+
+        if( !q.optimize( p ) )
+        {
+            //singular quadric, pick the best of the end points and the middle
+            point_t cands[3] = { Points[a], Points[b], (Points[a] + Points[b]) * 0.5 };
+            double best = q.evaluate( cands[0] );
+            p = cands[0];
+
+            for( std::size_t i = 1; i < 3; ++i )
+            {
+                double e = q.evaluate( cands[i] );
+                if( e < best )
+                {
+                    best = e;
+                    p = cands[i];
+                }
+            }
+        }
+
+        return std::max( q.evaluate( p ), 0.0 );
+    }
+
+    /*!
+    \brief Finds the cheapest collapse of the vertex
+    \return the error of the collapse or a negative value if the vertex cannot be collapsed
+    */
+    double best_collapse( uid_t v, uid_t &target, point_t &optimal, std::vector< uid_t > &verts )const
+    {
+        if( Removed[v] || Locked[v] )
+            return -1.0;
+
+        ring( v, verts );
+
+        double best = -1.0;
+        point_t p;
+
+        for( std::size_t i = 0; i < verts.size(); ++i )
+        {
+            if( Locked[ verts[i] ] )
+                continue;
+
+            double e = cost( v, verts[i], p );
+
+            if( best < 0.0 || e < best )
+            {
+                best = e;
+                target = verts[i];
+                optimal = p;
+            }
+        }
+
+        return best;
+    }
+
+    //!recomputes the cheapest collapse of the vertex in the queue
+    void update( uid_t v )
+    {
+        double best = best_collapse( v, Target[v], Optimal[v], RingA );
+
+        if( best < 0.0 )
+            Queue.remove( v );
+        else
+            Queue.update( v, best );
+    }
+
+    //!orders the collapses by error and then by vertex, the error is rounded to float
+    static boost::uint64_t collapse_key( double cost, std::size_t v )
+    {
+        float c = float( cost );
+        boost::uint32_t bits;
+        std::memcpy( &bits, &c, sizeof( bits ) );
+
+        return (boost::uint64_t( bits ) << 32) | boost::uint64_t( v & 0xffffffff );
+    }
+
+    //!pseudo random order of the vertices for the parallel claims
+    static boost::uint64_t claim_key( std::size_t v )
+    {
+        boost::uint32_t h = boost::uint32_t( v );
+
+        h ^= h >> 16;
+        h *= 0x85ebca6bU;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35U;
+        h ^= h >> 16;
+
+        return (boost::uint64_t( h ) << 32) | boost::uint64_t( v & 0xffffffff );
+    }
+
+    //!true if all the faces around v are claimed by key
+    bool owns( uid_t v, boost::uint64_t key, const std::vector< boost::uint64_t > &claims )const
+    {
+        for( std::size_t i = 0; i < VertexFaces[v].size(); ++i )
+        {
+            if( claims[ VertexFaces[v][i] ] != key )
+                return false;
+        }
+
+        return true;
+    }
+
+    //!checks that the collapse keeps the surface manifold and does not fold any face
+    bool can_collapse( uid_t a, uid_t b, const point_t &p, std::vector< uid_t > &ring_a, std::vector< uid_t > &ring_b )const
+    {
+        ring( a, ring_a );
+        ring( b, ring_b );
+
+        std::size_t common = 0;
+        for( std::size_t i = 0; i < ring_a.size(); ++i )
+        {
+            if( std::find( ring_b.begin(), ring_b.end(), ring_a[i] ) != ring_b.end() )
+                ++common;
+        }
+
+        std::size_t shared = 0;
+        for( std::size_t i = 0; i < VertexFaces[a].size(); ++i )
+        {
+            const uid_t *t = &Triangles[ 3 * VertexFaces[a][i] ];
+
+            if( t[0] == b || t[1] == b || t[2] == b )
+                ++shared;
+        }
+
+        //the link condition, the vertices opposite to the edge are the only common ones
+        if( shared == 0 || common != shared )
+            return false;
+
+        //an interior edge between two boundary vertices would pinch the surface
+        if( shared == 2 && Boundary[a] && Boundary[b] )
+            return false;
+
+        return !folds( a, b, p ) && !folds( b, a, p );
+    }
+
+    //!true if moving v to p turns over one of its faces that is not incident to the edge (v,o)
+    bool folds( uid_t v, uid_t o, const point_t &p )const
+    {
+        for( std::size_t i = 0; i < VertexFaces[v].size(); ++i )
+        {
+            const uid_t *t = &Triangles[ 3 * VertexFaces[v][i] ];
+
+            if( t[0] == o || t[1] == o || t[2] == o )
+                continue;
+
+            std::size_t k = (t[0] == v) ? 0 : (t[1] == v) ? 1 : 2;
+
+            const point_t &p1 = Points[ t[ (k + 1) % 3 ] ];
+            const point_t &p2 = Points[ t[ (k + 2) % 3 ] ];
+
+            point_t n0 = math::cross( p1 - Points[v], p2 - Points[v] );
+            point_t n1 = math::cross( p1 - p, p2 - p );
+
+            if( math::dot( n0, n1 ) <= 0.0 )
+                return true;
+        }
+
+        return false;
+    }
+
+    /*!
+    \brief Collapses b to a and moves a to p
+    \param dead if given the removed faces are stored there and the caller removes them from
+    the face lists of the vertices opposite to the edge, so only the data of a and b and of the
+    faces around them is modified
+    \return the number of faces removed
+    */
+    std::size_t collapse_edge( uid_t a, uid_t b, const point_t &p, uid_t *dead = 0 )
+    {
+        std::vector< uid_t > &af = VertexFaces[a];
+        std::size_t removed = 0;
+
+        for( std::size_t i = 0; i < VertexFaces[b].size(); ++i )
+        {
+            const uid_t f = VertexFaces[b][i];
+            uid_t *t = &Triangles[ 3 * f ];
+
+            if( t[0] == a || t[1] == a || t[2] == a )
+            {
+                //the faces of the edge disappear
+                FaceAlive[f] = 0;
+
+                if( dead )
+                    dead[ removed ] = f;
+
+                ++removed;
+
+                for( std::size_t k = 0; k < 3; ++k )
+                {
+                    if( t[k] == a || (t[k] != b && !dead) )
+                    {
+                        std::vector< uid_t > &vf = VertexFaces[ t[k] ];
+                        vf.erase( std::find( vf.begin(), vf.end(), f ) );
+                    }
+                }
+            }
+            else
+            {
+                for( std::size_t k = 0; k < 3; ++k )
+                {
+                    if( t[k] == b )
+                        t[k] = a;
+                }
+
+                af.push_back( f );
+            }
+        }
+
+        VertexFaces[b].clear();
+        Removed[b] = 1;
+
+        Points[a] = p;
+        Quadrics[a] += Quadrics[b];
+        Boundary[a] = Boundary[a] || Boundary[b];
+
+        return removed;
+    }
+
+    //!collapses b to a and updates the queue
+    void collapse( uid_t a, uid_t b, const point_t &p )
+    {
+        FacesAlive -= collapse_edge( a, b, p );
+        Queue.remove( b );
+
+        //re-evaluate the 1-ring of the surviving vertex
+        update( a );
+
+        std::vector< uid_t > neighbours;
+        ring( a, neighbours );
+
+        for( std::size_t i = 0; i < neighbours.size(); ++i )
+        {
+            const uid_t n = neighbours[i];
+
+            if( Locked[n] )
+                continue;
+
+            //only the edge to a changed unless the best collapse was through the edge
+            if( !Queue.contains( n ) || Target[n] == a || Target[n] == b )
+            {
+                update( n );
+                continue;
+            }
+
+            point_t p;
+            double e = cost( n, a, p );
+
+            if( e < Queue.priority( n ) )
+            {
+                Target[n] = a;
+                Optimal[n] = p;
+                Queue.update( n, e );
+            }
+        }
+    }
+
+    //!an edge of a face with sorted vertices
+    struct face_edge
+    {
+        uid_t v0, v1, f;
+
+        bool operator<( const face_edge &o )const
+        {
+            if( v0 != o.v0 ) return v0 < o.v0;
+            if( v1 != o.v1 ) return v1 < o.v1;
+            return f < o.f;
+        }
+    };
+
+    decimate_options Options;
+
+    std::vector< point_t > Points;
+    std::vector< quadric_t > Quadrics;
+
+    //!three vertex indices per face
+    std::vector< uid_t > Triangles;
+    std::vector< char > FaceAlive;
+    std::size_t FacesAlive;
+
+    //!the faces around each vertex
+    std::vector< std::vector< uid_t > > VertexFaces;
+
+    std::vector< char > Locked;
+    std::vector< char > Boundary;
+    std::vector< char > Removed;
+
+    //!the cheapest collapse of each vertex
+    std::vector< uid_t > Target;
+    std::vector< point_t > Optimal;
+    mutable_priority_queue< double > Queue;
+
+    //!scratch rings
+    std::vector< uid_t > RingA, RingB;
+};
+
+/*!
+\brief Simplifies a mesh with quadric error edge collapses
+\param m the mesh
+\param target_faces the number of faces to reach
+\param options the decimation options
+\return the number of faces of the decimated mesh
+
+The polygons are triangulated first, so the result and target_faces count triangles.
+The boundary vertices are kept fixed unless options.lock_boundary is false and the
+edges sharper than options.feature_angle are preserved by constraint planes.
+With options.parallel the collapses are applied in rounds of independent sets on all the
+threads, which trades a little quality for speed on large meshes.
+*/
+template<typename MeshType>
+std::size_t decimate( MeshType &m, std::size_t target_faces, const decimate_options &options = decimate_options() )
+{
+    indexed_mesh< typename MeshType::real_t > im;
+    make_indexed( m, im, options.threads );
+
+    quadric_decimator< typename MeshType::real_t > decimator( im, options );
+    if( options.parallel )
+        decimator.run_parallel( target_faces );
+    else
+        decimator.run( target_faces );
+    decimator.apply( m );
+
+    return m.faces_size();
+}
+
+}
+
+}
+
+#endif
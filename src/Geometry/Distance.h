@@ -0,0 +1,231 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_DISTANCE_H
+#define GEOMETRY_DISTANCE_H
+
+#include "Indexed.h"
+#include "Bvh.h"
+#include "Parallel.h"
+#include "Properties.h"
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Distance from the surface of a mesh to another one
+struct mesh_distance
+{
+    mesh_distance() : max( 0.0 ), mean( 0.0 ), rms( 0.0 ), samples( 0 ) {}
+
+    //!largest distance of the samples and the vertices
+    double max;
+
+    //!area weighted mean and root mean square distance of the samples
+    double mean, rms;
+
+    //!number of points sampled on the faces
+    std::size_t samples;
+
+    //!distance of every vertex to the other mesh
+    std::vector< double > vertex_error;
+};
+
+namespace detail
+{
+
+//!two numbers in [0,1) that only depend on i, for the position of a sample in its triangle
+inline void sample_coords( boost::uint64_t i, double &u, double &v )
+{
+    boost::uint64_t z = i + 0x9e3779b97f4a7c15ULL;
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+
+    u = double( z >> 32 ) / 4294967296.0;
+    v = double( z & 0xffffffffULL ) / 4294967296.0;
+}
+
+}
+
+/*!
+\brief Distance from a mesh to the faces in a bvh
+\param a the mesh to sample
+\param b the bvh of the other mesh
+\param samples number of points sampled on the faces of a
+\param threads number of threads, 0 for the default
+\return the distances of the samples and of the vertices of a
+
+The polygons are split into fans of triangles. Sample i lies in the triangle that holds the 
+area (i + 1/2) / samples of the running sum of the triangle areas, so every triangle gets 
+samples in proportion to its area, at a position given by a hash of i. The sums are pairwise 
+over the samples, the result is the same for any number of threads. The points without a 
+closest point, all of them when b has no faces, are at an infinite distance.
+*/
+template<typename Real>
+mesh_distance surface_distance( const indexed_mesh< Real > &a, const face_bvh< Real > &b, std::size_t samples, int threads = 0 )
+{
+    typedef math::vec3< double > point_t;
+    typedef typename face_bvh< Real >::point_t bvh_point_t;
+
+    const std::ptrdiff_t nv = std::ptrdiff_t( a.verts_size() );
+    const std::ptrdiff_t nf = std::ptrdiff_t( a.faces_size() );
+
+    threads = parallel_threads( threads );
+
+    mesh_distance r;
+    r.vertex_error.assign( nv, std::numeric_limits< double >::infinity() );
+
+    #pragma omp parallel for num_threads( threads ) schedule(dynamic,1024)
+    for( std::ptrdiff_t v = 0; v < nv; ++v )
+    {
+        typename face_bvh< Real >::closest_t c;
+
+        if( b.closest_point( a.points[v], c ) )
+            r.vertex_error[v] = math::distance( point_t( a.points[v] ), point_t( c.point ) );
+    }
+
+    //the running sum of the areas of the fan triangles
+    std::vector< std::size_t > tri_start( nf + 1, 0 );
+
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        tri_start[f+1] = tri_start[f] + (a.face_size( f ) >= 3 ? a.face_size( f ) - 2 : 0);
+
+    const std::ptrdiff_t nt = std::ptrdiff_t( tri_start.back() );
+
+    std::vector< double > areas( nt );
+    std::vector< uid_t > tris( 3 * nt );
+
+    #pragma omp parallel for num_threads( threads ) schedule(dynamic,1024)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+    {
+        const uid_t *fv = &a.face_verts[0] + a.face_start[f];
+
+        for( std::size_t t = tri_start[f], k = 1; t < tri_start[f+1]; ++t, ++k )
+        {
+            tris[ 3 * t ] = fv[0];
+            tris[ 3 * t + 1 ] = fv[k];
+            tris[ 3 * t + 2 ] = fv[k+1];
+
+            const point_t p0( a.points[ fv[0] ] ), p1( a.points[ fv[k] ] ), p2( a.points[ fv[k+1] ] );
+            areas[t] = 0.5 * math::magnitude( math::cross( p1 - p0, p2 - p0 ) );
+        }
+    }
+
+    for( std::ptrdiff_t t = 1; t < nt; ++t )
+        areas[t] += areas[t-1];
+
+    const double total = nt ? areas.back() : 0.0;
+
+    if( total > 0.0 && samples > 0 )
+    {
+        std::vector< double > distances( samples ), squares( samples );
+
+        #pragma omp parallel for num_threads( threads ) schedule(dynamic,4096)
+        for( std::ptrdiff_t i = 0; i < std::ptrdiff_t( samples ); ++i )
+        {
+            const double at = (double( i ) + 0.5) * total / double( samples );
+            const std::size_t t = std::min( std::size_t( std::upper_bound( areas.begin(), areas.end(), at ) - areas.begin() ), 
+                                            std::size_t( nt - 1 ) );
+
+            double u, v;
+            detail::sample_coords( boost::uint64_t( i ), u, v );
+
+            //uniform in the triangle
+            const double s = std::sqrt( u );
+            const point_t p0( a.points[ tris[ 3 * t ] ] ), p1( a.points[ tris[ 3 * t + 1 ] ] ), p2( a.points[ tris[ 3 * t + 2 ] ] );
+            const point_t p = p0 * (1.0 - s) + p1 * (s * (1.0 - v)) + p2 * (s * v);
+
+            typename face_bvh< Real >::closest_t c;
+            double d = std::numeric_limits< double >::infinity();
+
+            if( b.closest_point( bvh_point_t( p ), c ) )
+                d = math::distance( p, point_t( c.point ) );
+
+            distances[i] = d;
+            squares[i] = d * d;
+        }
+
+        r.samples = samples;
+        r.mean = pairwise_sum( distances, 0, samples ) / double( samples );
+        r.rms = std::sqrt( pairwise_sum( squares, 0, samples ) / double( samples ) );
+        r.max = *std::max_element( distances.begin(), distances.end() );
+    }
+
+    if( nv )
+        r.max = std::max( r.max, *std::max_element( r.vertex_error.begin(), r.vertex_error.end() ) );
+
+    return r;
+}
+
+/*!
+\brief Distance from the surface of a mesh to the surface of another one
+\param a the mesh to sample
+\param b the other mesh
+\param samples number of points sampled on the faces of a
+\param threads number of threads, 0 for the default
+\return the distances of the samples and of the vertices of a
+\note the distance is one way, see hausdorff_distance
+*/
+template<typename MeshType>
+mesh_distance surface_distance( const MeshType &a, const MeshType &b, std::size_t samples = 100000, int threads = 0 )
+{
+    indexed_mesh< typename MeshType::real_t > ia, ib;
+    make_indexed( a, ia, threads );
+    make_indexed( b, ib, threads );
+
+    face_bvh< typename MeshType::real_t > bvh( ib, threads );
+
+    return surface_distance( ia, bvh, samples, threads );
+}
+
+/*!
+\brief Largest of the distances from a to b and from b to a
+\param a a mesh
+\param b the other mesh
+\param samples number of points sampled on the faces of each mesh
+\param threads number of threads, 0 for the default
+*/
+template<typename MeshType>
+double hausdorff_distance( const MeshType &a, const MeshType &b, std::size_t samples = 100000, int threads = 0 )
+{
+    return std::max( surface_distance( a, b, samples, threads ).max, surface_distance( b, a, samples, threads ).max );
+}
+
+}
+
+}
+
+#endif
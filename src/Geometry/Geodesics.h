@@ -0,0 +1,587 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+
+#ifndef GEOMETRY_GEODESICS_H
+#define GEOMETRY_GEODESICS_H
+
+#include "Indexed.h"
+#include "UnionFind.h"
+#include "PriorityQueue.h"
+#include "Parallel.h"
+#include "../Math/Cholesky.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Algorithm of the geodesic distances
+enum geodesic_method
+{
+    //!shortest paths along the edges, an upper bound of the distance
+    GEODESIC_DIJKSTRA,
+
+    //!fast marching over the triangles, the wave is unfolded from the two known corners
+    GEODESIC_FAST_MARCHING,
+
+    //!heat method of Crane, Weischedel and Wardetzky (2013) with prefactored systems
+    GEODESIC_HEAT
+};
+
+/*!
+\brief Geodesic distances from sets of source vertices
+
+The polygons are split into fans of triangles and the connectivity is kept in flat arrays, 
+the neighbours of every vertex with the edge lengths and the corners of the triangles around 
+every vertex. Dijkstra and fast marching run on a radix_heap. The heat method solves two 
+sparse systems, the heat flow (M + t L) u = s and the Poisson equation L d = div X, whose 
+Cholesky factors are computed once by prepare_heat() and reused by every query, so a query 
+costs two triangular solves and two linear passes. The vertices that can not be reached get 
+an infinite distance. The queries are const and only read the object, so they can run from 
+many threads once the heat systems are prepared, distances() runs a batch of them in parallel.
+*/
+template<typename Real>
+class geodesics
+{
+public:
+    typedef indexed_mesh< Real > indexed_mesh_t;
+    typedef math::vec3< double > dvec_t;
+
+    geodesics( const indexed_mesh_t &im, int threads = 0 ) : Threads( threads ), Time( 0.0 )
+    {
+        init( im );
+    }
+
+    std::size_t verts_size()const { return Points.size(); }
+
+    //!true once the systems of the heat method are factored
+    bool heat_ready()const { return Flow.factored() && Poisson.factored(); }
+
+    /*!
+    \brief Factors the systems of the heat method
+    \param time the time step in multiples of the squared mean edge length
+    \return false if the cotangent Laplacian of the mesh is degenerate
+    */
+    bool prepare_heat( double time = 1.0 )
+    {
+        Time = time * MeanLength * MeanLength;
+        return factor_heat();
+    }
+
+    /*!
+    \brief Distances of all the vertices from the closest source
+    \param method the algorithm
+    \param sources the source vertex ids
+    \param distance the distance of every vertex by id
+    \note the heat method needs prepare_heat() first, without the factors it falls back to 
+    fast marching
+    */
+    void distance( geodesic_method method, const std::vector< uid_t > &sources, std::vector< double > &distance )const
+    {
+        if( method == GEODESIC_HEAT && !heat_ready() )
+            method = GEODESIC_FAST_MARCHING;
+
+        run( method, sources, distance, Threads );
+    }
+
+    //!the distances of many independent queries, the queries run in parallel
+    void distances( geodesic_method method, const std::vector< std::vector< uid_t > > &queries, 
+                    std::vector< std::vector< double > > &distance )const
+    {
+        if( method == GEODESIC_HEAT && !heat_ready() )
+            method = GEODESIC_FAST_MARCHING;
+
+        distance.resize( queries.size() );
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(dynamic,1)
+        for( std::ptrdiff_t q = 0; q < std::ptrdiff_t( queries.size() ); ++q )
+            run( method, queries[q], distance[q], 1 );
+    }
+
+private:
+    static double infinity() { return std::numeric_limits< double >::infinity(); }
+
+    void run( geodesic_method method, const std::vector< uid_t > &sources, std::vector< double > &distance, int threads )const
+    {
+        if( method == GEODESIC_DIJKSTRA )
+            dijkstra( sources, distance );
+        else if( method == GEODESIC_FAST_MARCHING )
+            fast_marching( sources, distance );
+        else
+            heat( sources, distance, threads );
+    }
+
+    void init( const indexed_mesh_t &im )
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+        const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+
+        Points.resize( nv );
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+            Points[v] = dvec_t( im.points[v].x, im.points[v].y, im.points[v].z );
+
+        //fans of triangles from the first vertex of every face
+        std::vector< uid_t > tri_start( nf + 1, 0 );
+
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+            tri_start[f+1] = tri_start[f] + uid_t( im.face_size( f ) >= 3 ? im.face_size( f ) - 2 : 0 );
+
+        Tris.resize( 3 * tri_start.back() );
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+        {
+            const uid_t *v = &im.face_verts[0] + im.face_start[f];
+
+            for( uid_t t = tri_start[f], i = 1; t < tri_start[f+1]; ++t, ++i )
+            {
+                Tris[ 3 * t ] = v[0];
+                Tris[ 3 * t + 1 ] = v[i];
+                Tris[ 3 * t + 2 ] = v[i+1];
+            }
+        }
+
+        group_by_key( Tris, nv, VertexCorners, Threads );
+
+        //the neighbours are the other corners of the triangles around a vertex
+        Neighbours.start.assign( nv + 1, 0 );
+
+        std::vector< uid_t > row_size( nv );
+
+        #pragma omp parallel num_threads( parallel_threads( Threads ) )
+        {
+            std::vector< uid_t > row;
+
+            #pragma omp for schedule(dynamic,1024)
+            for( std::ptrdiff_t v = 0; v < nv; ++v )
+            {
+                adjacent( uid_t( v ), row );
+                row_size[v] = uid_t( row.size() );
+            }
+
+            #pragma omp single
+            {
+                for( std::ptrdiff_t v = 0; v < nv; ++v )
+                    Neighbours.start[v+1] = Neighbours.start[v] + row_size[v];
+
+                Neighbours.items.resize( Neighbours.start.back() );
+                Lengths.resize( Neighbours.start.back() );
+                Weights.assign( Neighbours.start.back(), 0.0 );
+                Diagonal.assign( nv, 0.0 );
+                Mass.assign( nv, 0.0 );
+            }
+
+            #pragma omp for schedule(dynamic,1024)
+            for( std::ptrdiff_t v = 0; v < nv; ++v )
+            {
+                adjacent( uid_t( v ), row );
+                std::copy( row.begin(), row.end(), Neighbours.items.begin() + Neighbours.start[v] );
+
+                for( uid_t i = Neighbours.start[v]; i < Neighbours.start[v+1]; ++i )
+                    Lengths[i] = math::magnitude( Points[ Neighbours.items[i] ] - Points[v] );
+
+                //cotangent weights and lumped mass from the triangles around v
+                for( const uid_t *c = VertexCorners.row_begin( v ); c != VertexCorners.row_end( v ); ++c )
+                {
+                    const uid_t t = *c / 3, l = *c % 3;
+                    const uid_t j = Tris[ 3 * t + (l + 1) % 3 ], k = Tris[ 3 * t + (l + 2) % 3 ];
+
+                    Weights[ position( uid_t( v ), j ) ] += 0.5 * cotangent( Points[v], Points[j], Points[k] );
+                    Weights[ position( uid_t( v ), k ) ] += 0.5 * cotangent( Points[v], Points[k], Points[j] );
+
+                    Mass[v] += math::magnitude( math::cross( Points[j] - Points[v], Points[k] - Points[v] ) ) / 6.0;
+                }
+
+                for( uid_t i = Neighbours.start[v]; i < Neighbours.start[v+1]; ++i )
+                    Diagonal[v] += Weights[i];
+            }
+        }
+
+        double total = 0.0;
+
+        for( std::size_t i = 0; i < Lengths.size(); ++i )
+            total += Lengths[i];
+
+        MeanLength = Lengths.empty() ? 1.0 : total / double( Lengths.size() );
+
+        union_find sets( nv );
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+            for( uid_t i = Neighbours.start[v]; i < Neighbours.start[v+1]; ++i )
+                sets.unite( uid_t( v ), Neighbours.items[i] );
+
+        Components = sets.labels( Component, Threads );
+    }
+
+    //!the sorted distinct vertices that share a triangle with v
+    void adjacent( uid_t v, std::vector< uid_t > &row )const
+    {
+        row.clear();
+
+        for( const uid_t *c = VertexCorners.row_begin( v ); c != VertexCorners.row_end( v ); ++c )
+        {
+            const uid_t t = *c / 3, l = *c % 3;
+
+            row.push_back( Tris[ 3 * t + (l + 1) % 3 ] );
+            row.push_back( Tris[ 3 * t + (l + 2) % 3 ] );
+        }
+
+        std::sort( row.begin(), row.end() );
+        row.erase( std::unique( row.begin(), row.end() ), row.end() );
+        row.erase( std::remove( row.begin(), row.end(), v ), row.end() );
+    }
+
+    //!position of the neighbour w in the row of v
+    uid_t position( uid_t v, uid_t w )const
+    {
+        return uid_t( std::lower_bound( Neighbours.items.begin() + Neighbours.start[v], 
+                                        Neighbours.items.begin() + Neighbours.start[v+1], w ) - Neighbours.items.begin() );
+    }
+
+    //!cotangent of the angle at c of the triangle abc, 0 when it is degenerate
+    static double cotangent( const dvec_t &a, const dvec_t &b, const dvec_t &c )
+    {
+        const dvec_t u = a - c, v = b - c;
+        const double sine = math::magnitude( math::cross( u, v ) );
+
+        return sine > 0.0 ? math::dot( u, v ) / sine : 0.0;
+    }
+
+    //!factors M + t L and L + e M on the full pattern of the neighbours
+    bool factor_heat()
+    {
+        const std::size_t nv = Points.size();
+
+        std::vector< std::size_t > start( nv + 1, 0 ), rows;
+        std::vector< double > flow, poisson;
+
+        rows.reserve( Neighbours.items.size() + nv );
+        flow.reserve( Neighbours.items.size() + nv );
+        poisson.reserve( Neighbours.items.size() + nv );
+
+        //a small multiple of the mass fixes the constant of the Poisson equation
+        const double shift = 1e-6 / (MeanLength * MeanLength);
+
+        for( std::size_t v = 0; v < nv; ++v )
+        {
+            bool diagonal = false;
+
+            for( uid_t i = Neighbours.start[v]; i <= Neighbours.start[v+1]; ++i )
+            {
+                if( !diagonal && (i == Neighbours.start[v+1] || Neighbours.items[i] > v) )
+                {
+                    //the vertices without triangles get an identity row
+                    const bool lone = Neighbours.start[v] == Neighbours.start[v+1];
+
+                    rows.push_back( v );
+                    flow.push_back( lone ? 1.0 : Mass[v] + Time * Diagonal[v] );
+                    poisson.push_back( lone ? 1.0 : Diagonal[v] + shift * Mass[v] );
+                    diagonal = true;
+                }
+
+                if( i == Neighbours.start[v+1] )
+                    break;
+
+                rows.push_back( Neighbours.items[i] );
+                flow.push_back( -Time * Weights[i] );
+                poisson.push_back( -Weights[i] );
+            }
+
+            start[v+1] = rows.size();
+        }
+
+        Flow.analyze( nv, start, rows );
+        Poisson = Flow;
+
+        return Flow.factor( flow ) && Poisson.factor( poisson );
+    }
+
+    void dijkstra( const std::vector< uid_t > &sources, std::vector< double > &distance )const
+    {
+        const std::size_t nv = Points.size();
+        std::vector< char > done( nv, 0 );
+        radix_heap heap;
+
+        distance.assign( nv, infinity() );
+
+        for( std::size_t i = 0; i < sources.size(); ++i )
+        {
+            distance[ sources[i] ] = 0.0;
+            heap.push( 0.0, sources[i] );
+        }
+
+        while( !heap.empty() )
+        {
+            double d;
+            const uid_t v = heap.pop( d );
+
+            if( done[v] )
+                continue;
+
+            done[v] = 1;
+
+            for( uid_t i = Neighbours.start[v]; i < Neighbours.start[v+1]; ++i )
+            {
+                const uid_t w = Neighbours.items[i];
+                const double n = distance[v] + Lengths[i];
+
+                if( !done[w] && n < distance[w] )
+                {
+                    distance[w] = n;
+                    heap.push( n, w );
+                }
+            }
+        }
+    }
+
+    /*!
+    \brief Distance at c from a point source whose distances to a and b are known
+    
+    The triangle is unfolded in the plane with ab on the x axis and c above it, the source 
+    lies below at distance da from a and db from b. The value is used only when the straight 
+    path from the source to c crosses the edge ab.
+    */
+    static double unfold( const dvec_t &a, const dvec_t &b, const dvec_t &c, double da, double db )
+    {
+        const dvec_t ab = b - a, ac = c - a;
+        const double l = math::magnitude( ab );
+
+        if( l <= 0.0 )
+            return infinity();
+
+        const double cx = math::dot( ac, ab ) / l;
+        const double cy = math::magnitude( math::cross( ac, ab ) ) / l;
+        const double sx = (da * da - db * db + l * l) / (2.0 * l);
+        const double sy2 = da * da - sx * sx;
+
+        if( cy <= 0.0 || sy2 < 0.0 )
+            return infinity();
+
+        const double sy = -std::sqrt( sy2 );
+        const double x = sx + (cx - sx) * (-sy) / (cy - sy);
+
+        if( x < 0.0 || x > l )
+            return infinity();
+
+        return std::sqrt( (cx - sx) * (cx - sx) + (cy - sy) * (cy - sy) );
+    }
+
+    void fast_marching( const std::vector< uid_t > &sources, std::vector< double > &distance )const
+    {
+        const std::size_t nv = Points.size();
+        std::vector< char > done( nv, 0 );
+        radix_heap heap;
+
+        distance.assign( nv, infinity() );
+
+        for( std::size_t i = 0; i < sources.size(); ++i )
+        {
+            distance[ sources[i] ] = 0.0;
+            heap.push( 0.0, sources[i] );
+        }
+
+        while( !heap.empty() )
+        {
+            double d;
+            const uid_t v = heap.pop( d );
+
+            if( done[v] )
+                continue;
+
+            done[v] = 1;
+
+            for( uid_t i = Neighbours.start[v]; i < Neighbours.start[v+1]; ++i )
+            {
+                const uid_t w = Neighbours.items[i];
+                const double n = distance[v] + Lengths[i];
+
+                if( !done[w] && n < distance[w] )
+                {
+                    distance[w] = n;
+                    heap.push( n, w );
+                }
+            }
+
+            //the triangles with a second accepted corner update the third one
+            for( const uid_t *c = VertexCorners.row_begin( v ); c != VertexCorners.row_end( v ); ++c )
+            {
+                const uid_t t = *c / 3, l = *c % 3;
+                uid_t a = Tris[ 3 * t + (l + 1) % 3 ], b = Tris[ 3 * t + (l + 2) % 3 ];
+
+                if( done[a] == done[b] )
+                    continue;
+
+                if( done[b] )
+                    std::swap( a, b );
+
+                const double n = unfold( Points[v], Points[a], Points[b], distance[v], distance[a] );
+
+                if( n < distance[b] )
+                {
+                    distance[b] = n;
+                    heap.push( n, b );
+                }
+            }
+        }
+    }
+
+    void heat( const std::vector< uid_t > &sources, std::vector< double > &distance, int threads )const
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( Points.size() );
+        const std::ptrdiff_t nt = std::ptrdiff_t( Tris.size() / 3 );
+
+        std::vector< double > u( nv, 0.0 );
+
+        for( std::size_t i = 0; i < sources.size(); ++i )
+            u[ sources[i] ] = 1.0;
+
+        Flow.solve( u );
+
+        //the normalized gradients of the heat point away from the sources
+        std::vector< dvec_t > field( nt );
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t t = 0; t < nt; ++t )
+        {
+            const uid_t *v = &Tris[ 3 * t ];
+            const dvec_t n = math::cross( Points[ v[1] ] - Points[ v[0] ], Points[ v[2] ] - Points[ v[0] ] );
+            dvec_t g( 0.0 );
+
+            for( int i = 0; i < 3; ++i )
+                g += math::cross( n, Points[ v[ (i + 2) % 3 ] ] - Points[ v[ (i + 1) % 3 ] ] ) * u[ v[i] ];
+
+            const double length = math::magnitude( g );
+            field[t] = length > 0.0 ? g * (-1.0 / length) : dvec_t( 0.0 );
+        }
+
+        std::vector< double > div( nv, 0.0 );
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(dynamic,1024)
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+        {
+            double s = 0.0;
+
+            for( const uid_t *c = VertexCorners.row_begin( v ); c != VertexCorners.row_end( v ); ++c )
+            {
+                const uid_t t = *c / 3, l = *c % 3;
+                const uid_t j = Tris[ 3 * t + (l + 1) % 3 ], k = Tris[ 3 * t + (l + 2) % 3 ];
+
+                s += 0.5 * (cotangent( Points[v], Points[j], Points[k] ) * math::dot( Points[j] - Points[v], field[t] ) + 
+                            cotangent( Points[v], Points[k], Points[j] ) * math::dot( Points[k] - Points[v], field[t] ));
+            }
+
+            div[v] = -s;
+        }
+
+        //L is the positive cotangent Laplacian, the opposite of the Laplace-Beltrami operator
+        Poisson.solve( div );
+
+        //the distances are shifted to start from zero at the closest source of every component
+        std::vector< double > low( Components, infinity() );
+
+        for( std::size_t i = 0; i < sources.size(); ++i )
+            low[ Component[ sources[i] ] ] = std::min( low[ Component[ sources[i] ] ], div[ sources[i] ] );
+
+        distance.resize( nv );
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+        {
+            const double l = low[ Component[v] ];
+            distance[v] = l == infinity() ? infinity() : std::max( div[v] - l, 0.0 );
+        }
+    }
+
+    int Threads;
+
+    //!vertex coordinates and the three vertices of every triangle
+    std::vector< dvec_t > Points;
+    std::vector< uid_t > Tris;
+
+    //!corners of the triangles around every vertex, triangle c / 3 and corner c % 3
+    index_rows VertexCorners;
+
+    //!neighbours of every vertex with the edge lengths and the cotangent weights
+    index_rows Neighbours;
+    std::vector< double > Lengths;
+    std::vector< double > Weights;
+
+    //!sum of the weights and lumped mass of every vertex
+    std::vector< double > Diagonal;
+    std::vector< double > Mass;
+
+    double MeanLength;
+
+    //!connected components of the vertices
+    std::vector< uid_t > Component;
+    std::size_t Components;
+
+    //!heat flow and Poisson factors, the time step of the flow
+    math::sparse_cholesky Flow;
+    math::sparse_cholesky Poisson;
+    double Time;
+};
+
+/*!
+\brief Geodesic distances of the vertices of a mesh from a set of sources
+\param m the mesh
+\param sources the source vertex ids
+\param distance the distance of every vertex by id, infinite where no source is reached
+\param method the algorithm
+\param threads number of threads, 0 for the default
+
+For many queries on the same mesh keep a geodesics object, it holds the flat connectivity and 
+the factors of the heat method.
+*/
+template<typename MeshType>
+void geodesic_distance( const MeshType &m, const std::vector< uid_t > &sources, std::vector< double > &distance,
+                        geodesic_method method = GEODESIC_FAST_MARCHING, int threads = 0 )
+{
+    indexed_mesh< typename MeshType::real_t > im;
+    make_indexed( m, im, threads );
+
+    geodesics< typename MeshType::real_t > g( im, threads );
+
+    if( method == GEODESIC_HEAT )
+        g.prepare_heat();
+
+    g.distance( method, sources, distance );
+}
+
+}
+
+}
+
+#endif
@@ -31,6 +31,7 @@ misrepresented as being the original software.
 #include <vector>
 #include <deque>
 #include <list>
+#include <algorithm>
 #include <boost/array.hpp>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/range/iterator_range.hpp>
@@ -185,6 +186,15 @@ namespace arch
       */
       bool flip_face( face_ptr_t f );
 
+      /*!
+      *\brief replaces the connectivity of the whole mesh in one pass
+      *\param verts the vertices of the new mesh, their ids become their positions in the array
+      *\param sizes the number of vertices of each new face
+      *\param indices the positions in verts of the vertices of all the faces, stored consecutively
+      *\note all the faces and edges are recreated, the vertices that are not in verts are removed
+      */
+      void rebuild( const vertex_array_t &verts, const std::vector< std::size_t > &sizes, const std::vector< uid_t > &indices );
+
       void clear();
 
     private:
@@ -0,0 +1,842 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#ifndef GEOMETRY_IMPROVE_H
+#define GEOMETRY_IMPROVE_H
+
+#include "Algorithms.h"
+#include "../Math/Quadric.h"
+
+#include <boost/unordered_map.hpp>
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Options of the mesh improvement, the angles are in degrees
+struct improve_options
+{
+    improve_options() : 
+        iterations(1), improve_angle(14.0), skew_angle(5.0), max_angle(175.0), 
+        feature_angle(5.0), flip_feature_angle(15.0), node_equiv(0.001), min_volume(0.001), 
+        max_operations(0) {}
+
+    //!number of refine, cap and needle passes
+    int iterations;
+
+    //!the faces with a smaller angle are refined by longest edge bisection
+    double improve_angle;
+
+    //!the faces with a smaller angle are needles and their shortest edge is collapsed
+    double skew_angle;
+
+    //!the faces with a larger angle are caps and their longest edge is flipped or split
+    double max_angle;
+
+    //!dihedral angle above which an edge is a feature, the features are split without smoothing
+    double feature_angle;
+
+    //!dihedral angle above which the Delaunay flips of the refinement are refused
+    double flip_feature_angle;
+
+    //!the edges shorter than this are always collapsed to their middle
+    double node_equiv;
+
+    //!the Delaunay flips of edges whose quad spans a larger volume are refused
+    double min_volume;
+
+    //!maximum number of splits or collapses of each pass, 0 for the number of faces
+    std::size_t max_operations;
+};
+
+//!Number of operations applied by the mesh improvement
+struct improve_stats
+{
+    improve_stats() : flips(0), splits(0), collapses(0) {}
+
+    std::size_t flips, splits, collapses;
+};
+
+/*!
+\brief Triangle quality improvement with edge flips, splits and collapses
+
+The port of archmind_improve.py on the mesh operators: skinny faces are refined by splitting
+the terminal edge of their longest edge propagation path on a Hermite curve followed by Delaunay flips,
+caps are removed by flipping or splitting their longest edge and needles by collapsing their shortest
+edge to the quadric optimal point.
+
+The metrics of the faces are cached by face id and checked against the unique id of the face,
+so the faces created by an operation are measured when they are first needed. Each pass keeps
+its candidates in a priority queue and after an operation only the faces of the affected
+1-rings are measured again and queued.
+*/
+template<typename MeshType>
+class mesh_improver
+{
+public:
+    typedef typename MeshType::real_t real_t;
+    typedef typename MeshType::vertex_t vertex_t;
+    typedef typename MeshType::edge_t edge_t;
+    typedef typename MeshType::face_t face_t;
+    typedef typename MeshType::vertex_ptr_t vertex_ptr_t;
+    typedef typename MeshType::edge_ptr_t edge_ptr_t;
+    typedef typename MeshType::face_ptr_t face_ptr_t;
+    typedef math::vec3<double> point_t;
+    typedef math::quadric<double> quadric_t;
+
+    mesh_improver( MeshType &m, const improve_options &options = improve_options() ) 
+        : Mesh( m ), Options( options ), Pass( REFINE )
+    {
+        const double to_radians = 3.14159265358979323846 / 180.0;
+
+        FeatureCos = std::cos( Options.feature_angle * to_radians );
+        FlipFeatureCos = std::cos( Options.flip_feature_angle * to_radians );
+    }
+
+    const improve_stats &stats()const { return Stats; }
+
+    //!refines the faces with an angle below improve_angle, each face is split once
+    void refine()
+    {
+        start( REFINE );
+
+        face_ptr_t f;
+        std::size_t ops = 0;
+
+        while( ops < Budget && pop( f ) )
+        {
+            //a flip of the longest edge may be enough
+            std::vector< edge_ptr_t > flips( 1, face_edge( f, longest( metrics( f ) ) ) );
+            flip_edges( flips );
+
+            if( is_valid( f ) )
+            {
+                edge_ptr_t e = terminal_edge( f );
+
+                if( triangles_only( e ) )
+                {
+                    split_edge( e, 0.5, true );
+                    ++ops;
+                }
+            }
+
+            //one split for each face, the faces created wait for the next iteration since 
+            //the bisection of needles would only create smaller needles
+            Touched.clear();
+        }
+    }
+
+    //!flips or splits the longest edge of the faces with an angle above max_angle
+    void remove_caps()
+    {
+        start( CAPS );
+
+        face_ptr_t f;
+        std::size_t ops = 0;
+
+        while( ops < Budget && pop( f ) )
+        {
+            const std::size_t k = longest( metrics( f ) );
+            edge_ptr_t e = face_edge( f, k );
+
+            if( !flip_edge( e, true ) && triangles_only( e ) )
+            {
+                //split at the projection of the apex
+                point_t p0( e->verts()[0]->point() );
+                point_t d = point_t( e->verts()[1]->point() ) - p0;
+                point_t apex( face_vertex( f, (k + 2) % 3 )->point() );
+
+                double len = math::dot( d, d );
+                double t = len > 0.0 ? math::dot( apex - p0, d ) / len : 0.0;
+
+                if( t > 0.000001 && t < 0.999999 )
+                {
+                    split_edge( e, t, false );
+                    ++ops;
+                }
+            }
+
+            requeue();
+        }
+    }
+
+    //!collapses the shortest edge of the faces with an angle below skew_angle
+    void remove_needles()
+    {
+        start( NEEDLES );
+
+        //plane quadrics weighted by the face area
+        Quadrics.clear();
+
+        for( typename MeshType::face_iterator_t f = Mesh.faces_begin(); f != Mesh.faces_end(); ++f )
+        {
+            const face_metrics &fm = metrics( *f );
+
+            if( !fm.triangle )
+                continue;
+
+            typename face_t::vertex_iterator_t v = (*f)->verts_begin();
+            for( std::size_t k = 0; k < 3; ++k, ++v )
+                Quadrics[ (*v)->unique_id() ] += quadric_t( fm.normal, point_t( (*v)->point() ), fm.area );
+        }
+
+        face_ptr_t f;
+        std::size_t ops = 0;
+
+        while( ops < Budget && pop( f ) )
+        {
+            const face_metrics &fm = metrics( f );
+            const std::size_t k = shortest( fm );
+
+            //only the needles that are not caps
+            if( fm.max_angle() < Options.max_angle || fm.lengths[k] < Options.node_equiv )
+            {
+                if( collapse_edge( face_edge( f, k ), fm.lengths[k] ) )
+                    ++ops;
+            }
+
+            requeue();
+        }
+
+        Quadrics.clear();
+    }
+
+private:
+    enum pass_t { REFINE, CAPS, NEEDLES };
+
+    //!angles in degrees, edge lengths, unit normal and area of a face
+    struct face_metrics
+    {
+        face_metrics() : uid( NO_ID ), triangle( false ), normal( 0.0 ), area( 0.0 ) {}
+
+        double min_angle()const { return std::min( angles[0], std::min( angles[1], angles[2] ) ); }
+        double max_angle()const { return std::max( angles[0], std::max( angles[1], angles[2] ) ); }
+
+        //!unique id of the face measured, NO_ID when the metrics are stale
+        uid_t uid;
+        bool triangle;
+
+        //!the angle at each vertex and the length of the edge from each vertex to the next
+        double angles[3], lengths[3];
+
+        point_t normal;
+        double area;
+    };
+
+    struct queue_entry
+    {
+        queue_entry( double p, const face_ptr_t &f ) : priority( p ), face( f ) {}
+
+        //!the smallest priority is at the top of the queue
+        bool operator<( const queue_entry &o )const { return priority > o.priority; }
+
+        double priority;
+        face_ptr_t face;
+    };
+
+    //!the cached metrics of the face
+    const face_metrics &metrics( const face_ptr_t &f )
+    {
+        const uid_t id = f->id();
+
+        if( id >= Cache.size() )
+            Cache.resize( std::max( Mesh.faces_size(), id + 1 ) );
+
+        face_metrics &fm = Cache[id];
+
+        if( fm.uid == f->unique_id() )
+            return fm;
+
+        fm = face_metrics();
+        fm.uid = f->unique_id();
+        fm.triangle = f->edges_size() == 3;
+
+        if( !fm.triangle )
+            return fm;
+
+        point_t p[3];
+        typename face_t::vertex_iterator_t v = f->verts_begin();
+        for( std::size_t k = 0; k < 3; ++k, ++v )
+            p[k] = point_t( (*v)->point() );
+
+        const double to_degrees = 180.0 / 3.14159265358979323846;
+
+        point_t n = math::cross( p[1] - p[0], p[2] - p[0] );
+        double len = math::magnitude( n );
+
+        fm.normal = len > 0.0 ? n / len : point_t( 0.0 );
+        fm.area = 0.5 * len;
+
+        for( std::size_t k = 0; k < 3; ++k )
+        {
+            point_t a = p[(k + 1) % 3] - p[k];
+            point_t b = p[(k + 2) % 3] - p[k];
+
+            fm.lengths[k] = math::magnitude( a );
+
+            //atan2 keeps the sum of the angles at 180 for the degenerate triangles
+            fm.angles[k] = std::atan2( math::magnitude( math::cross( a, b ) ), math::dot( a, b ) ) * to_degrees;
+        }
+
+        return fm;
+    }
+
+    //!true and the queue priority if the face is a candidate of the current pass
+    bool candidate( const face_metrics &fm, double &priority )const
+    {
+        if( !fm.triangle )
+            return false;
+
+        switch( Pass )
+        {
+        case REFINE:
+            priority = fm.min_angle();
+            return priority < Options.improve_angle;
+        case CAPS:
+            priority = -fm.max_angle();
+            return -priority > Options.max_angle;
+        default:
+            priority = fm.min_angle();
+            return priority < Options.skew_angle;
+        }
+    }
+
+    //!queues the candidates of a pass
+    void start( pass_t pass )
+    {
+        Pass = pass;
+        Queue = std::priority_queue< queue_entry >();
+        Touched.clear();
+
+        Budget = Options.max_operations ? Options.max_operations : Mesh.faces_size();
+
+        double priority;
+        for( typename MeshType::face_iterator_t f = Mesh.faces_begin(); f != Mesh.faces_end(); ++f )
+        {
+            if( candidate( metrics( *f ), priority ) )
+                Queue.push( queue_entry( priority, *f ) );
+        }
+    }
+
+    //!the next candidate, the removed faces and the entries older than the metrics are skipped
+    bool pop( face_ptr_t &f )
+    {
+        double priority;
+
+        while( !Queue.empty() )
+        {
+            queue_entry top = Queue.top();
+            Queue.pop();
+
+            if( !is_valid( top.face ) )
+                continue;
+
+            if( candidate( metrics( top.face ), priority ) && priority == top.priority )
+            {
+                f = top.face;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //!measures the faces touched by the last operations and queues the candidates
+    void requeue()
+    {
+        double priority;
+
+        for( std::size_t i = 0; i < Touched.size(); ++i )
+        {
+            if( is_valid( Touched[i] ) && candidate( metrics( Touched[i] ), priority ) )
+                Queue.push( queue_entry( priority, Touched[i] ) );
+        }
+
+        Touched.clear();
+    }
+
+    //!the faces around v without duplicates
+    void vertex_faces( const vertex_ptr_t &v, std::vector< face_ptr_t > &faces )const
+    {
+        faces.clear();
+
+        for( typename vertex_t::edge_iterator_t e = v->edges_begin(); e != v->edges_end(); ++e )
+        {
+            edge_ptr_t ep = *e;
+
+            for( typename edge_t::face_iterator_t f = ep->faces_begin(); f != ep->faces_end(); ++f )
+            {
+                face_ptr_t fp = *f;
+
+                if( std::find( faces.begin(), faces.end(), fp ) == faces.end() )
+                    faces.push_back( fp );
+            }
+        }
+    }
+
+    //!marks the metrics of the faces around v as stale and touches them
+    void moved( const vertex_ptr_t &v )
+    {
+        vertex_faces( v, Ring );
+
+        for( std::size_t i = 0; i < Ring.size(); ++i )
+        {
+            if( Ring[i]->id() < Cache.size() )
+                Cache[ Ring[i]->id() ].uid = NO_ID;
+
+            Touched.push_back( Ring[i] );
+        }
+    }
+
+    static edge_ptr_t face_edge( const face_ptr_t &f, std::size_t k )
+    {
+        return *(f->edges_begin() + k);
+    }
+
+    static vertex_ptr_t face_vertex( const face_ptr_t &f, std::size_t k )
+    {
+        typename face_t::vertex_iterator_t v = f->verts_begin();
+        std::advance( v, k );
+
+        return *v;
+    }
+
+    //!position of the edge in the face
+    static std::size_t edge_index( const face_ptr_t &f, const edge_ptr_t &e )
+    {
+        return std::distance( f->edges_begin(), std::find( f->edges_begin(), f->edges_end(), e ) );
+    }
+
+    static std::size_t longest( const face_metrics &fm )
+    {
+        return std::max_element( fm.lengths, fm.lengths + 3 ) - fm.lengths;
+    }
+
+    static std::size_t shortest( const face_metrics &fm )
+    {
+        return std::min_element( fm.lengths, fm.lengths + 3 ) - fm.lengths;
+    }
+
+    static bool adjacent( const vertex_ptr_t &a, const vertex_ptr_t &b )
+    {
+        for( typename vertex_t::edge_iterator_t e = a->edges_begin(); e != a->edges_end(); ++e )
+        {
+            edge_ptr_t ep = *e;
+
+            if( ep->verts()[0] == b || ep->verts()[1] == b )
+                return true;
+        }
+
+        return false;
+    }
+
+    //!true if all the faces of the edge are triangles
+    static bool triangles_only( const edge_ptr_t &e )
+    {
+        for( typename edge_t::face_iterator_t f = e->faces_begin(); f != e->faces_end(); ++f )
+        {
+            if( (*f)->edges_size() != 3 )
+                return false;
+        }
+
+        return true;
+    }
+
+    //!true if the vertex is on a free or a non manifold edge
+    static bool is_locked( const vertex_ptr_t &v )
+    {
+        for( typename vertex_t::edge_iterator_t e = v->edges_begin(); e != v->edges_end(); ++e )
+        {
+            if( (*e)->faces_size() != 2 )
+                return true;
+        }
+
+        return false;
+    }
+
+    //!the edges with other than two faces or with a dihedral angle above feature_angle
+    bool is_feature( const edge_ptr_t &e )
+    {
+        if( e->faces_size() != 2 )
+            return true;
+
+        typename edge_t::face_iterator_t f = e->faces_begin();
+        face_ptr_t f0 = *f;
+        face_ptr_t f1 = *(++f);
+
+        point_t n0 = metrics( f0 ).normal;
+
+        return math::dot( n0, metrics( f1 ).normal ) < FeatureCos;
+    }
+
+    //!the area weighted normal of the vertex
+    point_t vertex_normal( const vertex_ptr_t &v )
+    {
+        vertex_faces( v, Ring );
+
+        point_t n( 0.0 );
+        for( std::size_t i = 0; i < Ring.size(); ++i )
+        {
+            const face_metrics &fm = metrics( Ring[i] );
+            n += fm.normal * fm.area;
+        }
+
+        double len = math::magnitude( n );
+
+        return len > 0.0 ? n / len : n;
+    }
+
+    //!the terminal edge of the longest edge propagation path of the face (see Rivara's LEPP bisection)
+    edge_ptr_t terminal_edge( face_ptr_t f )
+    {
+        edge_ptr_t e = face_edge( f, longest( metrics( f ) ) );
+
+        //the path ends at the boundary, the features are only split without smoothing
+        for( std::size_t step = 0; step < 64 && e->faces_size() == 2; ++step )
+        {
+            typename edge_t::face_iterator_t fi = e->faces_begin();
+            face_ptr_t nf = *fi;
+            if( nf == f )
+                nf = *(++fi);
+
+            if( !metrics( nf ).triangle )
+                break;
+
+            edge_ptr_t ne = face_edge( nf, longest( metrics( nf ) ) );
+
+            if( ne == e )
+                break;
+
+            f = nf;
+            e = ne;
+        }
+
+        return e;
+    }
+
+    /*!
+    \brief Flips the edge between two triangles when the opposite angles violate the Delaunay property
+    \param e the edge
+    \param cap a cap flip only checks that the faces are coplanar
+    \return true if the edge was flipped
+    */
+    bool flip_edge( const edge_ptr_t &e, bool cap )
+    {
+        if( !is_valid( e ) || e->faces_size() != 2 )
+            return false;
+
+        typename edge_t::face_iterator_t fi = e->faces_begin();
+        face_ptr_t f0 = *fi;
+        face_ptr_t f1 = *(++fi);
+
+        const face_metrics m0 = metrics( f0 );
+        const face_metrics m1 = metrics( f1 );
+
+        if( !m0.triangle || !m1.triangle )
+            return false;
+
+        const std::size_t k0 = edge_index( f0, e ), k1 = edge_index( f1, e );
+
+        vertex_ptr_t a = face_vertex( f0, (k0 + 2) % 3 );
+        vertex_ptr_t b = face_vertex( f1, (k1 + 2) % 3 );
+
+        //the new edge must not exist already
+        if( a == b || adjacent( a, b ) )
+            return false;
+
+        typename MeshType::point_t quad[4] = { a->point(), e->verts()[0]->point(), b->point(), e->verts()[1]->point() };
+
+        //the degenerate faces are always flipped
+        if( m0.min_angle() > 0.1 && m1.min_angle() > 0.1 )
+        {
+            double ndot = math::dot( m0.normal, m1.normal );
+
+            if( cap && ndot < FeatureCos )
+                return false;
+
+            if( !cap )
+            {
+                point_t c( quad[2] );
+                double volume = math::dot( point_t( quad[3] ) - c, 
+                    math::cross( point_t( quad[0] ) - c, point_t( quad[1] ) - c ) ) / 6.0;
+
+                if( ndot < FlipFeatureCos || std::abs( volume ) > Options.min_volume )
+                    return false;
+            }
+        }
+
+        if( !is_convex( std::vector< typename MeshType::point_t >( quad, quad + 4 ) ) )
+            return false;
+
+        //the opposite vertex is inside the circumcircle
+        if( m0.angles[(k0 + 2) % 3] + m1.angles[(k1 + 2) % 3] <= 180.000001 )
+            return false;
+
+        face_ptr_t q = Mesh.join_face( f0, f1 );
+
+        if( q == f0 )
+            return false;
+
+        edge_ptr_t ne = Mesh.split_face( q, a, b );
+        ++Stats.flips;
+
+        for( typename edge_t::face_iterator_t f = ne->faces_begin(); f != ne->faces_end(); ++f )
+            Touched.push_back( *f );
+
+        return true;
+    }
+
+    //!flips the edges of the stack and pushes the edges around every flipped one
+    void flip_edges( std::vector< edge_ptr_t > &stack )
+    {
+        std::vector< edge_ptr_t > outer;
+
+        //the recursion limit of the script
+        for( std::size_t flips = 0; !stack.empty() && flips < 1000; )
+        {
+            edge_ptr_t e = stack.back();
+            stack.pop_back();
+
+            if( !is_valid( e ) || e->faces_size() != 2 )
+                continue;
+
+            outer.clear();
+            for( typename edge_t::face_iterator_t f = e->faces_begin(); f != e->faces_end(); ++f )
+            {
+                face_ptr_t fp = *f;
+
+                for( typename face_t::edge_iterator_t fe = fp->edges_begin(); fe != fp->edges_end(); ++fe )
+                {
+                    if( *fe != e )
+                        outer.push_back( *fe );
+                }
+            }
+
+            if( flip_edge( e, false ) )
+            {
+                stack.insert( stack.end(), outer.begin(), outer.end() );
+                ++flips;
+            }
+        }
+    }
+
+    /*!
+    \brief Splits an edge of triangles
+    \param e the edge
+    \param t the parametric value of the cut
+    \param smooth place the new vertex on the Hermite curve of the edge unless it is a feature and restore the Delaunay property around it
+    */
+    vertex_ptr_t split_edge( const edge_ptr_t &e, double t, bool smooth )
+    {
+        std::vector< edge_ptr_t > outer;
+
+        for( typename edge_t::face_iterator_t f = e->faces_begin(); f != e->faces_end(); ++f )
+        {
+            face_ptr_t fp = *f;
+
+            for( typename face_t::edge_iterator_t fe = fp->edges_begin(); fe != fp->edges_end(); ++fe )
+            {
+                if( *fe != e )
+                    outer.push_back( *fe );
+            }
+        }
+
+        const bool curved = smooth && !is_feature( e );
+        point_t p;
+
+        if( curved )
+        {
+            vertex_ptr_t v0 = e->verts()[0], v1 = e->verts()[1];
+            p = hermite_point( point_t( v0->point() ), vertex_normal( v0 ), point_t( v1->point() ), vertex_normal( v1 ), t );
+        }
+
+        vertex_ptr_t v = Mesh.split_edge( e, real_t( t ), true );
+        ++Stats.splits;
+
+        if( curved )
+            Mesh.set_point( v, typename MeshType::point_t( p ) );
+
+        moved( v );
+
+        if( smooth )
+            flip_edges( outer );
+
+        return v;
+    }
+
+    //!true if moving v to p turns over one of its faces
+    bool folds( const vertex_ptr_t &v, const vertex_ptr_t &o, const point_t &p )
+    {
+        vertex_faces( v, Ring );
+
+        for( std::size_t i = 0; i < Ring.size(); ++i )
+        {
+            const face_metrics &fm = metrics( Ring[i] );
+
+            //the plane through the opposite edge perpendicular to the face
+            for( typename face_t::edge_iterator_t fe = Ring[i]->edges_begin(); fe != Ring[i]->edges_end(); ++fe )
+            {
+                vertex_ptr_t a = (*fe)->verts()[0], b = (*fe)->verts()[1];
+
+                if( a == v || b == v || a == o || b == o )
+                    continue;
+
+                point_t pa( a->point() );
+                point_t pn = math::cross( fm.normal, point_t( b->point() ) - pa );
+
+                double s = math::dot( point_t( v->point() ) - pa, pn );
+                double sn = math::dot( p - pa, pn );
+
+                if( s * sn <= 0.0 )
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    //!the point with the smallest quadric error of the collapse of the edge
+    point_t optimal( const vertex_ptr_t &v0, const vertex_ptr_t &v1, double length )
+    {
+        point_t p0( v0->point() ), p1( v1->point() );
+
+        if( length < Options.node_equiv )
+            return (p0 + p1) * 0.5;
+
+        quadric_t q = Quadrics[ v0->unique_id() ] + Quadrics[ v1->unique_id() ];
+        point_t p;
+
+        if( q.optimize( p ) )
+            return p;
+
+        //singular quadric, pick the best of the end points and the middle
+        point_t cands[3] = { p0, p1, (p0 + p1) * 0.5 };
+        p = cands[0];
+
+        for( std::size_t i = 1; i < 3; ++i )
+        {
+            if( q.evaluate( cands[i] ) < q.evaluate( p ) )
+                p = cands[i];
+        }
+
+        return p;
+    }
+
+    //!collapses an edge of triangles unless both its vertices are locked, it breaks the link condition or folds a face
+    bool collapse_edge( const edge_ptr_t &e, double length )
+    {
+        vertex_ptr_t v0 = e->verts()[0], v1 = e->verts()[1];
+        const bool l0 = is_locked( v0 ), l1 = is_locked( v1 );
+
+        if( (l0 && l1) || !triangles_only( e ) )
+            return false;
+
+        //the link condition, the only common neighbours are the opposite vertices of the edge
+        std::size_t common = 0;
+        for( typename vertex_t::vertex_iterator_t a = v0->verts_begin(); a != v0->verts_end(); ++a )
+        {
+            if( *a != v1 && adjacent( *a, v1 ) )
+                ++common;
+        }
+
+        if( common != e->faces_size() )
+            return false;
+
+        point_t p = l0 ? point_t( v0->point() ) : l1 ? point_t( v1->point() ) : optimal( v0, v1, length );
+
+        if( folds( v0, v1, p ) || folds( v1, v0, p ) )
+            return false;
+
+        vertex_ptr_t keep = l1 ? v1 : v0, gone = l1 ? v0 : v1;
+
+        Mesh.set_point( v0, typename MeshType::point_t( p ) );
+        Mesh.set_point( v1, typename MeshType::point_t( p ) );
+        Mesh.join_edge( e, keep );
+        ++Stats.collapses;
+
+        Quadrics[ keep->unique_id() ] += Quadrics[ gone->unique_id() ];
+        Quadrics.erase( gone->unique_id() );
+
+        moved( keep );
+
+        return true;
+    }
+
+    MeshType &Mesh;
+    improve_options Options;
+    improve_stats Stats;
+
+    double FeatureCos, FlipFeatureCos;
+
+    //!the face metrics by face id
+    std::vector< face_metrics > Cache;
+
+    pass_t Pass;
+    std::size_t Budget;
+    std::priority_queue< queue_entry > Queue;
+
+    //!the faces created or moved by the last operations
+    std::vector< face_ptr_t > Touched;
+
+    //!the vertex quadrics of the needle pass by vertex unique id
+    boost::unordered_map< uid_t, quadric_t > Quadrics;
+
+    //!scratch ring
+    std::vector< face_ptr_t > Ring;
+};
+
+/*!
+\brief Improves the triangles of a mesh with refine, cap and needle passes
+\param m the mesh
+\param options the angles and thresholds of the passes
+\return the number of flips, splits and collapses
+\note only the triangles are improved
+*/
+template<typename MeshType>
+improve_stats improve( MeshType &m, const improve_options &options = improve_options() )
+{
+    mesh_improver<MeshType> improver( m, options );
+
+    for( int i = 0; i < options.iterations; ++i )
+    {
+        improver.refine();
+        improver.remove_caps();
+        improver.remove_needles();
+    }
+
+    return improver.stats();
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef GEOMETRY_INDEXED_H
+#define GEOMETRY_INDEXED_H
+
+#include "Traits.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Flat indexed copy of a mesh
+
+Whole mesh passes read the connectivity from contiguous arrays indexed by the entity ids
+instead of following the shared and weak pointers of the mesh, which also keeps the reference
+counts of the entities untouched when the pass runs in parallel.
+*/
+template<typename Real>
+struct indexed_mesh
+{
+    typedef Real real_t;
+    typedef math::vec3<Real> point_t;
+
+    //!vertex coordinates by vertex id
+    std::vector< point_t > points;
+
+    //!offsets of the faces in face_verts, faces_size() + 1 entries
+    std::vector< uid_t > face_start;
+
+    //!vertex ids of the faces in face order
+    std::vector< uid_t > face_verts;
+
+    //!id of the edge from face_verts[k] to the next vertex of the face
+    std::vector< uid_t > face_edges;
+
+    //!two vertex ids per edge (v0,v1)
+    std::vector< uid_t > edge_verts;
+
+    std::size_t verts_size()const { return points.size(); }
+    std::size_t edges_size()const { return edge_verts.size() / 2; }
+    std::size_t faces_size()const { return face_start.empty() ? 0 : face_start.size() - 1; }
+
+    //!number of vertices of face f
+    std::size_t face_size( std::size_t f )const { return face_start[f+1] - face_start[f]; }
+
+    void swap( indexed_mesh &other )
+    {
+        points.swap( other.points );
+        face_start.swap( other.face_start );
+        face_verts.swap( other.face_verts );
+        face_edges.swap( other.face_edges );
+        edge_verts.swap( other.edge_verts );
+    }
+};
+
+/*!
+\brief Compressed rows of ids
+
+The items of row r are items[start[r]] up to items[start[r+1]], the adjacency of the indexed 
+meshes (the faces around an edge, the edges around a vertex) is stored in this form.
+*/
+struct index_rows
+{
+    std::vector< uid_t > start;
+    std::vector< uid_t > items;
+
+    std::size_t size()const { return start.empty() ? 0 : start.size() - 1; }
+    std::size_t row_size( std::size_t r )const { return start[r+1] - start[r]; }
+
+    const uid_t *row_begin( std::size_t r )const { return items.empty() ? 0 : &items[0] + start[r]; }
+    const uid_t *row_end( std::size_t r )const { return items.empty() ? 0 : &items[0] + start[r+1]; }
+};
+
+/*!
+\brief Groups the positions of an array by the value stored at them
+\param keys the row of every position, NO_ID positions are left out
+\param rows the number of rows
+\param r the rows, each row lists its positions in increasing order
+\param threads number of threads, 0 for the default
+
+Applied to face_edges it gives the corners around every edge, to face_verts the corners 
+around every vertex and to edge_verts the edge ends around every vertex. The rows are sorted 
+so the result does not depend on the number of threads.
+*/
+inline void group_by_key( const std::vector< uid_t > &keys, std::size_t rows, index_rows &r, int threads = 0 )
+{
+    const std::ptrdiff_t n = std::ptrdiff_t( keys.size() );
+
+    r.start.assign( rows + 1, 0 );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t i = 0; i < n; ++i )
+        if( keys[i] != NO_ID )
+            atomic_add( &r.start[ keys[i] + 1 ], uid_t( 1 ) );
+
+    for( std::size_t k = 0; k < rows; ++k )
+        r.start[k+1] += r.start[k];
+
+    std::vector< uid_t > next( r.start.begin(), r.start.end() - 1 );
+    r.items.resize( r.start.back() );
+
+    #pragma omp parallel num_threads( parallel_threads( threads ) )
+    {
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t i = 0; i < n; ++i )
+            if( keys[i] != NO_ID )
+                r.items[ atomic_add( &next[ keys[i] ], uid_t( 1 ) ) ] = uid_t( i );
+
+        #pragma omp for schedule(dynamic,1024)
+        for( std::ptrdiff_t k = 0; k < std::ptrdiff_t( rows ); ++k )
+            std::sort( r.items.begin() + r.start[k], r.items.begin() + r.start[k+1] );
+    }
+}
+
+/*!
+\brief Builds the indexed copy of a mesh
+\param m the mesh
+\param im the indexed mesh
+\param threads the number of threads, 0 for the default
+*/
+template<typename MeshType>
+void make_indexed( const MeshType &m, indexed_mesh< typename MeshType::real_t > &im, int threads = 0 )
+{
+    typedef typename MeshType::face_t face_t;
+
+    //the entity arrays of the mesh are random access so the copy runs in parallel by position
+    typename MeshType::vertex_iterator_t vb = m.verts_begin();
+    typename MeshType::edge_iterator_t eb = m.edges_begin();
+    typename MeshType::face_iterator_t fb = m.faces_begin();
+
+    const std::ptrdiff_t nv = std::ptrdiff_t( m.verts_size() );
+    const std::ptrdiff_t ne = std::ptrdiff_t( m.edges_size() );
+    const std::ptrdiff_t nf = std::ptrdiff_t( m.faces_size() );
+
+    im.points.resize( nv );
+    im.edge_verts.resize( 2 * ne );
+    im.face_start.resize( nf + 1 );
+    im.face_start[0] = 0;
+
+    #pragma omp parallel num_threads( parallel_threads( threads ) )
+    {
+        #pragma omp for schedule(static) nowait
+        for( std::ptrdiff_t i = 0; i < nv; ++i )
+            im.points[ vb[i]->id() ] = vb[i]->point();
+
+        #pragma omp for schedule(static) nowait
+        for( std::ptrdiff_t i = 0; i < ne; ++i )
+        {
+            const typename MeshType::edge_t &e = *eb[i];
+
+            im.edge_verts[ 2 * e.id() ]     = e.verts()[0]->id();
+            im.edge_verts[ 2 * e.id() + 1 ] = e.verts()[1]->id();
+        }
+
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t i = 0; i < nf; ++i )
+            im.face_start[ fb[i]->id() + 1 ] = fb[i]->edges_size();
+    }
+
+    for( std::size_t f = 0; f < m.faces_size(); ++f )
+        im.face_start[f+1] += im.face_start[f];
+
+    im.face_verts.resize( im.face_start.back() );
+    im.face_edges.resize( im.face_start.back() );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t i = 0; i < nf; ++i )
+    {
+        const face_t &f = *fb[i];
+        uid_t k = im.face_start[ f.id() ];
+
+        //the vertex iterators carry a copy of the orientation bits so only one is made per face
+        typename face_t::edge_iterator_t e = f.edges_begin();
+        typename face_t::vertex_iterator_t v = f.verts_begin();
+        for( ; e != f.edges_end(); ++v, ++e, ++k )
+        {
+            im.face_verts[k] = (*v)->id();
+            im.face_edges[k] = (*e)->id();
+        }
+    }
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,314 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_INTERSECT_H
+#define GEOMETRY_INTERSECT_H
+
+#include "Algorithms.h"
+#include "Bvh.h"
+#include "Parallel.h"
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Two faces, the smaller id first
+typedef std::pair< uid_t, uid_t > face_pair;
+
+/*!
+\brief True if two triangles of different faces cross each other
+
+The triangles that share vertices touch there by construction, so only the contact away from 
+the shared vertices is looked for. Sharing an edge they meet when the third vertices fold onto 
+the same side of the edge in a common plane, sharing one vertex when the opposite edge of one 
+meets the other. Triangles without shared vertices are given to triangles_intersect, touching 
+counts as intersecting.
+*/
+template<typename Real>
+bool triangles_cross( const std::vector< math::vec3< Real > > &points, const bvh_triangle &t1, const bvh_triangle &t2 )
+{
+    int shared = 0;
+    int i1[3] = { 0, 1, 2 }, i2[3] = { 0, 1, 2 };
+
+    //move the shared vertices to the front of both triangles
+    for( int i = 0; i < 3; ++i )
+    {
+        for( int j = shared; j < 3; ++j )
+        {
+            if( t1.v[ i1[i] ] == t2.v[ i2[j] ] )
+            {
+                std::swap( i1[i], i1[shared] );
+                std::swap( i2[j], i2[shared] );
+                ++shared;
+                break;
+            }
+        }
+    }
+
+    const math::vec3< Real > &a0 = points[ t1.v[ i1[0] ] ], &a1 = points[ t1.v[ i1[1] ] ], &a2 = points[ t1.v[ i1[2] ] ];
+    const math::vec3< Real > &b0 = points[ t2.v[ i2[0] ] ], &b1 = points[ t2.v[ i2[1] ] ], &b2 = points[ t2.v[ i2[2] ] ];
+
+    switch( shared )
+    {
+    case 0:
+        return triangles_intersect( a0, a1, a2, b0, b1, b2 );
+
+    case 1:
+    {
+        //the far edge of a triangle on one side of the other plane leaves only the shared vertex in it
+        if( sign_of( orient3( b0, b1, b2, a1 ) ) * sign_of( orient3( b0, b1, b2, a2 ) ) > 0 ||
+            sign_of( orient3( a0, a1, a2, b1 ) ) * sign_of( orient3( a0, a1, a2, b2 ) ) > 0 )
+            return false;
+
+        return segment_triangle_intersect( a1, a2, b0, b1, b2 ) || segment_triangle_intersect( b1, b2, a0, a1, a2 );
+    }
+
+    case 2:
+    {
+        if( sign_of( orient3( a0, a1, a2, b2 ) ) != 0 )
+            return false;
+
+        const plane_projection proj( a0, a1, a2 );
+
+        if( proj.Degenerate )
+            return false;
+
+        const math::vec2<double> s = proj( a0 ), t = proj( a1 );
+
+        return sign_of( orient2( s, t, proj( a2 ) ) ) == sign_of( orient2( s, t, proj( b2 ) ) );
+    }
+
+    default:
+        //two faces over the same three vertices
+        return true;
+    }
+}
+
+/*!
+\brief Finds the pairs of faces of a hierarchy that intersect each other
+\param bvh the hierarchy of the faces
+\param pairs the pairs of faces, the smaller id first, sorted and once each
+\param threads number of threads, 0 for the default
+\return the number of pairs
+
+The hierarchy is traversed against itself. The node pairs of the top levels are expanded 
+first into a list of tasks that are traversed in parallel, every task with its own stack. The 
+leaf pairs with overlapping triangle boxes are tested with triangles_cross, the triangles of 
+the same polygon are never compared. The pairs do not depend on the number of threads.
+*/
+template<typename Real>
+std::size_t find_self_intersections( const face_bvh< Real > &bvh, std::vector< face_pair > &pairs, int threads = 0 )
+{
+    typedef std::pair< boost::uint32_t, boost::uint32_t > node_pair;
+
+    const std::vector< bvh_node > &nodes = bvh.nodes();
+    const std::vector< bvh_triangle > &tris = bvh.triangles();
+
+    pairs.clear();
+
+    if( nodes.empty() )
+        return 0;
+
+    threads = parallel_threads( threads );
+
+    struct traversal
+    {
+        static bool overlap( const bvh_node &a, const bvh_node &b )
+        {
+            return a.lo[0] <= b.hi[0] && b.lo[0] <= a.hi[0] && 
+                   a.lo[1] <= b.hi[1] && b.lo[1] <= a.hi[1] && 
+                   a.lo[2] <= b.hi[2] && b.lo[2] <= a.hi[2];
+        }
+
+        static float size( const bvh_node &n )
+        {
+            return (n.hi[0] - n.lo[0]) + (n.hi[1] - n.lo[1]) + (n.hi[2] - n.lo[2]);
+        }
+
+        //the children pairs of a node pair, false for a pair of leaves or a leaf with itself
+        static bool expand( const std::vector< bvh_node > &nodes, const node_pair &p, std::vector< node_pair > &out )
+        {
+            const bvh_node &a = nodes[ p.first ], &b = nodes[ p.second ];
+
+            if( p.first == p.second )
+            {
+                if( a.leaf() )
+                    return false;
+
+                const boost::uint32_t l = p.first + 1, r = a.offset;
+                out.push_back( node_pair( l, l ) );
+                out.push_back( node_pair( r, r ) );
+
+                if( overlap( nodes[l], nodes[r] ) )
+                    out.push_back( node_pair( l, r ) );
+
+                return true;
+            }
+
+            if( a.leaf() && b.leaf() )
+                return false;
+
+            //descend the larger box
+            if( b.leaf() || (!a.leaf() && size( a ) >= size( b )) )
+            {
+                const boost::uint32_t l = p.first + 1, r = a.offset;
+
+                if( overlap( nodes[l], b ) )
+                    out.push_back( node_pair( l, p.second ) );
+                if( overlap( nodes[r], b ) )
+                    out.push_back( node_pair( r, p.second ) );
+            }
+            else
+            {
+                const boost::uint32_t l = p.second + 1, r = b.offset;
+
+                if( overlap( a, nodes[l] ) )
+                    out.push_back( node_pair( p.first, l ) );
+                if( overlap( a, nodes[r] ) )
+                    out.push_back( node_pair( p.first, r ) );
+            }
+
+            return true;
+        }
+    };
+
+    //breadth first expansion of the top levels, the leaf pairs are kept as tasks
+    std::vector< node_pair > tasks, next;
+    tasks.push_back( node_pair( 0, 0 ) );
+
+    const std::size_t wanted = 64 * std::size_t( threads );
+
+    while( tasks.size() < wanted )
+    {
+        next.clear();
+        bool expanded = false;
+
+        for( std::size_t i = 0; i < tasks.size(); ++i )
+        {
+            if( traversal::expand( nodes, tasks[i], next ) )
+                expanded = true;
+            else
+                next.push_back( tasks[i] );
+        }
+
+        tasks.swap( next );
+
+        if( !expanded )
+            break;
+    }
+
+    const std::ptrdiff_t ntris = std::ptrdiff_t( tris.size() );
+    std::vector< bvh_box > boxes( ntris );
+
+    #pragma omp parallel for num_threads( threads ) schedule(static)
+    for( std::ptrdiff_t i = 0; i < ntris; ++i )
+        boxes[i] = bvh.triangle_box( tris[i] );
+
+    std::vector< std::vector< face_pair > > found( threads );
+    const std::ptrdiff_t nt = std::ptrdiff_t( tasks.size() );
+
+    #pragma omp parallel num_threads( threads )
+    {
+        std::vector< face_pair > &out = found[ parallel_thread_id() ];
+        std::vector< node_pair > stack, children;
+
+        #pragma omp for schedule(dynamic,1)
+        for( std::ptrdiff_t t = 0; t < nt; ++t )
+        {
+            stack.clear();
+            stack.push_back( tasks[t] );
+
+            while( !stack.empty() )
+            {
+                const node_pair p = stack.back();
+                stack.pop_back();
+
+                children.clear();
+                if( traversal::expand( nodes, p, children ) )
+                {
+                    stack.insert( stack.end(), children.begin(), children.end() );
+                    continue;
+                }
+
+                const bvh_node &a = nodes[ p.first ], &b = nodes[ p.second ];
+
+                for( boost::uint32_t i = a.offset; i < a.offset + a.count; ++i )
+                {
+                    const bvh_box &bi = boxes[i];
+
+                    //a leaf against itself compares every pair once
+                    for( boost::uint32_t j = (p.first == p.second ? i + 1 : b.offset); j < b.offset + b.count; ++j )
+                    {
+                        if( tris[i].face == tris[j].face || !bi.overlaps( boxes[j] ) )
+                            continue;
+
+                        if( triangles_cross( bvh.points(), tris[i], tris[j] ) )
+                            out.push_back( face_pair( std::min( tris[i].face, tris[j].face ), std::max( tris[i].face, tris[j].face ) ) );
+                    }
+                }
+            }
+        }
+    }
+
+    for( int t = 0; t < threads; ++t )
+        pairs.insert( pairs.end(), found[t].begin(), found[t].end() );
+
+    std::sort( pairs.begin(), pairs.end() );
+    pairs.erase( std::unique( pairs.begin(), pairs.end() ), pairs.end() );
+
+    return pairs.size();
+}
+
+/*!
+\brief Finds the pairs of faces of a mesh that intersect each other
+\param m the mesh
+\param pairs the pairs of faces, the smaller id first, sorted and once each
+\param threads number of threads, 0 for the default
+\return the number of pairs
+
+Builds a face_bvh of the mesh and traverses it against itself. The faces sharing an edge or a 
+vertex only count when they cross away from what they share, as explained in triangles_cross.
+*/
+template<typename MeshType>
+std::size_t find_self_intersections( const MeshType &m, std::vector< face_pair > &pairs, int threads = 0 )
+{
+    const face_bvh< typename MeshType::real_t > bvh( m, threads );
+
+    return find_self_intersections( bvh, pairs, threads );
+}
+
+}
+
+}
+
+#endif
@@ -168,7 +168,8 @@ template<typename Value, typename FaceIter, typename EdgeIter>
 class face_face_iterator : public boost::iterator_facade<
     face_face_iterator<Value,FaceIter,EdgeIter>, 
     Value, 
-    boost::forward_traversal_tag>
+    boost::forward_traversal_tag,
+    Value>
 {
 public:
     face_face_iterator() {}
@@ -247,7 +248,8 @@ private:
         return m_EdgeIter == other.m_EdgeIter;
     }
 
-    Value &dereference() const
+    //the faces are stored as weak pointers so they are returned by value
+    Value dereference() const
     {
         return *m_FaceIter;
     }
@@ -308,7 +310,8 @@ template<typename Value, typename EdgeIter, typename FaceIter>
 class vertex_face_iterator : public boost::iterator_facade<
     vertex_face_iterator<Value,EdgeIter,FaceIter>, 
     Value,
-    boost::forward_traversal_tag>
+    boost::forward_traversal_tag,
+    Value>
 {
 public:
     vertex_face_iterator() {}
@@ -376,7 +379,8 @@ private:
         return m_EdgeIter == other.m_EdgeIter;
     }
 
-    Value &dereference() const
+    //the faces are stored as weak pointers so they are returned by value
+    Value dereference() const
     {
         return (*m_FaceIter);
     }
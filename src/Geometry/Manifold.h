@@ -0,0 +1,515 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+
+#ifndef GEOMETRY_MANIFOLD_H
+#define GEOMETRY_MANIFOLD_H
+
+#include "Indexed.h"
+#include "UnionFind.h"
+#include "Parallel.h"
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Manifold state of the edges and the vertices of a mesh
+
+The bits are indexed by the entity ids. An edge is a boundary edge with at most one face (as 
+is_free), manifold with two faces and a tjoin edge with three or more (as is_tjoin). A vertex 
+is non manifold when it is on a tjoin edge or its faces form more than one fan connected 
+through the edges around it (a pinched vertex), it is isolated when it has no faces.
+*/
+struct manifold_report
+{
+    typedef boost::dynamic_bitset< unsigned char > bitset_t;
+
+    manifold_report() : boundary_count(0), manifold_count(0), tjoin_count(0), nonmanifold_count(0), isolated_count(0) {}
+
+    bitset_t boundary_edges;
+    bitset_t manifold_edges;
+    bitset_t tjoin_edges;
+    bitset_t nonmanifold_verts;
+    bitset_t isolated_verts;
+
+    //!number of set bits of every bitset
+    std::size_t boundary_count;
+    std::size_t manifold_count;
+    std::size_t tjoin_count;
+    std::size_t nonmanifold_count;
+    std::size_t isolated_count;
+
+    //!true if the mesh has no tjoin edges and no non manifold vertices
+    bool is_manifold()const { return tjoin_count == 0 && nonmanifold_count == 0; }
+};
+
+/*!
+\brief Classifies the edges and the vertices of a mesh
+\param m the mesh
+\param threads number of threads, 0 for the default
+\return the bitsets and their counts
+
+The face counts are read in a parallel pass over the edge array of the mesh. The bits are then 
+packed eight at a time so every byte of the bitsets is written by a single thread. The fans of 
+a vertex are counted with a small union-find over its corners, two corners are joined when 
+they share a manifold edge.
+*/
+template<typename MeshType>
+manifold_report classify_manifold( const MeshType &m, int threads = 0 )
+{
+    typedef typename MeshType::real_t real_t;
+    typedef manifold_report::bitset_t bitset_t;
+
+    manifold_report r;
+
+    const std::ptrdiff_t ne = std::ptrdiff_t( m.edges_size() );
+    typename MeshType::edge_iterator_t eb = m.edges_begin();
+
+    std::vector< uid_t > edge_faces( ne );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t i = 0; i < ne; ++i )
+        edge_faces[ eb[i]->id() ] = uid_t( eb[i]->faces_size() );
+
+    const std::ptrdiff_t edge_bytes = (ne + 7) / 8;
+    std::vector< unsigned char > boundary( edge_bytes ), manifold( edge_bytes ), tjoin( edge_bytes );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t b = 0; b < edge_bytes; ++b )
+    {
+        unsigned char bb = 0, mb = 0, tb = 0;
+
+        for( std::ptrdiff_t j = 0; j < 8 && 8 * b + j < ne; ++j )
+        {
+            const uid_t faces = edge_faces[ 8 * b + j ];
+
+            if( faces <= 1 )
+                bb |= (unsigned char)( 1u << j );
+            else if( faces == 2 )
+                mb |= (unsigned char)( 1u << j );
+            else
+                tb |= (unsigned char)( 1u << j );
+        }
+
+        boundary[b] = bb;
+        manifold[b] = mb;
+        tjoin[b] = tb;
+    }
+
+    indexed_mesh< real_t > im;
+    make_indexed( m, im, threads );
+
+    const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+
+    //the edge that enters every corner, the edge that leaves it is face_edges[k]
+    std::vector< uid_t > corner_in( im.face_verts.size() );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+            corner_in[k] = im.face_edges[ k == im.face_start[f] ? im.face_start[f+1] - 1 : k - 1 ];
+
+    index_rows vertex_corners;
+    group_by_key( im.face_verts, nv, vertex_corners, threads );
+
+    const std::ptrdiff_t vert_bytes = (nv + 7) / 8;
+    std::vector< unsigned char > nonmanifold( vert_bytes ), isolated( vert_bytes );
+
+    #pragma omp parallel num_threads( parallel_threads( threads ) )
+    {
+        //(edge, corner) pairs and the union-find of the corners of a vertex
+        std::vector< std::pair< uid_t, uid_t > > ends;
+        std::vector< uid_t > parent;
+
+        #pragma omp for schedule(dynamic,256)
+        for( std::ptrdiff_t b = 0; b < vert_bytes; ++b )
+        {
+            unsigned char nb = 0, ib = 0;
+
+            for( std::ptrdiff_t j = 0; j < 8 && 8 * b + j < nv; ++j )
+            {
+                const std::size_t v = std::size_t( 8 * b + j );
+                const std::size_t d = vertex_corners.row_size( v );
+                const uid_t *c = vertex_corners.row_begin( v );
+
+                if( d == 0 )
+                {
+                    ib |= (unsigned char)( 1u << j );
+                    continue;
+                }
+
+                ends.clear();
+                bool tjoins = false;
+
+                for( std::size_t i = 0; i < d && !tjoins; ++i )
+                {
+                    const uid_t out = im.face_edges[ c[i] ], in = corner_in[ c[i] ];
+
+                    tjoins = edge_faces[out] > 2 || edge_faces[in] > 2;
+
+                    ends.push_back( std::make_pair( out, uid_t( i ) ) );
+                    ends.push_back( std::make_pair( in, uid_t( i ) ) );
+                }
+
+                if( tjoins )
+                {
+                    nb |= (unsigned char)( 1u << j );
+                    continue;
+                }
+
+                std::sort( ends.begin(), ends.end() );
+
+                parent.resize( d );
+                for( std::size_t i = 0; i < d; ++i )
+                    parent[i] = uid_t( i );
+
+                std::size_t fans = d;
+
+                for( std::size_t i = 1; i < ends.size(); ++i )
+                {
+                    if( ends[i].first != ends[i-1].first || edge_faces[ ends[i].first ] != 2 )
+                        continue;
+
+                    uid_t x = ends[i].second, y = ends[i-1].second;
+
+                    while( parent[x] != x ) x = parent[x];
+                    while( parent[y] != y ) y = parent[y];
+
+                    if( x != y )
+                    {
+                        parent[ std::max( x, y ) ] = std::min( x, y );
+                        --fans;
+                    }
+                }
+
+                if( fans > 1 )
+                    nb |= (unsigned char)( 1u << j );
+            }
+
+            nonmanifold[b] = nb;
+            isolated[b] = ib;
+        }
+    }
+
+    r.boundary_edges = bitset_t( boundary.begin(), boundary.end() );
+    r.manifold_edges = bitset_t( manifold.begin(), manifold.end() );
+    r.tjoin_edges = bitset_t( tjoin.begin(), tjoin.end() );
+    r.nonmanifold_verts = bitset_t( nonmanifold.begin(), nonmanifold.end() );
+    r.isolated_verts = bitset_t( isolated.begin(), isolated.end() );
+
+    r.boundary_edges.resize( ne );
+    r.manifold_edges.resize( ne );
+    r.tjoin_edges.resize( ne );
+    r.nonmanifold_verts.resize( nv );
+    r.isolated_verts.resize( nv );
+
+    r.boundary_count = r.boundary_edges.count();
+    r.manifold_count = r.manifold_edges.count();
+    r.tjoin_count = r.tjoin_edges.count();
+    r.nonmanifold_count = r.nonmanifold_verts.count();
+    r.isolated_count = r.isolated_verts.count();
+
+    return r;
+}
+
+/*!
+\brief Splits the tjoin edges and the pinched vertices of a mesh
+\param m the mesh
+\param original the original vertex id of every vertex of the repaired mesh
+\param threads number of threads, 0 for the default
+\return the number of vertices added
+
+The corners of the faces are joined in a lock-free union_find across the edges that stay 
+shared: every edge with two faces, and at a tjoin edge the pairs of faces that bound the same 
+solid. The faces of a tjoin edge are sorted by their angle around it and a face is paired with 
+its next one when the wedge between them is on the back side of both, the faces left without 
+a pair become boundary. Every set of corners is a fan and gets its own vertex, the fan with 
+the first corner of a vertex keeps it and the others get copies appended after the original 
+vertices, so a pinched vertex is split into one vertex per fan. If a detached face still ends 
+up on an edge of three faces it is given its own copy of the vertex and the mesh goes through 
+a second pass, this needs faces connected to the pair around both ends of the edge.
+
+The original vertices keep their ids and original maps every vertex back to the vertex it was 
+copied from. Only the faces that move to a copy are replaced, they are removed and added again 
+at the end of the face array. When the mesh is already manifold it is not touched.
+*/
+template<typename MeshType>
+std::size_t make_manifold( MeshType &m, std::vector< uid_t > &original, int threads = 0 )
+{
+    typedef typename MeshType::real_t real_t;
+    typedef typename MeshType::vertex_t vertex_t;
+    typedef typename MeshType::face_t face_t;
+    typedef typename MeshType::vertex_ptr_t vertex_ptr_t;
+    typedef typename MeshType::face_ptr_t face_ptr_t;
+    typedef math::vec3< double > dvec_t;
+
+    indexed_mesh< real_t > im;
+    make_indexed( m, im, threads );
+
+    const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+    const std::ptrdiff_t ne = std::ptrdiff_t( im.edges_size() );
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+    const std::ptrdiff_t nc = std::ptrdiff_t( im.face_verts.size() );
+
+    //the corner after every corner in its face
+    std::vector< uid_t > next( nc );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+            next[k] = k + 1 == im.face_start[f+1] ? im.face_start[f] : k + 1;
+
+    index_rows edge_corners;
+    group_by_key( im.face_edges, ne, edge_corners, threads );
+
+    std::vector< uid_t > tjoins;
+
+    for( std::ptrdiff_t e = 0; e < ne; ++e )
+        if( edge_corners.row_size( e ) > 2 )
+            tjoins.push_back( uid_t( e ) );
+
+    union_find sets( nc );
+
+    #pragma omp parallel num_threads( parallel_threads( threads ) )
+    {
+        //(angle, corner) of the faces around a tjoin edge
+        std::vector< std::pair< double, uid_t > > fan;
+
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t e = 0; e < ne; ++e )
+        {
+            if( edge_corners.row_size( e ) != 2 )
+                continue;
+
+            const uid_t a = edge_corners.row_begin( e )[0], b = edge_corners.row_begin( e )[1];
+
+            if( im.face_verts[a] == im.face_verts[b] )
+            {
+                sets.unite( a, b );
+                sets.unite( next[a], next[b] );
+            }
+            else
+            {
+                sets.unite( a, next[b] );
+                sets.unite( next[a], b );
+            }
+        }
+
+        #pragma omp for schedule(dynamic,16)
+        for( std::ptrdiff_t i = 0; i < std::ptrdiff_t( tjoins.size() ); ++i )
+        {
+            const uid_t e = tjoins[i];
+            const uid_t v0 = im.edge_verts[ 2 * e ], v1 = im.edge_verts[ 2 * e + 1 ];
+
+            const dvec_t p0( im.points[v0].x, im.points[v0].y, im.points[v0].z );
+            const dvec_t d = dvec_t( im.points[v1].x, im.points[v1].y, im.points[v1].z ) - p0;
+
+            //a frame around the edge from the axis least aligned with it, the angles grow from u towards d x u
+            dvec_t axis( 0, 0, 0 );
+
+            if( std::fabs( d.x ) <= std::fabs( d.y ) && std::fabs( d.x ) <= std::fabs( d.z ) )
+                axis.x = 1;
+            else if( std::fabs( d.y ) <= std::fabs( d.z ) )
+                axis.y = 1;
+            else
+                axis.z = 1;
+
+            const dvec_t u = math::cross( d, axis ), w = math::cross( d, u );
+
+            fan.clear();
+
+            for( const uid_t *k = edge_corners.row_begin( e ); k != edge_corners.row_end( e ); ++k )
+            {
+                const math::vec3< real_t > &q = im.points[ im.face_verts[ next[ next[*k] ] ] ];
+                const dvec_t r = dvec_t( q.x, q.y, q.z ) - p0;
+
+                fan.push_back( std::make_pair( std::atan2( math::dot( r, w ), math::dot( r, u ) ), *k ) );
+            }
+
+            std::sort( fan.begin(), fan.end() );
+
+            //a face that runs v1 to v0 has its normal towards the smaller angles, the wedge 
+            //after it is behind it and also behind the next face when that one runs v0 to v1
+            for( std::size_t j = 0; j < fan.size(); ++j )
+            {
+                const uid_t a = fan[j].second, b = fan[ (j + 1) % fan.size() ].second;
+
+                if( im.face_verts[a] == v1 && im.face_verts[b] == v0 )
+                {
+                    sets.unite( a, next[b] );
+                    sets.unite( next[a], b );
+                }
+            }
+        }
+    }
+
+    std::vector< uid_t > label;
+    const std::size_t count = sets.labels( label, threads );
+
+    //the sets are numbered in the order of their first corner
+    std::vector< uid_t > fan_vertex( count, NO_ID );
+    std::vector< char > claimed( nv, 0 );
+
+    original.resize( nv );
+    for( std::ptrdiff_t v = 0; v < nv; ++v )
+        original[v] = uid_t( v );
+
+    for( std::ptrdiff_t k = 0; k < nc; ++k )
+    {
+        if( fan_vertex[ label[k] ] != NO_ID )
+            continue;
+
+        const uid_t v = im.face_verts[k];
+
+        if( claimed[v] )
+        {
+            fan_vertex[ label[k] ] = uid_t( original.size() );
+            original.push_back( v );
+        }
+        else
+        {
+            fan_vertex[ label[k] ] = v;
+            claimed[v] = 1;
+        }
+    }
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t k = 0; k < nc; ++k )
+        im.face_verts[k] = fan_vertex[ label[k] ];
+
+    //the detached faces of a tjoin edge can still meet the pair through the fans at both ends
+    std::vector< std::pair< std::pair< uid_t, uid_t >, uid_t > > ends;
+    std::size_t detached = 0;
+
+    for( std::size_t i = 0; i < tjoins.size(); ++i )
+    {
+        const uid_t e = tjoins[i];
+
+        ends.clear();
+
+        for( const uid_t *k = edge_corners.row_begin( e ); k != edge_corners.row_end( e ); ++k )
+        {
+            const uid_t a = im.face_verts[*k], b = im.face_verts[ next[*k] ];
+            ends.push_back( std::make_pair( std::make_pair( std::min( a, b ), std::max( a, b ) ), *k ) );
+        }
+
+        std::sort( ends.begin(), ends.end() );
+
+        for( std::size_t j = 2; j < ends.size(); ++j )
+        {
+            if( ends[j].first != ends[j-2].first )
+                continue;
+
+            const uid_t k = ends[j].second;
+
+            original.push_back( original[ im.face_verts[k] ] );
+            im.face_verts[k] = uid_t( original.size() - 1 );
+            ++detached;
+        }
+    }
+
+    const std::size_t added = original.size() - std::size_t( nv );
+
+    if( added == 0 )
+        return 0;
+
+    //the vertices are copied only when a fan moves, so only the faces on a copy are replaced
+    std::vector< vertex_ptr_t > verts( original.size() );
+    typename MeshType::vertex_iterator_t vb = m.verts_begin();
+    typename MeshType::face_iterator_t fb = m.faces_begin();
+
+    for( std::ptrdiff_t i = 0; i < nv; ++i )
+        verts[ vb[i]->id() ] = vb[i];
+
+    std::vector< face_ptr_t > faces( nf );
+
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        faces[ fb[f]->id() ] = fb[f];
+
+    std::vector< uid_t > moved;
+
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+    {
+        for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+            if( im.face_verts[k] >= uid_t( nv ) )
+            {
+                moved.push_back( uid_t( f ) );
+                break;
+            }
+    }
+
+    for( std::size_t i = 0; i < moved.size(); ++i )
+        m.remove_face( faces[ moved[i] ], false );
+
+    for( std::size_t i = nv; i < verts.size(); ++i )
+    {
+        verts[i] = vertex_ptr_t( new vertex_t( im.points[ original[i] ] ) );
+        m.add_vertex( verts[i] );
+    }
+
+    std::vector< vertex_ptr_t > poly;
+
+    for( std::size_t i = 0; i < moved.size(); ++i )
+    {
+        poly.clear();
+        for( uid_t k = im.face_start[ moved[i] ]; k < im.face_start[ moved[i] + 1 ]; ++k )
+            poly.push_back( verts[ im.face_verts[k] ] );
+
+        m.add_face( face_ptr_t( new face_t( poly.begin(), poly.end() ) ) );
+    }
+
+    //a face cut out of a fan can leave the rest of the fan pinched, a second pass splits it
+    if( detached )
+    {
+        std::vector< uid_t > again;
+
+        if( make_manifold( m, again, threads ) )
+        {
+            for( std::size_t i = 0; i < again.size(); ++i )
+                again[i] = original[ again[i] ];
+
+            original.swap( again );
+        }
+    }
+
+    return original.size() - std::size_t( nv );
+}
+
+}
+
+}
+
+#endif
@@ -227,7 +227,6 @@ template<typename Traits>
 void mesh<Traits>::delete_vertex( vertex_ptr_t v )
 {
     uid_t ID = v->id();
-    v->set_id( NO_ID );
 
     //check if the ID is valid
     assert(ID < Vertices.size());
@@ -235,6 +234,9 @@ void mesh<Traits>::delete_vertex( vertex_ptr_t v )
     //reassign the vertex id
     Vertices.back()->set_id( ID );
 
+    //after the last one is moved, the removed vertex may be the last
+    v->set_id( NO_ID );
+
     //O(1) removal from vector
     std::swap( Vertices[ID], Vertices.back() );
     Vertices.pop_back();
@@ -244,7 +246,6 @@ template<typename Traits>
 void mesh<Traits>::delete_edge( edge_ptr_t e )
 {
     uid_t ID = e->id();
-    e->set_id( NO_ID );
     
     //check if the ID is valid
     assert(ID < Edges.size());
@@ -252,6 +253,9 @@ void mesh<Traits>::delete_edge( edge_ptr_t e )
     //reassign the edge id
     Edges.back()->set_id( ID );
 
+    //after the last one is moved, the removed edge may be the last
+    e->set_id( NO_ID );
+
     std::swap( Edges[ID], Edges.back() );
     Edges.pop_back();
 }
@@ -260,13 +264,15 @@ template<typename Traits>
 void mesh<Traits>::delete_face( face_ptr_t f )
 {
     uid_t ID = f->id();
-    f->set_id( NO_ID );
 
     //check if the ID is valid
     assert(ID < Faces.size());
 
     //reassign the face id
     Faces.back()->set_id( ID );
+
+    //after the last one is moved, the removed face may be the last
+    f->set_id( NO_ID );
     
     std::swap( Faces[ID], Faces.back() );
     Faces.pop_back();
@@ -589,7 +595,18 @@ mesh<Traits>::join_face( face_ptr_t f0, face_ptr_t f1 )
 template<typename Traits>
 bool mesh<Traits>::flip_face( face_ptr_t f )
 {
-    //just flip the orientation of edges
+    //walk the edges in the reverse order and each edge in the other direction
+    const std::size_t n = f->Edges.size();
+
+    std::reverse( f->Edges.begin(), f->Edges.end() );
+
+    for( std::size_t i = 0; i < n / 2; ++i )
+    {
+        const bool b = f->EdgesOrientation[i];
+        f->EdgesOrientation[i] = f->EdgesOrientation[n - 1 - i];
+        f->EdgesOrientation[n - 1 - i] = b;
+    }
+
     f->EdgesOrientation.flip();
 
     return true;
@@ -601,6 +618,38 @@ void mesh<Traits>::set_point( vertex_ptr_t v, const point_t &point )
     v->Point = point;
 }
 
+template<typename Traits>
+void mesh<Traits>::rebuild( const vertex_array_t &verts, const std::vector< std::size_t > &sizes, const std::vector< uid_t > &indices )
+{
+    //detach the old topology
+    for( std::size_t i = 0; i < Vertices.size(); ++i )
+        Vertices[i]->Edges.clear();
+
+    clear();
+
+    for( std::size_t i = 0; i < verts.size(); ++i )
+        verts[i]->Edges.clear();
+
+    Vertices = verts;
+    for( std::size_t i = 0; i < Vertices.size(); ++i )
+        Vertices[i]->set_id( i );
+
+    Faces.reserve( sizes.size() );
+    Edges.reserve( indices.size() / 2 + Vertices.size() );
+
+    std::vector< vertex_ptr_t > poly;
+    std::size_t k = 0;
+
+    for( std::size_t i = 0; i < sizes.size(); ++i )
+    {
+        poly.clear();
+        for( std::size_t j = 0; j < sizes[i]; ++j, ++k )
+            poly.push_back( Vertices[ indices[k] ] );
+
+        add_face( face_ptr_t( new face_t( poly.begin(), poly.end() ) ) );
+    }
+}
+
 template<typename Traits>
 void mesh<Traits>::clear() 
 {
@@ -0,0 +1,201 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_ORIENT_H
+#define GEOMETRY_ORIENT_H
+
+#include "Indexed.h"
+#include "UnionFind.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Result of the orientation fixing
+struct orientation_report
+{
+    orientation_report() : flips(0), non_orientable(0) {}
+
+    //!number of flipped faces
+    std::size_t flips;
+
+    //!number of components that are not orientable
+    std::size_t non_orientable;
+
+    //!number of faces, flipped faces and orientability of every component
+    std::vector< std::size_t > component_faces;
+    std::vector< std::size_t > component_flips;
+    std::vector< char > component_orientable;
+
+    std::size_t components()const { return component_faces.size(); }
+};
+
+/*!
+\brief Makes the orientation of the faces consistent
+\param m the mesh
+\param threads number of threads, 0 for the default
+\return the number of flips and the state of every component
+
+The components are the faces connected through edges with exactly two faces and are labeled 
+with a parallel union-find in the order of their first face. Every component is then walked 
+breadth first from its first face with a flat queue, the components in parallel, and every 
+face gets the orientation that matches its parent. If a face can not match all of its visited 
+neighbours the component is not orientable (a Moebius strip) and keeps the orientation of the 
+traversal. The orientation that needs fewer flips is kept and the faces are flipped at the end.
+*/
+template<typename MeshType>
+orientation_report orient_consistently( MeshType &m, int threads = 0 )
+{
+    typedef typename MeshType::real_t real_t;
+
+    indexed_mesh< real_t > im;
+    make_indexed( m, im, threads );
+
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+    const std::ptrdiff_t ne = std::ptrdiff_t( im.edges_size() );
+
+    std::vector< uid_t > corner_face( im.face_verts.size() );
+    index_rows edge_corners;
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+            corner_face[k] = uid_t( f );
+
+    group_by_key( im.face_edges, ne, edge_corners, threads );
+
+    union_find sets( nf );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t e = 0; e < ne; ++e )
+        if( edge_corners.row_size( e ) == 2 )
+            sets.unite( corner_face[ edge_corners.row_begin( e )[0] ], corner_face[ edge_corners.row_begin( e )[1] ] );
+
+    std::vector< uid_t > label;
+    orientation_report report;
+    const std::size_t components = sets.labels( label, threads );
+
+    index_rows component_faces;
+    group_by_key( label, components, component_faces, threads );
+
+    report.component_faces.resize( components );
+    report.component_flips.resize( components, 0 );
+    report.component_orientable.resize( components, 1 );
+
+    //bit 0 visited, bit 1 flipped
+    std::vector< unsigned char > state( nf, 0 );
+
+    #pragma omp parallel num_threads( parallel_threads( threads ) )
+    {
+        std::vector< uid_t > queue;
+
+        #pragma omp for schedule(dynamic,1)
+        for( std::ptrdiff_t c = 0; c < std::ptrdiff_t( components ); ++c )
+        {
+            const uid_t *faces = component_faces.row_begin( c );
+            const std::size_t size = component_faces.row_size( c );
+            std::size_t flips = 0;
+
+            queue.clear();
+            queue.push_back( faces[0] );
+            state[ faces[0] ] = 1;
+
+            for( std::size_t head = 0; head < queue.size(); ++head )
+            {
+                const uid_t f = queue[head];
+                const unsigned char flipped = state[f] & 2;
+
+                for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+                {
+                    const uid_t e = im.face_edges[k];
+
+                    if( edge_corners.row_size( e ) != 2 )
+                        continue;
+
+                    const uid_t *ec = edge_corners.row_begin( e );
+                    const uid_t other = ec[0] == k ? ec[1] : ec[0];
+                    const uid_t g = corner_face[ other ];
+
+                    if( g == f )
+                        continue;
+
+                    //the two faces agree when they run along the shared edge in opposite directions
+                    const bool same = (im.face_verts[k] == im.face_verts[ other ]);
+                    const unsigned char wanted = same ? (flipped ^ 2) : flipped;
+
+                    if( state[g] & 1 )
+                    {
+                        if( (state[g] & 2) != wanted )
+                            report.component_orientable[c] = 0;
+
+                        continue;
+                    }
+
+                    state[g] = 1 | wanted;
+                    flips += wanted ? 1 : 0;
+                    queue.push_back( g );
+                }
+            }
+
+            //flip the smaller part, a tie keeps the first face
+            if( 2 * flips > size )
+            {
+                for( std::size_t i = 0; i < size; ++i )
+                    state[ faces[i] ] ^= 2;
+
+                flips = size - flips;
+            }
+
+            report.component_faces[c] = size;
+            report.component_flips[c] = flips;
+        }
+    }
+
+    typename MeshType::face_iterator_t fb = m.faces_begin();
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t i = 0; i < nf; ++i )
+        if( state[ fb[i]->id() ] & 2 )
+            m.flip_face( fb[i] );
+
+    for( std::size_t c = 0; c < components; ++c )
+    {
+        report.flips += report.component_flips[c];
+        report.non_orientable += report.component_orientable[c] ? 0 : 1;
+    }
+
+    return report;
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef GEOMETRY_PARALLEL_H
+#define GEOMETRY_PARALLEL_H
+
+//The parallel passes are written with OpenMP pragmas, without OpenMP they run serially
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Number of threads a parallel pass uses, 0 requests the OpenMP default
+inline int parallel_threads( int requested = 0 )
+{
+#ifdef _OPENMP
+    return requested > 0 ? requested : omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+//!Index of the calling thread inside a parallel region
+inline int parallel_thread_id()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/*!
+\brief Atomically replaces *p by desired if it equals expected
+\return true if the value was replaced
+\note T must be an integer of 4 or 8 bytes
+*/
+template<typename T>
+inline bool compare_and_swap( volatile T *p, T expected, T desired )
+{
+#ifdef _MSC_VER
+    if( sizeof( T ) == 8 )
+        return _InterlockedCompareExchange64( (volatile __int64*)p, (__int64)desired, (__int64)expected ) == (__int64)expected;
+    else
+        return _InterlockedCompareExchange( (volatile long*)p, (long)desired, (long)expected ) == (long)expected;
+#else
+    return __sync_bool_compare_and_swap( p, expected, desired );
+#endif
+}
+
+/*!
+\brief Atomically adds v to *p
+\return the value of *p before the addition
+\note T must be an integer of 4 or 8 bytes
+*/
+template<typename T>
+inline T atomic_add( volatile T *p, T v )
+{
+#ifdef _MSC_VER
+    if( sizeof( T ) == 8 )
+        return (T)_InterlockedExchangeAdd64( (volatile __int64*)p, (__int64)v );
+    else
+        return (T)_InterlockedExchangeAdd( (volatile long*)p, (long)v );
+#else
+    return __sync_fetch_and_add( p, v );
+#endif
+}
+
+//!Atomically replaces *p by v if v is smaller
+template<typename T>
+inline void atomic_min( volatile T *p, T v )
+{
+    T current = *p;
+
+    while( v < current && !compare_and_swap( p, current, v ) )
+        current = *p;
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,320 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#ifndef GEOMETRY_PRIORITYQUEUE_H
+#define GEOMETRY_PRIORITYQUEUE_H
+
+#include "Traits.h"
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+
+#include <boost/cstdint.hpp>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Binary heap over the keys 0..n-1 whose priorities can be changed in place
+
+Each key is stored at most once and its position in the heap is tracked, so update and
+remove take O(log n) instead of pushing stale copies of the entries.
+The key with the highest priority according to Compare (the smallest by default) is on top.
+*/
+template< typename Priority, typename Compare = std::less< Priority > >
+class mutable_priority_queue
+{
+public:
+    typedef Priority priority_t;
+    typedef std::size_t key_t;
+
+    mutable_priority_queue( std::size_t keys = 0 )
+        : Position( keys, NO_ID )
+    {
+    }
+
+    //!clears the queue and allows keys in 0..keys-1
+    void reset( std::size_t keys )
+    {
+        Heap.clear();
+        Priorities.clear();
+        Position.assign( keys, NO_ID );
+    }
+
+    bool empty()const { return Heap.empty(); }
+    std::size_t size()const { return Heap.size(); }
+
+    bool contains( key_t k )const { return Position[k] != NO_ID; }
+
+    //!the key on top of the queue
+    key_t top()const { return Heap.front(); }
+
+    //!the priority of the key on top of the queue
+    const priority_t &top_priority()const { return Priorities.front(); }
+
+    //!the priority of a key in the queue
+    const priority_t &priority( key_t k )const { return Priorities[ Position[k] ]; }
+
+    //!inserts the key or changes its priority if it is already in the queue
+    void update( key_t k, const priority_t &p )
+    {
+        if( !contains( k ) )
+        {
+            Position[k] = Heap.size();
+            Heap.push_back( k );
+            Priorities.push_back( p );
+            sift_up( Heap.size() - 1 );
+            return;
+        }
+
+        std::size_t i = Position[k];
+        bool up = Comp( p, Priorities[i] );
+
+        Priorities[i] = p;
+
+        if( up )
+            sift_up( i );
+        else
+            sift_down( i );
+    }
+
+    //!removes the key from the queue if it is there
+    void remove( key_t k )
+    {
+        if( !contains( k ) )
+            return;
+
+        std::size_t i = Position[k];
+        Position[k] = NO_ID;
+
+        std::size_t last = Heap.size() - 1;
+
+        if( i != last )
+        {
+            Heap[i] = Heap[last];
+            Priorities[i] = Priorities[last];
+            Position[ Heap[i] ] = i;
+        }
+
+        Heap.pop_back();
+        Priorities.pop_back();
+
+        if( i != last )
+        {
+            //the moved key may have to go either way
+            key_t moved = Heap[i];
+
+            sift_up( i );
+            sift_down( Position[moved] );
+        }
+    }
+
+    //!removes the key on top of the queue
+    void pop()
+    {
+        remove( top() );
+    }
+
+private:
+    void swap_nodes( std::size_t i, std::size_t j )
+    {
+        std::swap( Heap[i], Heap[j] );
+        std::swap( Priorities[i], Priorities[j] );
+
+        Position[ Heap[i] ] = i;
+        Position[ Heap[j] ] = j;
+    }
+
+    void sift_up( std::size_t i )
+    {
+        while( i > 0 )
+        {
+            std::size_t parent = (i - 1) / 2;
+
+            if( !Comp( Priorities[i], Priorities[parent] ) )
+                break;
+
+            swap_nodes( i, parent );
+            i = parent;
+        }
+    }
+
+    void sift_down( std::size_t i )
+    {
+        for(;;)
+        {
+            std::size_t best = i;
+            std::size_t l = 2 * i + 1;
+            std::size_t r = l + 1;
+
+            if( l < Heap.size() && Comp( Priorities[l], Priorities[best] ) )
+                best = l;
+
+            if( r < Heap.size() && Comp( Priorities[r], Priorities[best] ) )
+                best = r;
+
+            if( best == i )
+                break;
+
+            swap_nodes( i, best );
+            i = best;
+        }
+    }
+
+    //!keys in heap order
+    std::vector< key_t > Heap;
+
+    //!priorities in heap order
+    std::vector< priority_t > Priorities;
+
+    //!position of every key in the heap or NO_ID
+    std::vector< std::size_t > Position;
+
+    Compare Comp;
+};
+
+
+/*!
+\brief Monotone priority queue of non-negative distances
+
+The distances are ordered by the bits of their double representation, which sort like the 
+values for non-negative numbers. An entry goes to the bucket of the highest bit where it 
+differs from the last removed distance, so pop only redistributes the first non empty bucket 
+and every entry moves at most 64 times. A pushed distance must not be smaller than the last 
+one removed, smaller ones are raised to it. An entry is pushed again when its distance 
+decreases and the stale copies are skipped by the caller.
+*/
+class radix_heap
+{
+public:
+    radix_heap() : Last(0), Size(0) {}
+
+    void clear()
+    {
+        for( int i = 0; i < 65; ++i )
+            Buckets[i].clear();
+
+        Last = 0;
+        Size = 0;
+    }
+
+    bool empty()const { return Size == 0; }
+    std::size_t size()const { return Size; }
+
+    void push( double distance, uid_t value )
+    {
+        boost::uint64_t key = bits( distance );
+
+        if( key < Last )
+            key = Last;
+
+        Buckets[ bucket( key ) ].push_back( entry_t( key, value ) );
+        ++Size;
+    }
+
+    //!removes an entry with the smallest distance
+    uid_t pop( double &distance )
+    {
+        if( Buckets[0].empty() )
+        {
+            int i = 1;
+            while( Buckets[i].empty() )
+                ++i;
+
+            std::vector< entry_t > &b = Buckets[i];
+
+            Last = b[0].first;
+            for( std::size_t k = 1; k < b.size(); ++k )
+                Last = std::min( Last, b[k].first );
+
+            for( std::size_t k = 0; k < b.size(); ++k )
+                Buckets[ bucket( b[k].first ) ].push_back( b[k] );
+
+            b.clear();
+        }
+
+        const entry_t e = Buckets[0].back();
+        Buckets[0].pop_back();
+        --Size;
+
+        std::memcpy( &distance, &e.first, sizeof( double ) );
+        return e.second;
+    }
+
+private:
+    typedef std::pair< boost::uint64_t, uid_t > entry_t;
+
+    static boost::uint64_t bits( double distance )
+    {
+        boost::uint64_t key = 0;
+
+        if( distance > 0.0 )
+            std::memcpy( &key, &distance, sizeof( double ) );
+
+        return key;
+    }
+
+    std::size_t bucket( boost::uint64_t key )const
+    {
+        boost::uint64_t x = key ^ Last;
+
+        if( x == 0 )
+            return 0;
+
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long i;
+        _BitScanReverse64( &i, x );
+        return i + 1;
+#elif defined(__GNUC__)
+        return 64 - __builtin_clzll( x );
+#else
+        std::size_t i = 0;
+        while( x )
+        {
+            x >>= 1;
+            ++i;
+        }
+        return i;
+#endif
+    }
+
+    boost::uint64_t Last;
+    std::size_t Size;
+
+    std::vector< entry_t > Buckets[65];
+};
+
+}
+
+}
+
+#endif
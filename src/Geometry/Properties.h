@@ -0,0 +1,348 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_PROPERTIES_H
+#define GEOMETRY_PROPERTIES_H
+
+#include "Indexed.h"
+#include "Parallel.h"
+#include "../Math/Matrix.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Bounding box, area, volume and moments of a mesh
+
+The volume and the moments are those of the solid enclosed by the faces with unit density, 
+they are meaningful for closed meshes and the volume is negative when the faces point inwards. 
+The polygons are split into fans of triangles from their first vertex.
+*/
+struct mesh_properties
+{
+    typedef math::vec3< double > point_t;
+
+    mesh_properties() : 
+        lo( std::numeric_limits<double>::max() ), hi( -std::numeric_limits<double>::max() ), 
+        area( 0.0 ), volume( 0.0 ), centroid( 0.0 ), center( 0.0 ), inertia( 0.0 ) 
+    {
+    }
+
+    //!corners of the bounding box of the vertices, lo > hi for a mesh without vertices
+    point_t lo, hi;
+
+    //!length of the diagonal of the bounding box
+    double diagonal()const { return (lo.x > hi.x) ? 0.0 : math::distance( lo, hi ); }
+
+    double area;
+    double volume;
+
+    //!area weighted centroid of the surface
+    point_t centroid;
+
+    //!center of mass of the solid
+    point_t center;
+
+    //!inertia tensor of the solid about its center of mass
+    math::mat3< double > inertia;
+};
+
+//!Sum with the Kahan correction of the rounding error of every addition
+struct compensated_sum
+{
+    compensated_sum() : sum( 0.0 ), c( 0.0 ) {}
+
+    void add( double v )
+    {
+        const double y = v - c;
+        const double t = sum + y;
+
+        c = (t - sum) - y;
+        sum = t;
+    }
+
+    double sum, c;
+};
+
+/*!
+\brief Pairwise sum of an array
+\param v the values
+\param first the first value
+\param last one past the last value
+\param stride the distance between two values
+*/
+inline double pairwise_sum( const std::vector< double > &v, std::size_t first, std::size_t last, std::size_t stride = 1 )
+{
+    if( last - first <= 8 * stride )
+    {
+        double s = 0.0;
+        for( std::size_t i = first; i < last; i += stride )
+            s += v[i];
+
+        return s;
+    }
+
+    const std::size_t middle = first + ((last - first) / stride / 2) * stride;
+
+    return pairwise_sum( v, first, middle, stride ) + pairwise_sum( v, middle, last, stride );
+}
+
+/*!
+\brief Bounding box of the vertices of a mesh
+\param m the mesh
+\param lo the lower corner
+\param hi the upper corner
+\param threads number of threads, 0 for the default
+\return false if the mesh has no vertices
+*/
+template<typename MeshType>
+bool bounding_box( const MeshType &m, typename MeshType::point_t &lo, typename MeshType::point_t &hi, int threads = 0 )
+{
+    typedef typename MeshType::point_t point_t;
+
+    const std::ptrdiff_t nv = std::ptrdiff_t( m.verts_size() );
+
+    if( nv == 0 )
+        return false;
+
+    typename MeshType::vertex_iterator_t vb = m.verts_begin();
+
+    threads = parallel_threads( threads );
+
+    std::vector< point_t > los( threads, vb[0]->point() ), his( threads, vb[0]->point() );
+
+    #pragma omp parallel num_threads( threads )
+    {
+        point_t &l = los[ parallel_thread_id() ];
+        point_t &h = his[ parallel_thread_id() ];
+
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t i = 0; i < nv; ++i )
+        {
+            const point_t &p = vb[i]->point();
+
+            for( int k = 0; k < 3; ++k )
+            {
+                l[k] = std::min( l[k], p[k] );
+                h[k] = std::max( h[k], p[k] );
+            }
+        }
+    }
+
+    lo = los[0];
+    hi = his[0];
+
+    for( int t = 1; t < threads; ++t )
+    {
+        for( int k = 0; k < 3; ++k )
+        {
+            lo[k] = std::min( lo[k], los[t][k] );
+            hi[k] = std::max( hi[k], his[t][k] );
+        }
+    }
+
+    return true;
+}
+
+/*!
+\brief Computes the bounding box, area, volume, centroid and inertia of an indexed mesh
+\param im the indexed mesh
+\param threads number of threads, 0 for the default
+\return the properties
+
+The faces are split in blocks of fixed size that do not depend on the number of threads. Every 
+block adds its terms with compensated sums and the blocks are added pairwise in block order, so 
+the result is the same for any number of threads. The integrals are taken relative to the 
+center of the bounding box, which keeps the cancellation of the signed tetrahedra small for 
+meshes far from the origin.
+*/
+template<typename Real>
+mesh_properties mass_properties( const indexed_mesh< Real > &im, int threads = 0 )
+{
+    typedef mesh_properties::point_t point_t;
+
+    //area, the area moments, volume, the first and the second moments of the solid
+    enum { AREA = 0, AREA_X = 1, VOLUME = 4, FIRST_X = 5, SECOND_XX = 8, SECOND_XY = 11, TERMS = 14 };
+    const std::size_t block = 4096;
+
+    const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+    const std::ptrdiff_t blocks = std::ptrdiff_t( (std::max( nv, nf ) + block - 1) / block );
+
+    threads = parallel_threads( threads );
+
+    mesh_properties r;
+
+    if( nv == 0 )
+        return r;
+
+    std::vector< point_t > los( blocks, r.lo ), his( blocks, r.hi );
+
+    #pragma omp parallel for num_threads( threads ) schedule(static)
+    for( std::ptrdiff_t b = 0; b < blocks; ++b )
+    {
+        const std::ptrdiff_t end = std::min( nv, std::ptrdiff_t( (b + 1) * block ) );
+
+        for( std::ptrdiff_t v = b * block; v < end; ++v )
+        {
+            for( int k = 0; k < 3; ++k )
+            {
+                los[b][k] = std::min( los[b][k], double( im.points[v][k] ) );
+                his[b][k] = std::max( his[b][k], double( im.points[v][k] ) );
+            }
+        }
+    }
+
+    for( std::ptrdiff_t b = 0; b < blocks; ++b )
+    {
+        for( int k = 0; k < 3; ++k )
+        {
+            r.lo[k] = std::min( r.lo[k], los[b][k] );
+            r.hi[k] = std::max( r.hi[k], his[b][k] );
+        }
+    }
+
+    const point_t o = 0.5 * (r.lo + r.hi);
+
+    std::vector< double > terms( blocks * TERMS, 0.0 );
+
+    #pragma omp parallel for num_threads( threads ) schedule(static)
+    for( std::ptrdiff_t b = 0; b < blocks; ++b )
+    {
+        compensated_sum s[ TERMS ];
+
+        const std::ptrdiff_t end = std::min( nf, std::ptrdiff_t( (b + 1) * block ) );
+
+        for( std::ptrdiff_t f = b * block; f < end; ++f )
+        {
+            const uid_t *fv = &im.face_verts[0] + im.face_start[f];
+            const std::size_t n = im.face_size( f );
+
+            if( n < 3 )
+                continue;
+
+            const point_t p0 = point_t( im.points[ fv[0] ].x, im.points[ fv[0] ].y, im.points[ fv[0] ].z ) - o;
+
+            for( std::size_t k = 1; k + 1 < n; ++k )
+            {
+                const point_t p1 = point_t( im.points[ fv[k] ].x, im.points[ fv[k] ].y, im.points[ fv[k] ].z ) - o;
+                const point_t p2 = point_t( im.points[ fv[k+1] ].x, im.points[ fv[k+1] ].y, im.points[ fv[k+1] ].z ) - o;
+
+                const point_t normal = math::cross( p1 - p0, p2 - p0 );
+                const point_t sum = p0 + p1 + p2;
+                const double area = 0.5 * math::magnitude( normal );
+
+                s[ AREA ].add( area );
+                for( int i = 0; i < 3; ++i )
+                    s[ AREA_X + i ].add( area * sum[i] / 3.0 );
+
+                //the tetrahedron from the origin to the triangle
+                const double det = math::dot( p0, math::cross( p1, p2 ) );
+
+                s[ VOLUME ].add( det / 6.0 );
+
+                for( int i = 0; i < 3; ++i )
+                {
+                    const int j = (i + 1) % 3;
+
+                    s[ FIRST_X + i ].add( det * sum[i] / 24.0 );
+
+                    s[ SECOND_XX + i ].add( det * (p0[i] * p0[i] + p1[i] * p1[i] + p2[i] * p2[i] + 
+                                                   p0[i] * p1[i] + p0[i] * p2[i] + p1[i] * p2[i]) / 60.0 );
+
+                    s[ SECOND_XY + i ].add( det * (sum[i] * sum[j] + p0[i] * p0[j] + p1[i] * p1[j] + p2[i] * p2[j]) / 120.0 );
+                }
+            }
+        }
+
+        for( int t = 0; t < TERMS; ++t )
+            terms[ b * TERMS + t ] = s[t].sum;
+    }
+
+    double total[ TERMS ];
+
+    for( int t = 0; t < TERMS; ++t )
+        total[t] = pairwise_sum( terms, t, terms.size(), TERMS );
+
+    r.area = total[ AREA ];
+    r.volume = total[ VOLUME ];
+
+    r.centroid = o;
+    if( r.area > 0.0 )
+        r.centroid += point_t( total[ AREA_X ], total[ AREA_X + 1 ], total[ AREA_X + 2 ] ) / r.area;
+
+    r.center = o;
+    if( r.volume != 0.0 )
+    {
+        const point_t c = point_t( total[ FIRST_X ], total[ FIRST_X + 1 ], total[ FIRST_X + 2 ] ) / r.volume;
+
+        r.center += c;
+
+        //the second moments about the center of mass by the parallel axis theorem
+        double xx[3], xy[3];
+
+        for( int i = 0; i < 3; ++i )
+        {
+            const int j = (i + 1) % 3;
+
+            xx[i] = total[ SECOND_XX + i ] - r.volume * c[i] * c[i];
+            xy[i] = total[ SECOND_XY + i ] - r.volume * c[i] * c[j];
+        }
+
+        r.inertia = math::mat3< double >( xx[1] + xx[2], -xy[0], -xy[2], 
+                                          -xy[0], xx[0] + xx[2], -xy[1], 
+                                          -xy[2], -xy[1], xx[0] + xx[1] );
+    }
+
+    return r;
+}
+
+/*!
+\brief Computes the bounding box, area, volume, centroid and inertia of a mesh
+\param m the mesh
+\param threads number of threads, 0 for the default
+\return the properties
+*/
+template<typename MeshType>
+mesh_properties mass_properties( const MeshType &m, int threads = 0 )
+{
+    indexed_mesh< typename MeshType::real_t > im;
+    make_indexed( m, im, threads );
+
+    return mass_properties( im, threads );
+}
+
+}
+
+}
+
+#endif
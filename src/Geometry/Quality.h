@@ -0,0 +1,312 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#ifndef GEOMETRY_QUALITY_H
+#define GEOMETRY_QUALITY_H
+
+#include "Indexed.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Statistics and histogram of a quality measure
+struct quality_measure
+{
+    /*!
+    \param start_ the lower end of the first bucket
+    \param width_ the width of the buckets
+    \param buckets the number of buckets
+    */
+    quality_measure( double start_ = 0.0, double width_ = 1.0, std::size_t buckets = 10 ) : 
+        min( std::numeric_limits<double>::max() ), max( -std::numeric_limits<double>::max() ), 
+        sum( 0.0 ), count( 0 ), start( start_ ), width( width_ ), histogram( buckets, 0 ) 
+    {
+    }
+
+    //!the mean of the values
+    double mean()const { return count ? sum / double( count ) : 0.0; }
+
+    //!the bucket of a value, the values out of range go to the first or the last bucket
+    std::size_t bucket( double v )const
+    {
+        double i = std::floor( (v - start) / width );
+
+        if( !(i > 0.0) )
+            return 0;
+
+        return std::min( std::size_t( i ), histogram.size() - 1 );
+    }
+
+    //!adds a value to the statistics
+    void add( double v )
+    {
+        min = std::min( min, v );
+        max = std::max( max, v );
+        sum += v;
+        ++count;
+    }
+
+    //!adds the statistics and the histogram of another measure with the same buckets
+    void merge( const quality_measure &o )
+    {
+        min = std::min( min, o.min );
+        max = std::max( max, o.max );
+        sum += o.sum;
+        count += o.count;
+
+        for( std::size_t i = 0; i < histogram.size(); ++i )
+            histogram[i] += o.histogram[i];
+    }
+
+    double min, max, sum;
+    std::size_t count;
+
+    //!bucket i counts the values in [start + i * width, start + (i + 1) * width)
+    double start, width;
+    std::vector< std::size_t > histogram;
+};
+
+/*!
+\brief Quality of the faces and the edges of a mesh
+
+The angles are in degrees and are binned in 5 degree buckets as in archmind_check.py.
+The aspect ratio of a triangle is its longest edge over the diameter of the inscribed circle
+scaled to 1 for the equilateral one, for polygons it is the longest over the shortest edge.
+The skew is the equiangle skew, 0 for regular faces and 1 for degenerate ones.
+*/
+struct mesh_quality
+{
+    mesh_quality() : 
+        faces( 0 ), degenerate( 0 ),
+        min_angle( 0.0, 5.0, 36 ), max_angle( 0.0, 5.0, 36 ), 
+        aspect_ratio( 1.0, 0.5, 10 ), skew( 0.0, 0.1, 10 )
+    {
+    }
+
+    //!number of faces and of faces with zero area that are not measured
+    std::size_t faces, degenerate;
+
+    quality_measure min_angle, max_angle, aspect_ratio, skew;
+
+    //!the histograms of the area and of the edge length split the range of the values in 10 buckets
+    quality_measure area, edge_length;
+};
+
+/*!
+\brief Computes the angle, aspect ratio, skew, area and edge length statistics of a mesh
+\param m the mesh
+\param threads number of threads, 0 for the default
+\return the statistics and the histograms
+
+Every thread fills its own bins which are merged in thread order at the end.
+*/
+template<typename MeshType>
+mesh_quality quality_report( const MeshType &m, int threads = 0 )
+{
+    typedef typename MeshType::real_t real_t;
+    typedef math::vec3<double> point_t;
+
+    const double to_degrees = 180.0 / 3.14159265358979323846;
+    const double sqrt3 = std::sqrt( 3.0 );
+
+    indexed_mesh< real_t > im;
+    make_indexed( m, im, threads );
+
+    const std::ptrdiff_t faces = std::ptrdiff_t( im.faces_size() );
+    const std::ptrdiff_t edges = std::ptrdiff_t( im.edges_size() );
+
+    threads = parallel_threads( threads );
+
+    std::vector< mesh_quality > parts( threads );
+    std::vector< double > areas( faces, -1.0 );
+    std::vector< double > lengths( edges );
+
+    #pragma omp parallel num_threads( threads )
+    {
+        mesh_quality &q = parts[ parallel_thread_id() ];
+        std::vector< point_t > p;
+        std::vector< double > len;
+
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t f = 0; f < faces; ++f )
+        {
+            const uid_t *fv = &im.face_verts[ im.face_start[f] ];
+            const std::size_t n = im.face_size( f );
+
+            ++q.faces;
+
+            if( n < 3 )
+            {
+                ++q.degenerate;
+                continue;
+            }
+
+            p.resize( n );
+            len.resize( n );
+
+            for( std::size_t k = 0; k < n; ++k )
+                p[k] = point_t( im.points[ fv[k] ] );
+
+            //the vector area works for planar polygons of any orientation
+            point_t normal( 0.0 );
+            double perimeter = 0.0;
+
+            for( std::size_t k = 0; k < n; ++k )
+            {
+                normal += math::cross( p[k], p[ (k + 1) % n ] );
+                len[k] = math::distance( p[k], p[ (k + 1) % n ] );
+                perimeter += len[k];
+            }
+
+            const double area = 0.5 * math::magnitude( normal );
+            const double lmax = *std::max_element( len.begin(), len.end() );
+            const double lmin = *std::min_element( len.begin(), len.end() );
+
+            if( !(area > std::numeric_limits<double>::epsilon() * lmax * lmax) )
+            {
+                ++q.degenerate;
+                continue;
+            }
+
+            areas[f] = area;
+            q.area.add( area );
+
+            double amin = 180.0, amax = 0.0;
+
+            for( std::size_t k = 0; k < n; ++k )
+            {
+                const double lp = len[ (k + n - 1) % n ], ln = len[k];
+
+                if( lp <= 0.0 || ln <= 0.0 )
+                {
+                    amin = 0.0;
+                    continue;
+                }
+
+                double c = math::dot( p[ (k + n - 1) % n ] - p[k], p[ (k + 1) % n ] - p[k] ) / (lp * ln);
+                double a = std::acos( std::max( -1.0, std::min( 1.0, c ) ) ) * to_degrees;
+
+                amin = std::min( amin, a );
+                amax = std::max( amax, a );
+            }
+
+            q.min_angle.add( amin );
+            ++q.min_angle.histogram[ q.min_angle.bucket( amin ) ];
+
+            q.max_angle.add( amax );
+            ++q.max_angle.histogram[ q.max_angle.bucket( amax ) ];
+
+            const double ratio = (n == 3) ? lmax * perimeter / (4.0 * sqrt3 * area) : lmax / lmin;
+
+            q.aspect_ratio.add( ratio );
+            ++q.aspect_ratio.histogram[ q.aspect_ratio.bucket( ratio ) ];
+
+            const double ideal = 180.0 * double( n - 2 ) / double( n );
+            const double skew = std::max( (amax - ideal) / (180.0 - ideal), (ideal - amin) / ideal );
+
+            q.skew.add( skew );
+            ++q.skew.histogram[ q.skew.bucket( skew ) ];
+        }
+
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t e = 0; e < edges; ++e )
+        {
+            lengths[e] = math::distance( point_t( im.points[ im.edge_verts[ 2 * e ] ] ), point_t( im.points[ im.edge_verts[ 2 * e + 1 ] ] ) );
+            q.edge_length.add( lengths[e] );
+        }
+    }
+
+    mesh_quality report;
+
+    for( std::size_t i = 0; i < parts.size(); ++i )
+    {
+        report.faces += parts[i].faces;
+        report.degenerate += parts[i].degenerate;
+
+        report.min_angle.merge( parts[i].min_angle );
+        report.max_angle.merge( parts[i].max_angle );
+        report.aspect_ratio.merge( parts[i].aspect_ratio );
+        report.skew.merge( parts[i].skew );
+        report.area.merge( parts[i].area );
+        report.edge_length.merge( parts[i].edge_length );
+    }
+
+    //the ranges of the area and the edge length are known only now
+    quality_measure *ranged[2] = { &report.area, &report.edge_length };
+
+    for( std::size_t i = 0; i < 2; ++i )
+    {
+        if( ranged[i]->count == 0 )
+            continue;
+
+        ranged[i]->start = ranged[i]->min;
+        ranged[i]->width = (ranged[i]->max > ranged[i]->min) ? (ranged[i]->max - ranged[i]->min) / double( ranged[i]->histogram.size() ) : 1.0;
+    }
+
+    std::vector< std::vector< std::size_t > > area_bins( threads, report.area.histogram );
+    std::vector< std::vector< std::size_t > > length_bins( threads, report.edge_length.histogram );
+
+    #pragma omp parallel num_threads( threads )
+    {
+        std::vector< std::size_t > &ab = area_bins[ parallel_thread_id() ];
+        std::vector< std::size_t > &lb = length_bins[ parallel_thread_id() ];
+
+        #pragma omp for schedule(static) nowait
+        for( std::ptrdiff_t f = 0; f < faces; ++f )
+        {
+            if( areas[f] >= 0.0 )
+                ++ab[ report.area.bucket( areas[f] ) ];
+        }
+
+        #pragma omp for schedule(static)
+        for( std::ptrdiff_t e = 0; e < edges; ++e )
+            ++lb[ report.edge_length.bucket( lengths[e] ) ];
+    }
+
+    for( std::size_t i = 0; i < std::size_t( threads ); ++i )
+    {
+        for( std::size_t k = 0; k < report.area.histogram.size(); ++k )
+        {
+            report.area.histogram[k] += area_bins[i][k];
+            report.edge_length.histogram[k] += length_bins[i][k];
+        }
+    }
+
+    return report;
+}
+
+}
+
+}
+
+#endif
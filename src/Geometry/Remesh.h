@@ -0,0 +1,1240 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_REMESH_H
+#define GEOMETRY_REMESH_H
+
+#include "Algorithms.h"
+#include "Indexed.h"
+#include "Bvh.h"
+#include "Parallel.h"
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Options of the isotropic remeshing
+struct remesh_options
+{
+    remesh_options() : target_length(-1.0), iterations(5), feature_angle(45.0), project(true), threads(0) {}
+
+    //!the edge length to reach, zero or negative for the mean edge length of the input
+    double target_length;
+
+    //!number of split, collapse, flip, relax and project iterations
+    int iterations;
+
+    //!dihedral angle in degrees above which an edge is a feature, the features and the boundary are kept
+    double feature_angle;
+
+    //!move the relaxed vertices to the closest point of the input surface
+    bool project;
+
+    //!number of threads, 0 for the default
+    int threads;
+};
+
+//!Number of operations applied by the remeshing
+struct remesh_stats
+{
+    remesh_stats() : splits(0), collapses(0), flips(0), rounds(0) {}
+
+    std::size_t splits, collapses, flips;
+
+    //!number of rounds of independent operations
+    std::size_t rounds;
+};
+
+/*!
+\brief Isotropic remeshing of Botsch and Kobbelt ('A Remeshing Approach to Multiresolution Modeling', 2004)
+
+Every iteration splits the edges longer than 4/3 of the target length, collapses the ones 
+shorter than 4/5 of it, flips the edges that bring the valences closer to 6 (4 on the boundary), 
+moves the vertices to the centroid of their neighbours in the tangent plane and projects them 
+back to the input surface through a face_bvh.
+
+The triangles are kept in flat arrays with the opposite half edge of every corner, the half 
+edge 3f+k runs from corner k of face f to the next corner. Splits, collapses and flips run in 
+rounds as the parallel decimation: the candidates are checked in parallel without changes to 
+the mesh, every candidate claims what it reads or writes with a pseudo random key and the ones 
+that hold all their claims are applied concurrently. The edges around the winners are checked 
+again, the losers away from them stay candidates of the next round. The new vertices and faces 
+get their ids in the order of the winners, so the result is the same for any number of threads.
+
+The boundary, the feature edges and their vertices are kept: such edges are split but not 
+collapsed or flipped and their vertices are not moved. Non manifold edges and vertices are 
+locked with all the edges around them.
+*/
+template<typename Real>
+class isotropic_remesher
+{
+public:
+    typedef Real real_t;
+    typedef math::vec3<double> point_t;
+
+    //!loads the triangles of the indexed mesh, polygons are triangulated
+    isotropic_remesher( const indexed_mesh<Real> &im, const remesh_options &options = remesh_options() )
+        : Options( options ), Threads( parallel_threads( options.threads ) ), FacesAlive( 0 )
+    {
+        Surface.build( im );
+        init( im );
+    }
+
+    //!number of triangles left
+    std::size_t faces_size()const { return FacesAlive; }
+
+    //!the edge length the remeshing aims at
+    double target_length()const { return Length; }
+
+    const remesh_stats &stats()const { return Stats; }
+
+    //!runs options.iterations iterations
+    void run()
+    {
+        for( int i = 0; i < Options.iterations; ++i )
+        {
+            split_long_edges();
+            collapse_short_edges();
+            equalize_valences();
+            relax();
+
+            if( Options.project )
+                project();
+        }
+    }
+
+    //!splits the edges longer than 4/3 of the target length at their middle
+    void split_long_edges()
+    {
+        Stats.splits += rounds( SPLIT );
+    }
+
+    //!collapses the edges shorter than 4/5 of the target length unless that creates long edges
+    void collapse_short_edges()
+    {
+        Stats.collapses += rounds( COLLAPSE );
+    }
+
+    //!flips the edges that bring the valences of their four vertices closer to the ideal
+    void equalize_valences()
+    {
+        Stats.flips += rounds( FLIP );
+    }
+
+    //!moves the free vertices to the centroid of their neighbours in their tangent plane
+    void relax()
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( Points.size() );
+        std::vector< point_t > moved( nv );
+
+        #pragma omp parallel num_threads( Threads )
+        {
+            std::vector< uid_t > hs;
+
+            #pragma omp for schedule(dynamic,1024)
+            for( std::ptrdiff_t v = 0; v < nv; ++v )
+            {
+                moved[v] = Points[v];
+
+                if( !is_free( v ) || !ring( v, hs ) || hs.empty() )
+                    continue;
+
+                point_t c( 0.0 ), n( 0.0 );
+
+                for( std::size_t i = 0; i < hs.size(); ++i )
+                {
+                    const point_t &x = Points[ Tris[ next( hs[i] ) ] ];
+                    const point_t &y = Points[ Tris[ prev( hs[i] ) ] ];
+
+                    c += x;
+                    n += math::cross( x - Points[v], y - Points[v] );
+                }
+
+                c /= double( hs.size() );
+
+                const double len = math::magnitude( n );
+                if( len > 0.0 )
+                    n /= len;
+
+                moved[v] = c + n * math::dot( n, Points[v] - c );
+            }
+        }
+
+        Points.swap( moved );
+    }
+
+    //!moves the free vertices to the closest point of the input surface
+    void project()
+    {
+        typedef typename face_bvh< Real >::point_t bvh_point_t;
+
+        const std::ptrdiff_t nv = std::ptrdiff_t( Points.size() );
+
+        #pragma omp parallel for num_threads( Threads ) schedule(dynamic,1024)
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+        {
+            if( !is_free( v ) )
+                continue;
+
+            typename face_bvh< Real >::closest_t r;
+
+            if( Surface.closest_point( bvh_point_t( Real( Points[v].x ), Real( Points[v].y ), Real( Points[v].z ) ), r ) )
+                Points[v] = point_t( r.point.x, r.point.y, r.point.z );
+        }
+    }
+
+    /*!
+    \brief Writes the result back to the mesh it was loaded from
+    \note the removed vertices are deleted from the mesh, the rest keep their order and the new 
+    vertices follow them
+    */
+    template<typename MeshType>
+    void apply( MeshType &m )const
+    {
+        typedef typename MeshType::point_t mesh_point_t;
+        typedef typename MeshType::vertex_t vertex_t;
+        typedef typename MeshType::vertex_ptr_t vertex_ptr_t;
+
+        typename MeshType::vertex_array_t verts;
+        std::vector< uid_t > index( Points.size(), NO_ID );
+
+        verts.reserve( Points.size() );
+
+        std::size_t i = 0;
+        for( typename MeshType::vertex_iterator_t v = m.verts_begin(); v != m.verts_end(); ++v, ++i )
+        {
+            if( Removed[i] )
+                continue;
+
+            index[i] = verts.size();
+            verts.push_back( *v );
+            m.set_point( *v, mesh_point_t( Points[i] ) );
+        }
+
+        for( ; i < Points.size(); ++i )
+        {
+            if( Removed[i] )
+                continue;
+
+            index[i] = verts.size();
+            verts.push_back( vertex_ptr_t( new vertex_t( mesh_point_t( Points[i] ) ) ) );
+        }
+
+        std::vector< std::size_t > sizes( FacesAlive, 3 );
+        std::vector< uid_t > indices;
+
+        indices.reserve( 3 * FacesAlive );
+
+        for( std::size_t f = 0; f < FaceAlive.size(); ++f )
+        {
+            if( !FaceAlive[f] )
+                continue;
+
+            for( std::size_t k = 0; k < 3; ++k )
+                indices.push_back( index[ Tris[ 3 * f + k ] ] );
+        }
+
+        m.rebuild( verts, sizes, indices );
+    }
+
+private:
+    enum operation_t { SPLIT, COLLAPSE, FLIP };
+
+    //!an operation that passed its checks, the half edge of a collapse points to the removed vertex
+    struct candidate
+    {
+        boost::uint64_t key;
+        uid_t h;
+    };
+
+    static bool by_edge( const candidate &a, const candidate &b ) { return a.h < b.h; }
+
+    static uid_t next( uid_t h ) { return h - h % 3 + (h % 3 + 1) % 3; }
+    static uid_t prev( uid_t h ) { return h - h % 3 + (h % 3 + 2) % 3; }
+
+    //!the half edge that stands for an edge, the smaller of the pair
+    uid_t canonical( uid_t h )const { return (Opposite[h] != NO_ID && Opposite[h] < h) ? Opposite[h] : h; }
+
+    bool is_free( std::ptrdiff_t v )const { return !Removed[v] && !Fixed[v] && !Locked[v]; }
+
+    double length2( uid_t h )const
+    {
+        const point_t d = Points[ Tris[ next( h ) ] ] - Points[ Tris[h] ];
+        return math::dot( d, d );
+    }
+
+    /*!
+    \brief The half edges that leave a vertex, one per face around it
+    \return false if the vertex is on the boundary, then the faces are listed from one boundary 
+    edge to the other
+    */
+    bool ring( uid_t v, std::vector< uid_t > &hs )const
+    {
+        hs.clear();
+
+        const uid_t h0 = VertexHalfedge[v];
+        if( h0 == NO_ID )
+            return true;
+
+        uid_t h = h0;
+        do
+        {
+            hs.push_back( h );
+            h = Opposite[ prev( h ) ];
+        }
+        while( h != NO_ID && h != h0 );
+
+        if( h == h0 )
+            return true;
+
+        //the faces before h0 up to the other boundary edge
+        const std::size_t forward = hs.size();
+
+        for( uid_t o = Opposite[h0]; o != NO_ID; o = Opposite[h] )
+        {
+            h = next( o );
+            hs.push_back( h );
+        }
+
+        std::reverse( hs.begin() + forward, hs.end() );
+        std::rotate( hs.begin(), hs.begin() + forward, hs.end() );
+
+        return false;
+    }
+
+    //!the neighbours of a vertex in the order of the faces around it
+    void neighbours( const std::vector< uid_t > &hs, bool closed, std::vector< uid_t > &verts )const
+    {
+        verts.clear();
+
+        for( std::size_t i = 0; i < hs.size(); ++i )
+            verts.push_back( Tris[ next( hs[i] ) ] );
+
+        if( !closed && !hs.empty() )
+            verts.push_back( Tris[ prev( hs.back() ) ] );
+    }
+
+    //!links two half edges, either may be NO_ID
+    void connect( uid_t a, uid_t b, char sharp )
+    {
+        if( a != NO_ID )
+        {
+            Opposite[a] = b;
+            Sharp[a] = sharp;
+        }
+
+        if( b != NO_ID )
+        {
+            Opposite[b] = a;
+            Sharp[b] = sharp;
+        }
+    }
+
+    //!pseudo random order of the edges for the parallel claims, the top byte is left for the round
+    static boost::uint64_t claim_key( uid_t e, boost::uint32_t level = 0 )
+    {
+        boost::uint32_t h = boost::uint32_t( e );
+
+        h ^= h >> 16;
+        h *= 0x85ebca6bU;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35U;
+        h ^= h >> 16;
+
+        return (boost::uint64_t( level ) << 48) | (boost::uint64_t( h >> 16 ) << 32) | boost::uint64_t( e & 0xffffffff );
+    }
+
+    /*!
+    \brief The longer edges split first
+    
+    The splits in random order make fans of long edges around the vertices opposite to the edges 
+    split again and again, the strict order by length leaves few independent splits per round. 
+    The lengths are grouped by quarters of octaves and the splits of a group are in random order.
+    */
+    boost::uint64_t split_key( double l2, uid_t e )const
+    {
+        const int level = int( 2.0 * std::log( l2 / High2 ) / std::log( 2.0 ) );
+
+        return claim_key( e, boost::uint32_t( 0xff - std::min( std::max( level, 0 ), 0xff ) ) );
+    }
+
+    //!valence the vertex should have
+    int ideal_valence( uid_t v )const { return Boundary[v] ? 4 : 6; }
+
+    //!the scratch space of the checks of one thread
+    struct scratch
+    {
+        std::vector< uid_t > ha, hb, va, vb;
+    };
+
+    /*!
+    \brief Checks an operation on the edge of a half edge without changing the mesh
+    \param h the half edge, for the collapses it is turned towards the vertex to remove
+    \return false if the operation does not apply
+    */
+    bool check( operation_t op, uid_t &h, boost::uint64_t &key, scratch &s )const
+    {
+        const uid_t o = Opposite[h];
+        const uid_t a = Tris[h], b = Tris[ next( h ) ];
+
+        if( Locked[a] || Locked[b] )
+            return false;
+
+        if( op == SPLIT )
+        {
+            const double l2 = length2( h );
+
+            if( l2 <= High2 )
+                return false;
+
+            key = split_key( l2, h );
+            return true;
+        }
+
+        //the collapses and the flips are for interior edges between two faces
+        if( Sharp[h] || o == NO_ID )
+            return false;
+
+        const uid_t c = Tris[ prev( h ) ], d = Tris[ prev( o ) ];
+
+        if( c == d || Locked[c] || Locked[d] )
+            return false;
+
+        if( op == FLIP )
+        {
+            const int va = int( Valence[a] ), vb = int( Valence[b] ), vc = int( Valence[c] ), vd = int( Valence[d] );
+
+            if( va <= (Boundary[a] ? 2 : 3) || vb <= (Boundary[b] ? 2 : 3) )
+                return false;
+
+            const int ea = va - ideal_valence( a ), eb = vb - ideal_valence( b );
+            const int ec = vc - ideal_valence( c ), ed = vd - ideal_valence( d );
+
+            const int before = ea * ea + eb * eb + ec * ec + ed * ed;
+            const int after = (ea - 1) * (ea - 1) + (eb - 1) * (eb - 1) + (ec + 1) * (ec + 1) + (ed + 1) * (ed + 1);
+
+            if( after >= before )
+                return false;
+
+            //the new faces (a,d,c) and (d,b,c) must face the same side as the old ones
+            const point_t &pa = Points[a], &pb = Points[b], &pc = Points[c], &pd = Points[d];
+            const point_t n = math::cross( pb - pa, pc - pa ) + math::cross( pa - pb, pd - pb );
+
+            if( math::dot( math::cross( pd - pa, pc - pa ), n ) <= 0.0 || math::dot( math::cross( pb - pd, pc - pd ), n ) <= 0.0 )
+                return false;
+
+            //the new edge must not exist already
+            const bool closed = ring( c, s.ha );
+            neighbours( s.ha, closed, s.va );
+
+            if( std::find( s.va.begin(), s.va.end(), d ) != s.va.end() )
+                return false;
+
+            key = claim_key( h );
+            return true;
+        }
+
+        //the collapse removes a free vertex, into the other end when that one is kept
+        const bool free_a = !Fixed[a], free_b = !Fixed[b];
+
+        if( !free_a && !free_b )
+            return false;
+
+        const double l2 = length2( h );
+
+        if( l2 >= Low2 )
+            return false;
+
+        if( !free_b )
+            h = o;
+
+        const uid_t keep = Tris[h], gone = Tris[ next( h ) ];
+        const point_t p = (free_a && free_b) ? (Points[a] + Points[b]) * 0.5 : Points[keep];
+
+        if( Valence[c] <= 3 || Valence[d] <= 3 )
+            return false;
+
+        const bool keep_closed = ring( keep, s.ha );
+        const bool gone_closed = ring( gone, s.hb );
+
+        if( !gone_closed )
+            return false;
+
+        neighbours( s.ha, keep_closed, s.va );
+        neighbours( s.hb, gone_closed, s.vb );
+
+        //the link condition, the vertices opposite to the edge are the only common neighbours
+        std::size_t common = 0;
+        for( std::size_t i = 0; i < s.vb.size(); ++i )
+        {
+            if( std::find( s.va.begin(), s.va.end(), s.vb[i] ) != s.va.end() )
+                ++common;
+        }
+
+        if( common != 2 )
+            return false;
+
+        //no edge longer than the split length and no face turned over
+        if( !fits( gone, keep, p, s.hb ) || (free_a && free_b && !fits( keep, gone, p, s.ha )) )
+            return false;
+
+        key = claim_key( canonical( h ) );
+        return true;
+    }
+
+    //!true if moving v to p keeps its edges short and its faces without o the right side up
+    bool fits( uid_t v, uid_t o, const point_t &p, const std::vector< uid_t > &hs )const
+    {
+        for( std::size_t i = 0; i < hs.size(); ++i )
+        {
+            const uid_t x = Tris[ next( hs[i] ) ], y = Tris[ prev( hs[i] ) ];
+
+            if( x != o && math::dot( Points[x] - p, Points[x] - p ) >= High2 )
+                return false;
+
+            if( x == o || y == o )
+                continue;
+
+            const point_t n0 = math::cross( Points[x] - Points[v], Points[y] - Points[v] );
+            const point_t n1 = math::cross( Points[x] - p, Points[y] - p );
+
+            if( math::dot( n0, n1 ) <= 1e-3 * math::magnitude( n0 ) * math::magnitude( n1 ) || math::dot( n1, n1 ) <= 0.0 )
+                return false;
+        }
+
+        return true;
+    }
+
+    /*!
+    \brief What an operation claims
+    
+    A split or a flip claims the four vertices of its two faces, so the ones that run together 
+    never create the same edge. A collapse claims the faces around its two vertices, which are all 
+    the faces it reads or writes, as the vertices around them would block too many collapses.
+    */
+    void claim_set( operation_t op, uid_t h, std::vector< uid_t > &verts, scratch &s )const
+    {
+        verts.clear();
+
+        if( op == COLLAPSE )
+        {
+            ring( Tris[h], s.ha );
+            ring( Tris[ next( h ) ], s.hb );
+
+            for( std::size_t i = 0; i < s.ha.size(); ++i )
+                verts.push_back( s.ha[i] / 3 );
+
+            for( std::size_t i = 0; i < s.hb.size(); ++i )
+                verts.push_back( s.hb[i] / 3 );
+
+            return;
+        }
+
+        verts.push_back( Tris[h] );
+        verts.push_back( Tris[ next( h ) ] );
+        verts.push_back( Tris[ prev( h ) ] );
+
+        if( Opposite[h] != NO_ID )
+            verts.push_back( Tris[ prev( Opposite[h] ) ] );
+    }
+
+    /*!
+    \brief Applies the operations of a kind in rounds of independent sets
+    \return the number of operations applied
+    */
+    std::size_t rounds( operation_t op )
+    {
+        std::vector< candidate > candidates, losers;
+        std::vector< uid_t > pending, winners;
+        std::vector< std::vector< candidate > > found( Threads );
+        std::vector< std::vector< uid_t > > changed( Threads );
+        std::vector< char > won;
+
+        std::size_t applied = 0;
+        bool scan = true;
+
+        //the claims of a round are below the ones left by the previous rounds, which are not cleared
+        boost::uint64_t epoch = 0;
+
+        while( scan || !pending.empty() || !losers.empty() )
+        {
+            const std::ptrdiff_t n = scan ? std::ptrdiff_t( Tris.size() ) : std::ptrdiff_t( pending.size() );
+
+            #pragma omp parallel num_threads( Threads )
+            {
+                std::vector< candidate > &mine = found[ parallel_thread_id() ];
+                scratch s;
+
+                mine.clear();
+
+                #pragma omp for schedule(dynamic,4096)
+                for( std::ptrdiff_t i = 0; i < n; ++i )
+                {
+                    candidate c;
+                    c.h = scan ? uid_t( i ) : pending[i];
+
+                    if( !FaceAlive[ c.h / 3 ] || canonical( c.h ) != c.h )
+                        continue;
+
+                    if( check( op, c.h, c.key, s ) )
+                        mine.push_back( c );
+                }
+            }
+
+            scan = false;
+            candidates.swap( losers );
+
+            for( int t = 0; t < Threads; ++t )
+                candidates.insert( candidates.end(), found[t].begin(), found[t].end() );
+
+            if( candidates.empty() )
+                break;
+
+            ++Stats.rounds;
+
+            //in the order of the faces, the claims of neighbouring candidates read the same memory
+            std::sort( candidates.begin(), candidates.end(), by_edge );
+
+            const std::ptrdiff_t nc = std::ptrdiff_t( candidates.size() );
+            won.assign( nc, 0 );
+
+            const std::size_t claims = (op == COLLAPSE) ? FaceAlive.size() : Points.size();
+
+            if( epoch == 0 )
+            {
+                Claims.assign( claims, ~boost::uint64_t( 0 ) );
+                epoch = 0xff;
+            }
+            else
+            {
+                Claims.resize( claims, ~boost::uint64_t( 0 ) );
+                --epoch;
+            }
+
+            #pragma omp parallel num_threads( Threads )
+            {
+                std::vector< uid_t > verts;
+                scratch s;
+
+                #pragma omp for schedule(dynamic,1024)
+                for( std::ptrdiff_t i = 0; i < nc; ++i )
+                {
+                    claim_set( op, candidates[i].h, verts, s );
+
+                    for( std::size_t k = 0; k < verts.size(); ++k )
+                        atomic_min( &Claims[ verts[k] ], (epoch << 56) | candidates[i].key );
+                }
+
+                //the candidates that hold all their claims read and write disjoint faces
+                #pragma omp for schedule(dynamic,1024)
+                for( std::ptrdiff_t i = 0; i < nc; ++i )
+                {
+                    claim_set( op, candidates[i].h, verts, s );
+
+                    std::size_t k = 0;
+                    while( k < verts.size() && Claims[ verts[k] ] == ((epoch << 56) | candidates[i].key) )
+                        ++k;
+
+                    won[i] = (k == verts.size());
+                }
+            }
+
+            winners.clear();
+            losers.clear();
+
+            for( std::ptrdiff_t i = 0; i < nc; ++i )
+            {
+                if( won[i] )
+                    winners.push_back( candidates[i].h );
+                else
+                    losers.push_back( candidates[i] );
+            }
+
+            //the ids of the new vertices and faces follow the order of the winners
+            std::sort( winners.begin(), winners.end() );
+
+            const std::size_t first_vertex = Points.size(), first_face = FaceAlive.size();
+
+            if( op == SPLIT )
+                grow( first_vertex + winners.size(), first_face + 2 * winners.size() );
+
+            std::ptrdiff_t faces = 0;
+
+            #pragma omp parallel num_threads( Threads ) reduction(+:faces)
+            {
+                std::vector< uid_t > &mine = changed[ parallel_thread_id() ];
+                std::vector< uid_t > hs;
+
+                mine.clear();
+
+                #pragma omp for schedule(dynamic,256)
+                for( std::ptrdiff_t i = 0; i < std::ptrdiff_t( winners.size() ); ++i )
+                {
+                    const uid_t h = winners[i];
+
+                    if( op == SPLIT )
+                        faces += split( h, uid_t( first_vertex + i ), uid_t( first_face + 2 * i ), mine );
+                    else if( op == COLLAPSE )
+                        faces -= collapse( h, hs, mine );
+                    else
+                        flip( h, hs, mine );
+                }
+            }
+
+            //the vertices opposite to the collapsed edges may be shared by several collapses
+            if( op == COLLAPSE )
+            {
+                for( std::size_t i = 0; i < winners.size(); ++i )
+                    opposite_fixup( winners[i] );
+            }
+
+            FacesAlive += faces;
+            applied += winners.size();
+
+            pending.clear();
+
+            for( int t = 0; t < Threads; ++t )
+                pending.insert( pending.end(), changed[t].begin(), changed[t].end() );
+
+            //the edges around the winners are checked again, the losers away from them are still valid
+            for( std::size_t i = 0; i < pending.size(); ++i )
+                Marked[ Tris[ pending[i] ] ] = 1;
+
+            std::size_t kept = 0;
+            for( std::size_t i = 0; i < losers.size(); ++i )
+            {
+                if( !marked( losers[i].h ) )
+                    losers[ kept++ ] = losers[i];
+                else
+                    pending.push_back( losers[i].h );
+            }
+
+            losers.resize( kept );
+
+            kept = 0;
+            for( std::size_t i = 0; i < pending.size(); ++i )
+            {
+                const uid_t h = pending[i];
+
+                Marked[ Tris[h] ] = 0;
+
+                if( FaceAlive[ h / 3 ] && !Queued[ canonical( h ) ] )
+                {
+                    Queued[ canonical( h ) ] = 1;
+                    pending[ kept++ ] = canonical( h );
+                }
+            }
+
+            pending.resize( kept );
+
+            for( std::size_t i = 0; i < pending.size(); ++i )
+                Queued[ pending[i] ] = 0;
+        }
+
+        return applied;
+    }
+
+    //!true if a vertex of the faces of the edge of h was changed in the last round
+    bool marked( uid_t h )const
+    {
+        const uid_t o = Opposite[h];
+
+        if( !FaceAlive[ h / 3 ] || Marked[ Tris[h] ] || Marked[ Tris[ next( h ) ] ] || Marked[ Tris[ prev( h ) ] ] )
+            return true;
+
+        return o != NO_ID && Marked[ Tris[ prev( o ) ] ];
+    }
+
+    //!makes room for the vertices and the faces of the splits
+    void grow( std::size_t verts, std::size_t faces )
+    {
+        Points.resize( verts );
+        VertexHalfedge.resize( verts, NO_ID );
+        Valence.resize( verts, 0 );
+        Fixed.resize( verts, 0 );
+        Boundary.resize( verts, 0 );
+        Locked.resize( verts, 0 );
+        Removed.resize( verts, 0 );
+        Marked.resize( verts, 0 );
+
+        Tris.resize( 3 * faces, NO_ID );
+        Opposite.resize( 3 * faces, NO_ID );
+        Sharp.resize( 3 * faces, 0 );
+        Queued.resize( 3 * faces, 0 );
+        FaceAlive.resize( faces, 0 );
+    }
+
+    //!appends the half edges of the faces around v
+    void touch( uid_t v, std::vector< uid_t > &hs, std::vector< uid_t > &changed )const
+    {
+        ring( v, hs );
+
+        for( std::size_t i = 0; i < hs.size(); ++i )
+        {
+            changed.push_back( hs[i] );
+            changed.push_back( next( hs[i] ) );
+            changed.push_back( prev( hs[i] ) );
+        }
+    }
+
+    /*!
+    \brief Splits the edge of h at its middle
+    \param m the id of the new vertex
+    \param f the ids of the two new faces, the second is left dead on the boundary
+    \return the number of faces added
+    */
+    std::ptrdiff_t split( uid_t h, uid_t m, uid_t f, std::vector< uid_t > &changed )
+    {
+        //(a,b,c) becomes (a,m,c) and (m,b,c), (b,a,d) becomes (b,m,d) and (m,a,d)
+        const uid_t h1 = next( h ), h2 = prev( h ), o = Opposite[h];
+        const uid_t a = Tris[h], b = Tris[h1], c = Tris[h2];
+        const uid_t ob = Opposite[h1];
+        const char sab = Sharp[h], sb = Sharp[h1];
+        const uid_t A = 3 * f, B = 3 * (f + 1);
+
+        Points[m] = (Points[a] + Points[b]) * 0.5;
+        Fixed[m] = sab ? 1 : 0;
+        Boundary[m] = (o == NO_ID);
+
+        Tris[h1] = m;
+        Tris[A] = m;
+        Tris[A + 1] = b;
+        Tris[A + 2] = c;
+        FaceAlive[f] = 1;
+
+        connect( A + 1, ob, sb );
+        connect( h1, A + 2, 0 );
+
+        std::ptrdiff_t added = 1;
+
+        if( o != NO_ID )
+        {
+            const uid_t o1 = next( o );
+            const uid_t d = Tris[ prev( o ) ];
+            const uid_t oa = Opposite[o1];
+            const char sa = Sharp[o1];
+
+            Tris[o1] = m;
+            Tris[B] = m;
+            Tris[B + 1] = a;
+            Tris[B + 2] = d;
+            FaceAlive[f + 1] = 1;
+
+            connect( B + 1, oa, sa );
+            connect( o1, B + 2, 0 );
+            connect( h, B, sab );
+            connect( A, o, sab );
+
+            ++Valence[d];
+            Valence[m] = 4;
+            ++added;
+
+            changed.push_back( o );
+            changed.push_back( o1 );
+            changed.push_back( prev( o ) );
+            changed.push_back( B );
+            changed.push_back( B + 1 );
+            changed.push_back( B + 2 );
+        }
+        else
+        {
+            connect( h, NO_ID, 1 );
+            connect( A, NO_ID, 1 );
+            Valence[m] = 3;
+        }
+
+        ++Valence[c];
+
+        VertexHalfedge[a] = h;
+        VertexHalfedge[b] = A + 1;
+        VertexHalfedge[m] = h1;
+
+        changed.push_back( h );
+        changed.push_back( h1 );
+        changed.push_back( h2 );
+        changed.push_back( A );
+        changed.push_back( A + 1 );
+        changed.push_back( A + 2 );
+
+        return added;
+    }
+
+    /*!
+    \brief Collapses the edge of h into its first vertex
+    \return the number of faces removed
+    */
+    std::ptrdiff_t collapse( uid_t h, std::vector< uid_t > &hs, std::vector< uid_t > &changed )
+    {
+        //the faces (s,r,c) and (r,s,e) of the edge disappear and r is replaced by s
+        const uid_t o = Opposite[h];
+        const uid_t s = Tris[h], r = Tris[ next( h ) ];
+
+        const uid_t rc = Opposite[ next( h ) ], cs = Opposite[ prev( h ) ];
+        const uid_t es = Opposite[ next( o ) ], re = Opposite[ prev( o ) ];
+
+        if( !Fixed[s] )
+            Points[s] = (Points[s] + Points[r]) * 0.5;
+
+        ring( r, hs );
+
+        for( std::size_t i = 0; i < hs.size(); ++i )
+            Tris[ hs[i] ] = s;
+
+        connect( rc, cs, Sharp[ next( h ) ] || Sharp[ prev( h ) ] );
+        connect( re, es, Sharp[ next( o ) ] || Sharp[ prev( o ) ] );
+
+        FaceAlive[ h / 3 ] = 0;
+        FaceAlive[ o / 3 ] = 0;
+
+        VertexHalfedge[s] = re;
+        VertexHalfedge[r] = NO_ID;
+
+        Valence[s] += Valence[r] - 4;
+        Removed[r] = 1;
+
+        touch( s, hs, changed );
+
+        return 2;
+    }
+
+    //!updates the vertices opposite to an edge collapsed in the last round
+    void opposite_fixup( uid_t h )
+    {
+        //the removed faces keep their opposite vertices and the half edges next to them
+        const uid_t o = Opposite[h];
+        const uid_t c = Tris[ prev( h ) ], e = Tris[ prev( o ) ];
+
+        if( !FaceAlive[ VertexHalfedge[c] / 3 ] )
+            VertexHalfedge[c] = Opposite[ next( h ) ];
+
+        if( !FaceAlive[ VertexHalfedge[e] / 3 ] )
+            VertexHalfedge[e] = next( Opposite[ prev( o ) ] );
+
+        --Valence[c];
+        --Valence[e];
+    }
+
+    //!flips the edge of h to the other diagonal of its two faces
+    void flip( uid_t h, std::vector< uid_t > &hs, std::vector< uid_t > &changed )
+    {
+        //(a,b,c) and (b,a,d) become (a,d,c) and (b,c,d)
+        const uid_t o = Opposite[h];
+        const uid_t h1 = next( h ), o1 = next( o );
+        const uid_t a = Tris[h], b = Tris[h1], c = Tris[ prev( h ) ], d = Tris[ prev( o ) ];
+
+        const uid_t bc = Opposite[h1], ad = Opposite[o1];
+        const char sbc = Sharp[h1], sad = Sharp[o1];
+
+        Tris[h1] = d;
+        Tris[o1] = c;
+
+        connect( h, ad, sad );
+        connect( o, bc, sbc );
+        connect( h1, o1, 0 );
+
+        VertexHalfedge[a] = h;
+        VertexHalfedge[b] = o;
+
+        --Valence[a];
+        --Valence[b];
+        ++Valence[c];
+        ++Valence[d];
+
+        touch( a, hs, changed );
+        touch( b, hs, changed );
+        touch( c, hs, changed );
+        touch( d, hs, changed );
+    }
+
+    void init( const indexed_mesh<Real> &im )
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+        const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+
+        Points.resize( nv );
+
+        #pragma omp parallel for num_threads( Threads ) schedule(static)
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+            Points[v] = point_t( im.points[v] );
+
+        //the polygons are triangulated, each into its own range of triangles
+        std::vector< uid_t > tri_start( nf + 1, 0 );
+
+        for( std::ptrdiff_t f = 0; f < nf; ++f )
+            tri_start[f+1] = tri_start[f] + uid_t( im.face_size( f ) >= 3 ? im.face_size( f ) - 2 : 0 );
+
+        const std::ptrdiff_t nt = std::ptrdiff_t( tri_start.back() );
+
+        Tris.resize( 3 * nt );
+
+        #pragma omp parallel num_threads( Threads )
+        {
+            std::vector< typename indexed_mesh<Real>::point_t > poly;
+            std::vector< std::size_t > tris;
+
+            #pragma omp for schedule(dynamic,1024)
+            for( std::ptrdiff_t f = 0; f < nf; ++f )
+            {
+                const uid_t *fv = &im.face_verts[0] + im.face_start[f];
+                const std::size_t n = im.face_size( f );
+                uid_t *t = &Tris[0] + 3 * tri_start[f];
+
+                if( n < 3 )
+                    continue;
+
+                if( n == 3 )
+                {
+                    std::copy( fv, fv + 3, t );
+                    continue;
+                }
+
+                poly.resize( n );
+                for( std::size_t k = 0; k < n; ++k )
+                    poly[k] = im.points[ fv[k] ];
+
+                tris.clear();
+                triangulate_polygon( poly, tris );
+
+                for( std::size_t k = 0; k < tris.size(); ++k )
+                    t[k] = fv[ tris[k] ];
+            }
+        }
+
+        FaceAlive.assign( nt, 1 );
+        FacesAlive = nt;
+
+        const std::ptrdiff_t nh = 3 * nt;
+
+        Opposite.assign( nh, NO_ID );
+        Sharp.assign( nh, 0 );
+        Queued.assign( nh, 0 );
+
+        std::vector< point_t > normals( nt );
+
+        #pragma omp parallel for num_threads( Threads ) schedule(static)
+        for( std::ptrdiff_t f = 0; f < nt; ++f )
+        {
+            const uid_t *t = &Tris[ 3 * f ];
+            const point_t n = math::cross( Points[t[1]] - Points[t[0]], Points[t[2]] - Points[t[0]] );
+            const double len = math::magnitude( n );
+
+            normals[f] = len > 0.0 ? n / len : point_t( 0.0 );
+        }
+
+        //the half edges grouped by their smaller vertex find their opposites
+        std::vector< uid_t > lower( nh );
+
+        #pragma omp parallel for num_threads( Threads ) schedule(static)
+        for( std::ptrdiff_t h = 0; h < nh; ++h )
+            lower[h] = std::min( Tris[h], Tris[ next( uid_t( h ) ) ] );
+
+        index_rows rows;
+        group_by_key( lower, nv, rows, Threads );
+
+        const double feature_cos = std::cos( Options.feature_angle * 3.14159265358979323846 / 180.0 );
+
+        #pragma omp parallel num_threads( Threads )
+        {
+            std::vector< std::pair< uid_t, uid_t > > ends;
+
+            #pragma omp for schedule(dynamic,1024)
+            for( std::ptrdiff_t v = 0; v < nv; ++v )
+            {
+                ends.clear();
+
+                for( const uid_t *h = rows.row_begin( v ); h != rows.row_end( v ); ++h )
+                    ends.push_back( std::make_pair( Tris[*h] ^ Tris[ next( *h ) ] ^ uid_t( v ), *h ) );
+
+                std::sort( ends.begin(), ends.end() );
+
+                for( std::size_t i = 0; i < ends.size(); )
+                {
+                    std::size_t j = i + 1;
+                    while( j < ends.size() && ends[j].first == ends[i].first )
+                        ++j;
+
+                    const uid_t h0 = ends[i].second, h1 = ends[i+1 < j ? i+1 : i].second;
+
+                    if( j - i == 2 && Tris[h0] != Tris[h1] )
+                    {
+                        const bool feature = math::dot( normals[ h0 / 3 ], normals[ h1 / 3 ] ) < feature_cos;
+                        connect( h0, h1, feature ? 1 : 0 );
+                    }
+                    else
+                    {
+                        //boundary edges, and non manifold or inconsistently oriented ones that lock their vertices
+                        for( std::size_t k = i; k < j; ++k )
+                            Sharp[ ends[k].second ] = (j - i == 1) ? 1 : 2;
+                    }
+
+                    i = j;
+                }
+            }
+        }
+
+        index_rows corners;
+        group_by_key( Tris, nv, corners, Threads );
+
+        VertexHalfedge.assign( nv, NO_ID );
+        Valence.assign( nv, 0 );
+        Fixed.assign( nv, 0 );
+        Boundary.assign( nv, 0 );
+        Locked.assign( nv, 0 );
+        Removed.assign( nv, 0 );
+        Marked.assign( nv, 0 );
+
+        double length = 0.0;
+        std::ptrdiff_t edges = 0;
+
+        #pragma omp parallel num_threads( Threads ) reduction(+:length,edges)
+        {
+            std::vector< uid_t > hs;
+
+            #pragma omp for schedule(dynamic,1024)
+            for( std::ptrdiff_t v = 0; v < nv; ++v )
+            {
+                const std::size_t n = corners.row_size( v );
+
+                if( n == 0 )
+                {
+                    Locked[v] = 1;
+                    continue;
+                }
+
+                VertexHalfedge[v] = corners.row_begin( v )[0];
+
+                for( const uid_t *h = corners.row_begin( v ); h != corners.row_end( v ); ++h )
+                {
+                    const char in = Sharp[ prev( *h ) ], out = Sharp[*h];
+
+                    if( in || out )
+                        Fixed[v] = 1;
+
+                    if( in == 2 || out == 2 )
+                        Locked[v] = 1;
+
+                    if( Opposite[*h] == NO_ID || Opposite[ prev( *h ) ] == NO_ID )
+                        Boundary[v] = 1;
+
+                    if( Opposite[*h] == NO_ID || Tris[ next( *h ) ] < uid_t( v ) )
+                    {
+                        length += std::sqrt( length2( *h ) );
+                        ++edges;
+                    }
+                }
+
+                //a vertex with more than one fan of faces is pinched
+                const bool closed = ring( uid_t( v ), hs );
+
+                if( hs.size() != n )
+                    Locked[v] = 1;
+
+                Valence[v] = uid_t( closed ? n : n + 1 );
+            }
+        }
+
+        Length = (Options.target_length > 0.0) ? Options.target_length : (edges ? length / double( edges ) : 0.0);
+        High2 = (4.0 / 3.0) * (4.0 / 3.0) * Length * Length;
+        Low2 = (4.0 / 5.0) * (4.0 / 5.0) * Length * Length;
+    }
+
+    remesh_options Options;
+    int Threads;
+    remesh_stats Stats;
+
+    //!the input surface for the projection
+    face_bvh< Real > Surface;
+
+    //!the target length and the squared split and collapse lengths
+    double Length, High2, Low2;
+
+    std::vector< point_t > Points;
+
+    //!three vertex indices per face
+    std::vector< uid_t > Tris;
+    std::vector< char > FaceAlive;
+    std::size_t FacesAlive;
+
+    //!the opposite of every half edge, NO_ID on the boundary and on non manifold edges
+    std::vector< uid_t > Opposite;
+
+    //!1 on the boundary and the feature edges, 2 on non manifold edges
+    std::vector< char > Sharp;
+
+    //!the half edges already in the list of the next round
+    std::vector< char > Queued;
+
+    //!a half edge that leaves every vertex
+    std::vector< uid_t > VertexHalfedge;
+    std::vector< uid_t > Valence;
+
+    //!the vertices on sharp edges are not moved, the locked ones are not touched at all
+    std::vector< char > Fixed;
+    std::vector< char > Boundary;
+    std::vector< char > Locked;
+    std::vector< char > Removed;
+
+    //!the vertices changed by the last round
+    std::vector< char > Marked;
+
+    //!the smallest key of the candidates of a round that need every vertex
+    std::vector< boost::uint64_t > Claims;
+};
+
+/*!
+\brief Remeshes a surface to triangles with edges of about the same length
+\param m the mesh
+\param options the remeshing options
+\return the number of operations applied
+
+The polygons are triangulated first. The mesh is rebuilt once at the end, the kept vertices 
+keep their objects and the new ones follow them.
+*/
+template<typename MeshType>
+remesh_stats remesh( MeshType &m, const remesh_options &options = remesh_options() )
+{
+    indexed_mesh< typename MeshType::real_t > im;
+    make_indexed( m, im, options.threads );
+
+    isotropic_remesher< typename MeshType::real_t > remesher( im, options );
+    remesher.run();
+    remesher.apply( m );
+
+    return remesher.stats();
+}
+
+}
+
+}
+
+#endif
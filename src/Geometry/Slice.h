@@ -0,0 +1,338 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_SLICE_H
+#define GEOMETRY_SLICE_H
+
+#include "Indexed.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Cross section of a mesh with a plane
+
+The polylines are stored back to back, polyline i runs over points[start[i]] up to 
+points[start[i+1]]. Every point is on an edge of the mesh, the faces between two consecutive 
+points are crossed by the segment that joins them.
+*/
+template<typename Real>
+struct cross_section
+{
+    typedef math::vec3< Real > point_t;
+
+    //!the points of the polylines
+    std::vector< point_t > points;
+
+    //!the id of the edge cut at every point, for a point on a vertex one of the cut edges of the vertex
+    std::vector< uid_t > edges;
+
+    //!offsets of the polylines in points, polylines_size() + 1 entries
+    std::vector< uid_t > start;
+
+    //!1 for the closed polylines, their last point connects to the first
+    std::vector< unsigned char > closed;
+
+    std::size_t polylines_size()const { return start.empty() ? 0 : start.size() - 1; }
+
+    //!number of points of polyline i
+    std::size_t polyline_size( std::size_t i )const { return start[i+1] - start[i]; }
+
+    void clear()
+    {
+        points.clear();
+        edges.clear();
+        start.assign( 1, 0 );
+        closed.clear();
+    }
+};
+
+//!the cut point of edge e, the edge itself or edges_size() + v when its upper vertex v is on the plane
+template<typename Real>
+uid_t cut_key( const indexed_mesh< Real > &im, const std::vector< double > &height, uid_t e, double d )
+{
+    const uid_t v0 = im.edge_verts[ 2 * e ], v1 = im.edge_verts[ 2 * e + 1 ];
+    const uid_t v = (height[v0] >= d) ? v0 : v1;
+
+    return (height[v] == d) ? uid_t( im.edges_size() + v ) : e;
+}
+
+//!the point where the plane at height d along the normal cuts the edge or the vertex of a cut_key
+template<typename Real>
+math::vec3< Real > cut_point( const indexed_mesh< Real > &im, const std::vector< double > &height, uid_t key, double d )
+{
+    typedef math::vec3< double > dvec_t;
+
+    if( key >= im.edges_size() )
+        return im.points[ key - im.edges_size() ];
+
+    const uid_t e = key;
+    const uid_t v0 = im.edge_verts[ 2 * e ], v1 = im.edge_verts[ 2 * e + 1 ];
+    const double t = (d - height[v0]) / (height[v1] - height[v0]);
+
+    const dvec_t p0( im.points[v0].x, im.points[v0].y, im.points[v0].z );
+    const dvec_t p1( im.points[v1].x, im.points[v1].y, im.points[v1].z );
+    const dvec_t x = p0 + t * (p1 - p0);
+
+    return math::vec3< Real >( Real( x.x ), Real( x.y ), Real( x.z ) );
+}
+
+/*!
+\brief Slices an indexed mesh with parallel planes
+\param im the indexed mesh
+\param normal the common normal of the planes
+\param offsets the planes dot(p,normal) = offset, as in clip_line_to_plane
+\param sections the cross section of every plane in the order of the offsets
+\param threads number of threads, 0 for the default
+
+The planes are sorted by offset and every face finds the planes between its lowest and highest 
+vertex with two binary searches, so the cost is O(F log P) plus the size of the output instead 
+of F times P. The cut faces are then grouped by plane and every plane chains its own segments 
+in parallel. A vertex that lies on a plane counts as above it, so every face is cut an even 
+number of times, and the cuts of the edges of the vertex are keyed by the vertex so the plane 
+gives one point there. The faces that only touch the plane at a vertex add nothing and the 
+polylines walk through such vertices. Within a face a downward cut is joined to the next cut 
+along the boundary, the closed polylines of a closed mesh with outward faces turn 
+counterclockwise looking down the normal. At tjoin edges and at vertices where the plane 
+touches several sheets the polylines follow the first unused segment.
+*/
+template<typename Real>
+void slice( const indexed_mesh< Real > &im, const math::vec3< Real > &normal, 
+            const std::vector< double > &offsets, std::vector< cross_section< Real > > &sections, int threads = 0 )
+{
+    typedef math::vec3< double > dvec_t;
+    const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+    const std::ptrdiff_t np = std::ptrdiff_t( offsets.size() );
+
+    threads = parallel_threads( threads );
+
+    //the planes in increasing offset
+    std::vector< std::pair< double, uid_t > > planes( np );
+
+    for( std::ptrdiff_t p = 0; p < np; ++p )
+        planes[p] = std::make_pair( offsets[p], uid_t( p ) );
+
+    std::sort( planes.begin(), planes.end() );
+
+    std::vector< double > levels( np );
+
+    for( std::ptrdiff_t p = 0; p < np; ++p )
+        levels[p] = planes[p].first;
+
+    //the height of every vertex along the normal
+    const dvec_t n( normal.x, normal.y, normal.z );
+    std::vector< double > height( nv );
+
+    #pragma omp parallel for num_threads( threads ) schedule(static)
+    for( std::ptrdiff_t v = 0; v < nv; ++v )
+        height[v] = math::dot( dvec_t( im.points[v].x, im.points[v].y, im.points[v].z ), n );
+
+    //a face from lo to hi is cut by the planes with lo < offset <= hi
+    std::vector< uid_t > first( nf ), cut_start( nf + 1, 0 );
+
+    #pragma omp parallel for num_threads( threads ) schedule(static)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+    {
+        double h0 = std::numeric_limits< double >::max(), h1 = -std::numeric_limits< double >::max();
+
+        for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+        {
+            h0 = std::min( h0, height[ im.face_verts[k] ] );
+            h1 = std::max( h1, height[ im.face_verts[k] ] );
+        }
+
+        const std::size_t lo = std::upper_bound( levels.begin(), levels.end(), h0 ) - levels.begin();
+        const std::size_t hi = (h1 > h0) ? std::upper_bound( levels.begin() + lo, levels.end(), h1 ) - levels.begin() : lo;
+
+        first[f] = uid_t( lo );
+        cut_start[f+1] = uid_t( hi - lo );
+    }
+
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+        cut_start[f+1] += cut_start[f];
+
+    std::vector< uid_t > cut_plane( cut_start.back() ), cut_face( cut_start.back() );
+
+    #pragma omp parallel for num_threads( threads ) schedule(static)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+    {
+        for( uid_t c = cut_start[f], p = first[f]; c < cut_start[f+1]; ++c, ++p )
+        {
+            cut_plane[c] = p;
+            cut_face[c] = uid_t( f );
+        }
+    }
+
+    //the faces cut by every plane in increasing face id
+    index_rows plane_cuts;
+    group_by_key( cut_plane, np, plane_cuts, threads );
+
+    sections.resize( np );
+
+    #pragma omp parallel num_threads( threads )
+    {
+        //the segments of the plane in the faces, from the cut key of a downward cut to the next cut 
+        //with the edges of the two cuts
+        typedef std::pair< std::pair< uid_t, uid_t >, std::pair< uid_t, uid_t > > segment_t;
+
+        std::vector< segment_t > segments;
+        std::vector< uid_t > to;
+        std::vector< unsigned char > follows, used;
+
+        #pragma omp for schedule(dynamic,1)
+        for( std::ptrdiff_t p = 0; p < np; ++p )
+        {
+            cross_section< Real > &s = sections[ planes[p].second ];
+            const double d = levels[p];
+
+            s.clear();
+            segments.clear();
+
+            for( const uid_t *c = plane_cuts.row_begin( p ); c != plane_cuts.row_end( p ); ++c )
+            {
+                const uid_t f = cut_face[*c];
+                const uid_t *fv = &im.face_verts[0] + im.face_start[f];
+                const uid_t *fe = &im.face_edges[0] + im.face_start[f];
+                const std::size_t m = im.face_size( f );
+
+                for( std::size_t j = 0; j < m; ++j )
+                {
+                    if( !(height[ fv[j] ] >= d && height[ fv[ (j + 1) % m ] ] < d) )
+                        continue;
+
+                    std::size_t jj = (j + 1) % m;
+                    while( (height[ fv[jj] ] >= d) == (height[ fv[ (jj + 1) % m ] ] >= d) )
+                        jj = (jj + 1) % m;
+
+                    //both cuts on the same vertex, the face only touches the plane
+                    const uid_t a = cut_key( im, height, fe[j], d ), b = cut_key( im, height, fe[jj], d );
+                    if( a == b )
+                        continue;
+
+                    segments.push_back( segment_t( std::make_pair( a, b ), std::make_pair( fe[j], fe[jj] ) ) );
+                }
+            }
+
+            std::sort( segments.begin(), segments.end() );
+
+            const std::size_t n = segments.size();
+
+            //the first segment that starts at the key where every segment ends, and the segments 
+            //that some other one leads to
+            to.resize( n );
+            follows.assign( n, 0 );
+
+            for( std::size_t i = 0; i < n; ++i )
+            {
+                const uid_t key = segments[i].first.second;
+                const segment_t least( std::make_pair( key, uid_t( 0 ) ), std::make_pair( uid_t( 0 ), uid_t( 0 ) ) );
+
+                to[i] = uid_t( std::lower_bound( segments.begin(), segments.end(), least ) - segments.begin() );
+
+                for( std::size_t k = to[i]; k < n && segments[k].first.first == key; ++k )
+                    follows[k] = 1;
+            }
+
+            //the open polylines start at the segments nothing leads to, the closed ones are what is left
+            used.assign( n, 0 );
+
+            for( int pass = 0; pass < 2; ++pass )
+            {
+                for( std::size_t i = 0; i < n; ++i )
+                {
+                    if( used[i] || (pass == 0 && follows[i]) )
+                        continue;
+
+                    std::size_t j = i;
+
+                    for( ;; )
+                    {
+                        s.points.push_back( cut_point( im, height, segments[j].first.first, d ) );
+                        s.edges.push_back( segments[j].second.first );
+                        used[j] = 1;
+
+                        //a segment continues with an unused one from the key where it ends
+                        const uid_t key = segments[j].first.second;
+                        std::size_t k = to[j];
+
+                        while( k < n && segments[k].first.first == key && used[k] )
+                            ++k;
+
+                        if( k == n || segments[k].first.first != key )
+                            break;
+
+                        j = k;
+                    }
+
+                    //the open polylines also end on a cut
+                    const bool closed = segments[j].first.second == segments[i].first.first;
+
+                    if( !closed )
+                    {
+                        s.points.push_back( cut_point( im, height, segments[j].first.second, d ) );
+                        s.edges.push_back( segments[j].second.second );
+                    }
+
+                    s.start.push_back( uid_t( s.points.size() ) );
+                    s.closed.push_back( closed ? 1 : 0 );
+                }
+            }
+        }
+    }
+}
+
+/*!
+\brief Slices a mesh with parallel planes
+\param m the mesh
+\param normal the common normal of the planes
+\param offsets the planes dot(p,normal) = offset
+\param sections the cross section of every plane in the order of the offsets
+\param threads number of threads, 0 for the default
+*/
+template<typename MeshType>
+void slice( const MeshType &m, const math::vec3< typename MeshType::real_t > &normal, 
+            const std::vector< double > &offsets, std::vector< cross_section< typename MeshType::real_t > > &sections, int threads = 0 )
+{
+    indexed_mesh< typename MeshType::real_t > im;
+    make_indexed( m, im, threads );
+
+    slice( im, normal, offsets, sections, threads );
+}
+
+}
+
+}
+
+#endif
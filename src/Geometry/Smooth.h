@@ -0,0 +1,338 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_SMOOTH_H
+#define GEOMETRY_SMOOTH_H
+
+#include "Indexed.h"
+#include "Parallel.h"
+#include "../Math/Simd.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Weights of the neighbours in the Laplacian
+enum smooth_weights
+{
+    //!every neighbour counts the same
+    SMOOTH_UNIFORM,
+
+    //!cotangents of the angles opposite to the edge, the centroid stands for the opposite vertex of a polygon
+    SMOOTH_COTANGENT
+};
+
+//!Options of the Laplacian smoothing
+struct smooth_options
+{
+    smooth_options() : weights(SMOOTH_UNIFORM), lambda(1.0), mu(0.0), threads(0) {}
+
+    smooth_weights weights;
+
+    //!fraction of the way to the weighted centroid that a vertex moves, 1 moves it to the centroid
+    double lambda;
+
+    //!factor of the second, shrink compensating step of Taubin smoothing, 0 disables it
+    double mu;
+
+    //!number of threads, 0 for the default
+    int threads;
+};
+
+/*!
+\brief Jacobi Laplacian smoothing on flat buffers
+
+The neighbours and their normalized weights are stored in compressed rows and the coordinates
+in one array per axis. Every step gathers the weighted centroids into a second set of arrays 
+and then blends them with the old positions, so the result does not depend on the vertex order 
+or the number of threads. The vertices of the boundary and the non-manifold edges do not move.
+*/
+template<typename Real>
+class laplacian_smoother
+{
+public:
+    typedef indexed_mesh< Real > indexed_mesh_t;
+    typedef typename indexed_mesh_t::point_t point_t;
+
+    laplacian_smoother( const indexed_mesh_t &im, smooth_weights weights, int threads ) : Threads( threads )
+    {
+        init( im, weights );
+    }
+
+    //!moves every free vertex by factor times the way to its weighted centroid
+    void step( double factor )
+    {
+        gather();
+        blend( factor );
+
+        X.swap( NX );
+        Y.swap( NY );
+        Z.swap( NZ );
+    }
+
+    //!applies the plain (mu = 0) or the Taubin steps
+    void run( int iterations, double lambda, double mu )
+    {
+        for( int i = 0; i < iterations; ++i )
+        {
+            step( lambda );
+
+            if( mu != 0.0 )
+                step( mu );
+        }
+    }
+
+    point_t point( std::size_t v )const { return point_t( Real( X[v] ), Real( Y[v] ), Real( Z[v] ) ); }
+
+    bool locked( std::size_t v )const { return Free[v] == 0.0; }
+
+private:
+    void init( const indexed_mesh_t &im, smooth_weights weights )
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( im.verts_size() );
+        const std::ptrdiff_t ne = std::ptrdiff_t( im.edges_size() );
+
+        index_rows edge_corners;
+        group_by_key( im.face_edges, ne, edge_corners, Threads );
+        group_by_key( im.edge_verts, nv, Neighbours, Threads );
+
+        std::vector< double > edge_weight( ne, 1.0 );
+
+        if( weights == SMOOTH_COTANGENT )
+            cotangents( im, edge_corners, edge_weight );
+
+        Weights.resize( Neighbours.items.size() );
+        Free.resize( nv );
+        X.resize( nv ); Y.resize( nv ); Z.resize( nv );
+        NX.resize( nv ); NY.resize( nv ); NZ.resize( nv );
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+        {
+            X[v] = im.points[v].x;
+            Y[v] = im.points[v].y;
+            Z[v] = im.points[v].z;
+
+            const uid_t begin = Neighbours.start[v], end = Neighbours.start[v+1];
+            bool lock = begin == end;
+            double total = 0.0;
+
+            //the rows hold edge ends, the other end of k is k^1 and its edge is k/2
+            for( uid_t i = begin; i < end; ++i )
+            {
+                const uid_t k = Neighbours.items[i];
+
+                lock = lock || edge_corners.row_size( k / 2 ) != 2;
+                Weights[i] = edge_weight[ k / 2 ];
+                total += Weights[i];
+            }
+
+            for( uid_t i = begin; i < end; ++i )
+            {
+                Neighbours.items[i] = im.edge_verts[ Neighbours.items[i] ^ 1 ];
+                Weights[i] = total > 0.0 ? Weights[i] / total : 1.0 / double( end - begin );
+            }
+
+            Free[v] = lock ? 0.0 : 1.0;
+        }
+    }
+
+    //!sum of the cotangents of the angles opposite to every edge, the negative sums are clamped to zero
+    void cotangents( const indexed_mesh_t &im, const index_rows &edge_corners, std::vector< double > &edge_weight )const
+    {
+        std::vector< uid_t > corner_face( im.face_verts.size() );
+
+        #pragma omp parallel num_threads( parallel_threads( Threads ) )
+        {
+            #pragma omp for schedule(static)
+            for( std::ptrdiff_t f = 0; f < std::ptrdiff_t( im.faces_size() ); ++f )
+                for( uid_t k = im.face_start[f]; k < im.face_start[f+1]; ++k )
+                    corner_face[k] = uid_t( f );
+
+            #pragma omp for schedule(static)
+            for( std::ptrdiff_t e = 0; e < std::ptrdiff_t( im.edges_size() ); ++e )
+            {
+                const point_t &a = im.points[ im.edge_verts[ 2 * e ] ];
+                const point_t &b = im.points[ im.edge_verts[ 2 * e + 1 ] ];
+                double w = 0.0;
+
+                for( const uid_t *c = edge_corners.row_begin( e ); c != edge_corners.row_end( e ); ++c )
+                {
+                    const uid_t f = corner_face[*c], s = im.face_start[f], n = uid_t( im.face_size( f ) );
+                    point_t o( 0.0 );
+
+                    if( n == 3 )
+                        o = im.points[ im.face_verts[ s + (*c - s + 2) % 3 ] ];
+                    else
+                    {
+                        for( uid_t k = s; k < s + n; ++k )
+                            o += im.points[ im.face_verts[k] ];
+                        o /= Real( n );
+                    }
+
+                    const point_t u = a - o, v = b - o;
+                    const double sine = math::magnitude( math::cross( u, v ) );
+
+                    if( sine > 0.0 )
+                        w += math::dot( u, v ) / sine;
+                }
+
+                edge_weight[e] = std::max( w, 0.0 );
+            }
+        }
+    }
+
+    //!weighted centroids of the neighbours into the second buffers
+    void gather()
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( X.size() );
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(dynamic,4096)
+        for( std::ptrdiff_t v = 0; v < nv; ++v )
+        {
+            double x = 0.0, y = 0.0, z = 0.0;
+
+            for( uid_t i = Neighbours.start[v]; i < Neighbours.start[v+1]; ++i )
+            {
+                const uid_t n = Neighbours.items[i];
+                const double w = Weights[i];
+
+                x += w * X[n];
+                y += w * Y[n];
+                z += w * Z[n];
+            }
+
+            NX[v] = x;
+            NY[v] = y;
+            NZ[v] = z;
+        }
+    }
+
+    //!new = old + factor * free * (centroid - old), two vertices per SSE2 register
+    void blend( double factor )
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( X.size() );
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+        for( std::ptrdiff_t b = 0; b < (nv + 1023) / 1024; ++b )
+        {
+            const std::ptrdiff_t begin = b * 1024, end = std::min( nv, begin + 1024 );
+            std::ptrdiff_t v = begin;
+
+#ifdef ARCH_SSE
+            const __m128d f = _mm_set1_pd( factor );
+
+            for( ; v + 2 <= end; v += 2 )
+            {
+                const __m128d t = _mm_mul_pd( f, _mm_loadu_pd( &Free[v] ) );
+
+                blend( &X[v], &NX[v], t );
+                blend( &Y[v], &NY[v], t );
+                blend( &Z[v], &NZ[v], t );
+            }
+#endif
+            for( ; v < end; ++v )
+            {
+                const double t = factor * Free[v];
+
+                NX[v] = X[v] + t * (NX[v] - X[v]);
+                NY[v] = Y[v] + t * (NY[v] - Y[v]);
+                NZ[v] = Z[v] + t * (NZ[v] - Z[v]);
+            }
+        }
+    }
+
+#ifdef ARCH_SSE
+    static void blend( const double *p, double *c, __m128d t )
+    {
+        const __m128d old = _mm_loadu_pd( p );
+        _mm_storeu_pd( c, _mm_add_pd( old, _mm_mul_pd( t, _mm_sub_pd( _mm_loadu_pd( c ), old ) ) ) );
+    }
+#endif
+
+    int Threads;
+
+    //!neighbours of every vertex and their weights, the weights of a row add up to 1
+    index_rows Neighbours;
+    std::vector< double > Weights;
+
+    //!1 for the vertices that move, 0 for the locked ones
+    std::vector< double > Free;
+
+    std::vector< double > X, Y, Z, NX, NY, NZ;
+};
+
+/*!
+\brief Laplacian smoothing of a mesh
+\param m the mesh
+\param iterations the number of smoothing iterations
+\param options the smoothing options
+\return the number of vertices that moved
+
+The locked vertices, the neighbours and the weights are computed once from the mesh as it is 
+before smoothing. With mu set to a negative value slightly larger in magnitude than lambda 
+(for example lambda 0.5 and mu -0.53) every iteration is a Taubin step that does not shrink 
+the surface.
+*/
+template<typename MeshType>
+std::size_t smooth( MeshType &m, int iterations, const smooth_options &options = smooth_options() )
+{
+    typedef typename MeshType::real_t real_t;
+
+    indexed_mesh< real_t > im;
+    make_indexed( m, im, options.threads );
+
+    laplacian_smoother< real_t > smoother( im, options.weights, options.threads );
+    smoother.run( iterations, options.lambda, options.mu );
+
+    typename MeshType::vertex_iterator_t vb = m.verts_begin();
+    const std::ptrdiff_t nv = std::ptrdiff_t( m.verts_size() );
+    std::size_t moved = 0;
+
+    #pragma omp parallel for num_threads( parallel_threads( options.threads ) ) schedule(static) reduction(+:moved)
+    for( std::ptrdiff_t i = 0; i < nv; ++i )
+    {
+        const uid_t v = vb[i]->id();
+
+        if( smoother.locked( v ) )
+            continue;
+
+        m.set_point( vb[i], smoother.point( v ) );
+        ++moved;
+    }
+
+    return moved;
+}
+
+}
+
+}
+
+#endif
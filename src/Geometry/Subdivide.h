@@ -0,0 +1,518 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_SUBDIVIDE_H
+#define GEOMETRY_SUBDIVIDE_H
+
+#include "Algorithms.h"
+#include "Indexed.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+//!Subdivision schemes
+enum subdivide_scheme
+{
+    //!interpolating, the vertices stay and the edge points follow Hermite curves between the vertex normals
+    SUBDIVIDE_HERMITE,
+
+    //!approximating scheme of Loop for triangle meshes
+    SUBDIVIDE_LOOP,
+
+    //!approximating scheme of Catmull and Clark, every face is split in quads
+    SUBDIVIDE_CATMULL_CLARK
+};
+
+//!Options of the subdivision
+struct subdivide_options
+{
+    subdivide_options() : scheme(SUBDIVIDE_LOOP), levels(1), threads(0) {}
+
+    subdivide_scheme scheme;
+
+    //!number of times the subdivision is applied
+    int levels;
+
+    //!number of threads, 0 for the default
+    int threads;
+};
+
+/*!
+\brief One level of subdivision of an indexed mesh
+
+Every edge gets a new point and the faces that are not split in four triangles get a point in 
+the middle. The new points are numbered after the vertices, the edge point of edge e is 
+verts_size() + e and the face points follow them, so every face of the input knows in advance 
+where its points, faces and edges go in the output and all the passes run in parallel.
+
+The triangles are split in four triangles, the other faces in quads around their face point. 
+Catmull-Clark splits the triangles in quads too. The edges that do not have exactly two faces 
+are creases, a vertex on two creases moves along them and a vertex on more is kept fixed.
+*/
+template<typename Real>
+class subdivision
+{
+public:
+    typedef Real real_t;
+    typedef indexed_mesh< Real > indexed_mesh_t;
+    typedef typename indexed_mesh_t::point_t point_t;
+
+    subdivision( const indexed_mesh_t &in, subdivide_scheme scheme, int threads ) : 
+        In( in ), Scheme( scheme ), Threads( threads )
+    {
+    }
+
+    //!builds the subdivided mesh in out
+    void apply( indexed_mesh_t &out )
+    {
+        init();
+        points( out );
+        topology( out );
+    }
+
+private:
+    //!first output edge of the half of edge e that starts at vertex v
+    uid_t half( uid_t e, uid_t v )const
+    {
+        return In.edge_verts[ 2 * e ] == v ? 2 * e : 2 * e + 1;
+    }
+
+    uid_t edge_point( uid_t e )const { return In.verts_size() + e; }
+    uid_t face_point( uid_t f )const { return In.verts_size() + In.edges_size() + FacePoint[f]; }
+
+    //!a face gets a face point unless it is split in four triangles
+    bool centered( std::size_t n )const
+    {
+        return n >= 3 && (n != 3 || Scheme == SUBDIVIDE_CATMULL_CLARK);
+    }
+
+    void init()
+    {
+        const std::size_t nf = In.faces_size();
+
+        CornerFace.resize( In.face_verts.size() );
+
+        #pragma omp parallel for num_threads( parallel_threads( Threads ) ) schedule(static)
+        for( std::ptrdiff_t f = 0; f < std::ptrdiff_t( nf ); ++f )
+            for( uid_t k = In.face_start[f]; k < In.face_start[f+1]; ++k )
+                CornerFace[k] = uid_t( f );
+
+        group_by_key( In.face_edges, In.edges_size(), EdgeCorners, Threads );
+        group_by_key( In.face_verts, In.verts_size(), VertCorners, Threads );
+        group_by_key( In.edge_verts, In.verts_size(), VertEnds, Threads );
+
+        //offsets of the output of every face
+        FacePoint.resize( nf );
+        OutFace.resize( nf + 1 );
+        OutCorner.resize( nf + 1 );
+        OutEdge.resize( nf + 1 );
+        OutFace[0] = OutCorner[0] = OutEdge[0] = 0;
+
+        uid_t face_points = 0;
+
+        for( std::size_t f = 0; f < nf; ++f )
+        {
+            const std::size_t n = In.face_size( f );
+
+            FacePoint[f] = face_points;
+
+            if( centered( n ) )
+            {
+                ++face_points;
+                OutFace[f+1] = OutFace[f] + n;
+                OutCorner[f+1] = OutCorner[f] + 4 * n;
+                OutEdge[f+1] = OutEdge[f] + n;
+            }
+            else if( n == 3 )
+            {
+                OutFace[f+1] = OutFace[f] + 4;
+                OutCorner[f+1] = OutCorner[f] + 12;
+                OutEdge[f+1] = OutEdge[f] + 3;
+            }
+            else
+            {
+                OutFace[f+1] = OutFace[f];
+                OutCorner[f+1] = OutCorner[f];
+                OutEdge[f+1] = OutEdge[f];
+            }
+        }
+
+        FacePoints = face_points;
+    }
+
+    bool crease( uid_t e )const { return EdgeCorners.row_size( e ) != 2; }
+
+    void points( indexed_mesh_t &out )
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( In.verts_size() );
+        const std::ptrdiff_t ne = std::ptrdiff_t( In.edges_size() );
+        const std::ptrdiff_t nf = std::ptrdiff_t( In.faces_size() );
+
+        out.points.resize( nv + ne + FacePoints );
+
+        if( Scheme == SUBDIVIDE_HERMITE )
+            vertex_normals();
+
+        #pragma omp parallel num_threads( parallel_threads( Threads ) )
+        {
+            //the face points are the centroids, the edge and vertex rules of Catmull-Clark use them
+            #pragma omp for schedule(static)
+            for( std::ptrdiff_t f = 0; f < nf; ++f )
+            {
+                const std::size_t n = In.face_size( f );
+
+                if( !centered( n ) )
+                    continue;
+
+                point_t c( 0.0 );
+                for( uid_t k = In.face_start[f]; k < In.face_start[f+1]; ++k )
+                    c += In.points[ In.face_verts[k] ];
+
+                out.points[ face_point( f ) ] = c / real_t( n );
+            }
+
+            #pragma omp for schedule(static)
+            for( std::ptrdiff_t e = 0; e < ne; ++e )
+                out.points[ edge_point( e ) ] = edge_rule( e, out );
+
+            #pragma omp for schedule(static) nowait
+            for( std::ptrdiff_t v = 0; v < nv; ++v )
+                out.points[v] = vertex_rule( v, out );
+
+            //the Hermite face points are the centroids of the corners and the edge points
+            if( Scheme == SUBDIVIDE_HERMITE )
+            {
+                #pragma omp for schedule(static)
+                for( std::ptrdiff_t f = 0; f < nf; ++f )
+                {
+                    const std::size_t n = In.face_size( f );
+
+                    if( !centered( n ) )
+                        continue;
+
+                    point_t c = out.points[ face_point( f ) ] * real_t( n );
+                    for( uid_t k = In.face_start[f]; k < In.face_start[f+1]; ++k )
+                        c += out.points[ edge_point( In.face_edges[k] ) ];
+
+                    out.points[ face_point( f ) ] = c / real_t( 2 * n );
+                }
+            }
+        }
+    }
+
+    //!area weighted vertex normals
+    void vertex_normals()
+    {
+        const std::ptrdiff_t nv = std::ptrdiff_t( In.verts_size() );
+        const std::ptrdiff_t nf = std::ptrdiff_t( In.faces_size() );
+
+        std::vector< point_t > areas( nf );
+        Normals.resize( nv );
+
+        #pragma omp parallel num_threads( parallel_threads( Threads ) )
+        {
+            #pragma omp for schedule(static)
+            for( std::ptrdiff_t f = 0; f < nf; ++f )
+            {
+                const uid_t s = In.face_start[f], n = uid_t( In.face_size( f ) );
+                point_t a( 0.0 );
+
+                for( uid_t k = 0; k < n; ++k )
+                    a += math::cross( In.points[ In.face_verts[ s + k ] ], In.points[ In.face_verts[ s + (k + 1) % n ] ] );
+
+                areas[f] = a;
+            }
+
+            #pragma omp for schedule(static)
+            for( std::ptrdiff_t v = 0; v < nv; ++v )
+            {
+                point_t n( 0.0 );
+                for( const uid_t *c = VertCorners.row_begin( v ); c != VertCorners.row_end( v ); ++c )
+                    n += areas[ CornerFace[*c] ];
+
+                const real_t len = math::magnitude( n );
+                Normals[v] = len > real_t( 0.0 ) ? n / len : n;
+            }
+        }
+    }
+
+    //!the point of face f opposite to edge corner c for the Loop edge rule, the centroid for polygons
+    point_t opposite( uid_t c, const indexed_mesh_t &out )const
+    {
+        const uid_t f = CornerFace[c];
+
+        if( In.face_size( f ) != 3 )
+            return out.points[ face_point( f ) ];
+
+        const uid_t s = In.face_start[f];
+        return In.points[ In.face_verts[ s + (c - s + 2) % 3 ] ];
+    }
+
+    point_t edge_rule( uid_t e, const indexed_mesh_t &out )const
+    {
+        const uid_t a = In.edge_verts[ 2 * e ], b = In.edge_verts[ 2 * e + 1 ];
+        const point_t &pa = In.points[a], &pb = In.points[b];
+
+        if( Scheme == SUBDIVIDE_HERMITE )
+            return hermite_point( pa, Normals[a], pb, Normals[b], real_t( 0.5 ) );
+
+        if( crease( e ) )
+            return (pa + pb) * real_t( 0.5 );
+
+        const uid_t *c = EdgeCorners.row_begin( e );
+
+        if( Scheme == SUBDIVIDE_LOOP )
+            return (pa + pb) * real_t( 0.375 ) + (opposite( c[0], out ) + opposite( c[1], out )) * real_t( 0.125 );
+
+        return (pa + pb + out.points[ face_point( CornerFace[ c[0] ] ) ] + out.points[ face_point( CornerFace[ c[1] ] ) ]) * real_t( 0.25 );
+    }
+
+    point_t vertex_rule( uid_t v, const indexed_mesh_t &out )const
+    {
+        const point_t &p = In.points[v];
+
+        if( Scheme == SUBDIVIDE_HERMITE )
+            return p;
+
+        const uid_t *begin = VertEnds.row_begin( v ), *end = VertEnds.row_end( v );
+        const std::size_t n = end - begin;
+
+        //the other end of an edge end k is k^1 and its edge is k/2
+        std::size_t creases = 0;
+        point_t crease_sum( 0.0 ), sum( 0.0 );
+
+        for( const uid_t *k = begin; k != end; ++k )
+        {
+            const point_t &q = In.points[ In.edge_verts[ *k ^ 1 ] ];
+            sum += q;
+
+            if( crease( *k / 2 ) )
+            {
+                ++creases;
+                crease_sum += q;
+            }
+        }
+
+        if( creases == 2 )
+            return p * real_t( 0.75 ) + crease_sum * real_t( 0.125 );
+
+        if( creases != 0 || n < 3 )
+            return p;
+
+        if( Scheme == SUBDIVIDE_LOOP )
+        {
+            const double w = 0.375 + 0.25 * std::cos( 2.0 * 3.14159265358979323846 / double( n ) );
+            const real_t beta = real_t( (0.625 - w * w) / double( n ) );
+
+            return p * (real_t( 1.0 ) - real_t( n ) * beta) + sum * beta;
+        }
+
+        //Catmull-Clark, (F + 2R + (n-3)P) / n with F the mean face point and R the mean edge midpoint
+        point_t faces( 0.0 );
+        for( const uid_t *c = VertCorners.row_begin( v ); c != VertCorners.row_end( v ); ++c )
+            faces += out.points[ face_point( CornerFace[*c] ) ];
+
+        faces /= real_t( VertCorners.row_size( v ) );
+
+        const point_t mid = (p + sum / real_t( n )) * real_t( 0.5 );
+
+        return (faces + mid * real_t( 2.0 ) + p * real_t( n - 3.0 )) / real_t( n );
+    }
+
+    void topology( indexed_mesh_t &out )const
+    {
+        const uid_t ne = In.edges_size();
+        const std::ptrdiff_t nf = std::ptrdiff_t( In.faces_size() );
+
+        out.face_start.resize( OutFace[nf] + 1 );
+        out.face_verts.resize( OutCorner[nf] );
+        out.face_edges.resize( OutCorner[nf] );
+        out.edge_verts.resize( 2 * (2 * ne + OutEdge[nf]) );
+        out.face_start[0] = 0;
+
+        #pragma omp parallel num_threads( parallel_threads( Threads ) )
+        {
+            //every edge is split in the half from its first vertex (2e) and from its second (2e+1)
+            #pragma omp for schedule(static)
+            for( std::ptrdiff_t e = 0; e < std::ptrdiff_t( ne ); ++e )
+            {
+                out.edge_verts[ 4 * e ]     = In.edge_verts[ 2 * e ];
+                out.edge_verts[ 4 * e + 1 ] = edge_point( e );
+                out.edge_verts[ 4 * e + 2 ] = In.edge_verts[ 2 * e + 1 ];
+                out.edge_verts[ 4 * e + 3 ] = edge_point( e );
+            }
+
+            #pragma omp for schedule(dynamic,1024)
+            for( std::ptrdiff_t f = 0; f < nf; ++f )
+            {
+                if( OutFace[f+1] == OutFace[f] )
+                    continue;
+
+                const uid_t s = In.face_start[f];
+                const uid_t n = uid_t( In.face_size( f ) );
+                const uid_t *fv = &In.face_verts[s], *fe = &In.face_edges[s];
+
+                uid_t *ov = &out.face_verts[0] + OutCorner[f];
+                uid_t *oe = &out.face_edges[0] + OutCorner[f];
+                uid_t *os = &out.face_start[0] + OutFace[f] + 1;
+                uid_t *ie = &out.edge_verts[0] + 2 * (2 * ne + OutEdge[f]);
+                const uid_t inner = 2 * ne + OutEdge[f];
+
+                if( !centered( n ) )
+                {
+                    //edge k runs from corner k to k+1, the inner edge k joins its point to the point of edge k-1
+                    for( uid_t k = 0; k < 3; ++k )
+                    {
+                        const uid_t prev = (k + 2) % 3;
+
+                        ie[ 2 * k ]     = edge_point( fe[k] );
+                        ie[ 2 * k + 1 ] = edge_point( fe[prev] );
+
+                        ov[0] = fv[k];
+                        ov[1] = edge_point( fe[k] );
+                        ov[2] = edge_point( fe[prev] );
+                        oe[0] = half( fe[k], fv[k] );
+                        oe[1] = inner + k;
+                        oe[2] = half( fe[prev], fv[k] );
+
+                        ov += 3; oe += 3;
+                        *os++ = OutCorner[f] + 3 * (k + 1);
+                    }
+
+                    for( uid_t k = 0; k < 3; ++k )
+                    {
+                        ov[k] = edge_point( fe[k] );
+                        oe[k] = inner + (k + 1) % 3;
+                    }
+
+                    *os = OutCorner[f] + 12;
+                    continue;
+                }
+
+                //the quad k has the corner k, the edge points of edges k and k-1 and the face point
+                const uid_t c = face_point( f );
+
+                for( uid_t k = 0; k < n; ++k )
+                {
+                    const uid_t prev = (k + n - 1) % n;
+
+                    ie[ 2 * k ]     = edge_point( fe[k] );
+                    ie[ 2 * k + 1 ] = c;
+
+                    ov[0] = fv[k];
+                    ov[1] = edge_point( fe[k] );
+                    ov[2] = c;
+                    ov[3] = edge_point( fe[prev] );
+                    oe[0] = half( fe[k], fv[k] );
+                    oe[1] = inner + k;
+                    oe[2] = inner + prev;
+                    oe[3] = half( fe[prev], fv[k] );
+
+                    ov += 4; oe += 4;
+                    *os++ = OutCorner[f] + 4 * (k + 1);
+                }
+            }
+        }
+    }
+
+    const indexed_mesh_t &In;
+    subdivide_scheme Scheme;
+    int Threads;
+
+    //!face of every corner of the input
+    std::vector< uid_t > CornerFace;
+
+    //!corners around every edge and every vertex, edge ends around every vertex
+    index_rows EdgeCorners, VertCorners, VertEnds;
+
+    //!index of the face point of every face among the face points
+    std::vector< uid_t > FacePoint;
+    uid_t FacePoints;
+
+    //!first output face, corner and inner edge of every input face
+    std::vector< uid_t > OutFace, OutCorner, OutEdge;
+
+    std::vector< point_t > Normals;
+};
+
+/*!
+\brief Subdivides the faces of a mesh
+\param m the mesh
+\param options the subdivision options
+\return the number of faces of the subdivided mesh
+
+All the levels are computed on indexed copies of the mesh and the mesh connectivity is rebuilt 
+once at the end. The existing vertices keep their objects and get their new coordinates, the 
+points of the edges and the faces become new vertices.
+*/
+template<typename MeshType>
+std::size_t subdivide( MeshType &m, const subdivide_options &options = subdivide_options() )
+{
+    typedef typename MeshType::real_t real_t;
+    typedef typename MeshType::vertex_t vertex_t;
+    typedef typename MeshType::vertex_ptr_t vertex_ptr_t;
+
+    indexed_mesh< real_t > im, next;
+    make_indexed( m, im, options.threads );
+
+    for( int level = 0; level < options.levels; ++level )
+    {
+        subdivision< real_t >( im, options.scheme, options.threads ).apply( next );
+        im.swap( next );
+    }
+
+    typename MeshType::vertex_array_t verts( m.verts_begin(), m.verts_end() );
+    const std::size_t old_verts = verts.size();
+
+    verts.resize( im.verts_size() );
+
+    #pragma omp parallel for num_threads( parallel_threads( options.threads ) ) schedule(static)
+    for( std::ptrdiff_t i = 0; i < std::ptrdiff_t( old_verts ); ++i )
+        m.set_point( verts[i], im.points[i] );
+
+    for( std::size_t i = old_verts; i < verts.size(); ++i )
+        verts[i] = vertex_ptr_t( new vertex_t( im.points[i] ) );
+
+    std::vector< std::size_t > sizes( im.faces_size() );
+    for( std::size_t f = 0; f < sizes.size(); ++f )
+        sizes[f] = im.face_size( f );
+
+    m.rebuild( verts, sizes, im.face_verts );
+
+    return m.faces_size();
+}
+
+}
+
+}
+
+#endif
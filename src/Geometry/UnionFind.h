@@ -0,0 +1,143 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_UNION_FIND_H
+#define GEOMETRY_UNION_FIND_H
+
+#include "Traits.h"
+#include "Parallel.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Disjoint sets that can be joined from many threads
+
+The roots are linked with a compare and swap, always the larger id under the smaller one, and 
+the paths are halved on the way up, so unite() and find() can be called concurrently without 
+locks. Once all the unions are done every set is represented by its smallest element, which 
+does not depend on the order of the unions or on the number of threads.
+*/
+class union_find
+{
+public:
+    explicit union_find( std::size_t n = 0 ) { reset( n ); }
+
+    //!makes n single element sets
+    void reset( std::size_t n )
+    {
+        Parent.resize( n );
+
+        for( std::size_t i = 0; i < n; ++i )
+            Parent[i] = uid_t( i );
+    }
+
+    std::size_t size()const { return Parent.size(); }
+
+    //!the root of the set of x
+    uid_t find( uid_t x )
+    {
+        volatile uid_t *parent = &Parent[0];
+
+        for( ;; )
+        {
+            const uid_t p = parent[x];
+
+            if( p == x )
+                return x;
+
+            const uid_t gp = parent[p];
+
+            //path halving, losing the race only leaves a longer path
+            if( p != gp )
+                compare_and_swap( parent + x, p, gp );
+
+            x = gp;
+        }
+    }
+
+    //!joins the sets of a and b
+    void unite( uid_t a, uid_t b )
+    {
+        volatile uid_t *parent = &Parent[0];
+
+        for( ;; )
+        {
+            a = find( a );
+            b = find( b );
+
+            if( a == b )
+                return;
+
+            if( a < b )
+                std::swap( a, b );
+
+            //a is the larger root, it may have been linked by another thread meanwhile
+            if( compare_and_swap( parent + a, a, b ) )
+                return;
+        }
+    }
+
+    /*!
+    \brief Numbers the sets 0, 1, ... in the order of their smallest element
+    \param label the set number of every element
+    \param threads number of threads, 0 for the default
+    \return the number of sets
+    \note must not run concurrently with unite()
+    */
+    std::size_t labels( std::vector< uid_t > &label, int threads = 0 )
+    {
+        const std::ptrdiff_t n = std::ptrdiff_t( Parent.size() );
+
+        //flatten, after this every element points to its root
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t i = 0; i < n; ++i )
+            Parent[i] = find( uid_t( i ) );
+
+        label.resize( n );
+        std::size_t sets = 0;
+
+        //the roots are the smallest elements of their sets so they are met first
+        for( std::ptrdiff_t i = 0; i < n; ++i )
+            label[i] = Parent[i] == uid_t( i ) ? uid_t( sets++ ) : label[ Parent[i] ];
+
+        return sets;
+    }
+
+private:
+    std::vector< uid_t > Parent;
+};
+
+}
+
+}
+
+#endif
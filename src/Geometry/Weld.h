@@ -0,0 +1,411 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+
+#ifndef GEOMETRY_WELD_H
+#define GEOMETRY_WELD_H
+
+#include "Indexed.h"
+#include "UnionFind.h"
+#include "Parallel.h"
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace geometry
+{
+
+/*!
+\brief Buckets of a spatial hash grid over a point set
+
+The cells are at least twice the tolerance wide, so the points within the tolerance of a point 
+lie in its own cell or in the neighbour cells across the faces nearer than the tolerance. The 
+cell size also follows the spacing the points would have on a surface filling their bounding 
+box, so a typical point is far from the faces of its cell and looks in one bucket only. The 
+cells are hashed into about one bucket per point and the buckets are kept as compressed rows, 
+two flat arrays whatever the number of points. A zero tolerance hashes the coordinates 
+themselves and only looks in the bucket of the point.
+*/
+template<typename Real>
+class weld_grid
+{
+public:
+    typedef math::vec3< Real > point_t;
+
+    weld_grid( const std::vector< point_t > &points, Real tolerance, int threads = 0 ) :
+        Points( points ), Tolerance( tolerance ), InvCell( 0.0 ), Reach( 0.0 ), Mask( 0 )
+    {
+        build( threads );
+    }
+
+    /*!
+    \brief Joins the sets of the points closer than the tolerance
+    \param sets the sets, one element per point
+    \param threads number of threads, 0 for the default
+    */
+    void unite( union_find &sets, int threads = 0 )const
+    {
+        const std::ptrdiff_t n = std::ptrdiff_t( Points.size() );
+        const Real tol2 = Tolerance * Tolerance;
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(dynamic,4096)
+        for( std::ptrdiff_t i = 0; i < n; ++i )
+        {
+            const point_t &p = Points[i];
+            uid_t buckets[8];
+            const std::size_t count = neighbour_buckets( p, buckets );
+
+            for( std::size_t b = 0; b < count; ++b )
+            {
+                for( const uid_t *j = Rows.row_begin( buckets[b] ); j != Rows.row_end( buckets[b] ); ++j )
+                {
+                    //every pair is met from both sides, the larger id joins
+                    if( *j >= uid_t( i ) )
+                        break;
+
+                    const point_t d = Points[*j] - p;
+
+                    if( d.x*d.x + d.y*d.y + d.z*d.z <= tol2 )
+                        sets.unite( uid_t( i ), *j );
+                }
+            }
+        }
+    }
+
+private:
+    void build( int threads )
+    {
+        const std::ptrdiff_t n = std::ptrdiff_t( Points.size() );
+
+        threads = parallel_threads( threads );
+
+        std::size_t size = 1;
+        while( size < Points.size() )
+            size <<= 1;
+
+        Mask = size - 1;
+
+        if( Tolerance > Real(0) && n > 0 )
+        {
+            std::vector< point_t > lo( threads, Points[0] ), hi( threads, Points[0] );
+
+            #pragma omp parallel num_threads( threads )
+            {
+                point_t &l = lo[ parallel_thread_id() ];
+                point_t &h = hi[ parallel_thread_id() ];
+
+                #pragma omp for schedule(static)
+                for( std::ptrdiff_t i = 0; i < n; ++i )
+                {
+                    const point_t &p = Points[i];
+                    l = point_t( std::min( l.x, p.x ), std::min( l.y, p.y ), std::min( l.z, p.z ) );
+                    h = point_t( std::max( h.x, p.x ), std::max( h.y, p.y ), std::max( h.z, p.z ) );
+                }
+            }
+
+            double extent = 0.0;
+            for( int t = 0; t < threads; ++t )
+            {
+                extent = std::max( extent, double( hi[t].x ) - double( lo[t].x ) );
+                extent = std::max( extent, double( hi[t].y ) - double( lo[t].y ) );
+                extent = std::max( extent, double( hi[t].z ) - double( lo[t].z ) );
+            }
+
+            const double cell = std::max( 2.0 * double( Tolerance ) * ( 1.0 + 1.0e-4 ), extent / std::sqrt( double( n ) ) );
+
+            InvCell = 1.0 / cell;
+
+            //a little more than the tolerance so that the rounding of the cell coordinates never loses a neighbour,
+            //still under half a cell so that only one side is searched on every axis
+            Reach = double( Tolerance ) * InvCell * ( 1.0 + 1.0e-6 ) + 1.0e-9;
+        }
+
+        std::vector< uid_t > keys( n );
+
+        #pragma omp parallel for num_threads( threads ) schedule(static)
+        for( std::ptrdiff_t i = 0; i < n; ++i )
+        {
+            const point_t &p = Points[i];
+
+            if( InvCell > 0.0 )
+                keys[i] = bucket( cell( p.x ), cell( p.y ), cell( p.z ) );
+            else
+                keys[i] = bucket( bits( p.x ), bits( p.y ), bits( p.z ) );
+        }
+
+        //the rows are sorted by id, unite() stops at the first larger id
+        group_by_key( keys, size, Rows, threads );
+    }
+
+    std::size_t neighbour_buckets( const point_t &p, uid_t *buckets )const
+    {
+        if( !(InvCell > 0.0) )
+        {
+            buckets[0] = bucket( bits( p.x ), bits( p.y ), bits( p.z ) );
+            return 1;
+        }
+
+        const Real x[3] = { p.x, p.y, p.z };
+        boost::int64_t c[3][2];
+        int sides[3];
+
+        for( int a = 0; a < 3; ++a )
+        {
+            const double s = double( x[a] ) * InvCell;
+            const double f = s - std::floor( s );
+
+            c[a][0] = cell( x[a] );
+            c[a][1] = f <= Reach ? c[a][0] - 1 : c[a][0] + 1;
+            sides[a] = ( f <= Reach || f >= 1.0 - Reach ) ? 2 : 1;
+        }
+
+        std::size_t count = 0;
+
+        for( int i = 0; i < sides[0]; ++i )
+        for( int j = 0; j < sides[1]; ++j )
+        for( int k = 0; k < sides[2]; ++k )
+        {
+            const uid_t b = bucket( c[0][i], c[1][j], c[2][k] );
+
+            //two cells can hash to the same bucket, scan it once
+            bool seen = false;
+            for( std::size_t q = 0; q < count && !seen; ++q )
+                seen = buckets[q] == b;
+
+            if( !seen )
+                buckets[count++] = b;
+        }
+
+        return count;
+    }
+
+    boost::int64_t cell( Real x )const
+    {
+        const double limit = 4.0e18;
+        const double s = std::floor( double( x ) * InvCell );
+
+        //coordinates far out of the grid share the border cells
+        return s > limit ? boost::int64_t( limit ) : s < -limit ? -boost::int64_t( limit ) : boost::int64_t( s );
+    }
+
+    static boost::int64_t bits( Real x )
+    {
+        //+0 and -0 are the same point
+        x += Real(0);
+
+        boost::int64_t b = 0;
+        std::memcpy( &b, &x, sizeof( Real ) < sizeof( b ) ? sizeof( Real ) : sizeof( b ) );
+        return b;
+    }
+
+    uid_t bucket( boost::int64_t x, boost::int64_t y, boost::int64_t z )const
+    {
+        boost::uint64_t h = boost::uint64_t( x ) * 0x9E3779B97F4A7C15ULL;
+        h ^= boost::uint64_t( y ) * 0xC2B2AE3D27D4EB4FULL;
+        h ^= boost::uint64_t( z ) * 0x165667B19E3779F9ULL;
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 32;
+
+        return uid_t( h & Mask );
+    }
+
+    const std::vector< point_t > &Points;
+    Real Tolerance;
+
+    //inverse of the cell size and the tolerance in cells, 0 for exact welding
+    double InvCell;
+    double Reach;
+
+    uid_t Mask;
+    index_rows Rows;
+};
+
+/*!
+\brief Splits a polygon with repeated vertices into simple loops
+\param verts the vertex ids of the polygon
+\param n the number of vertices
+\param sizes the sizes of the loops with at least three vertices are appended here
+\param indices the vertex ids of these loops are appended here
+
+A vertex met again closes the loop walked since its first visit, so a b c a d e gives the 
+faces a b c and a d e, and the repeated neighbours left by welding a short edge disappear.
+*/
+inline void split_polygon_loops( const uid_t *verts, std::size_t n, std::vector< std::size_t > &sizes, 
+                                 std::vector< uid_t > &indices )
+{
+    std::vector< uid_t > stack;
+    stack.reserve( n );
+
+    for( std::size_t i = 0; i < n; ++i )
+    {
+        std::size_t j = 0;
+        while( j < stack.size() && stack[j] != verts[i] )
+            ++j;
+
+        if( j == stack.size() )
+        {
+            stack.push_back( verts[i] );
+            continue;
+        }
+
+        //the loop from the first visit, the vertex itself stays for the rest of the polygon
+        if( stack.size() - j >= 3 )
+        {
+            sizes.push_back( stack.size() - j );
+            indices.insert( indices.end(), stack.begin() + j, stack.end() );
+        }
+
+        stack.resize( j + 1 );
+    }
+
+    if( stack.size() >= 3 )
+    {
+        sizes.push_back( stack.size() );
+        indices.insert( indices.end(), stack.begin(), stack.end() );
+    }
+}
+
+/*!
+\brief Merges the vertices closer than a tolerance
+\param m the mesh
+\param tolerance the distance under which two vertices are merged, 0 merges equal points
+\param threads number of threads, 0 for the default
+\return the number of vertices removed
+
+The points are bucketed in a weld_grid and the close pairs are joined in the lock-free 
+union_find, so the clusters are closed under the tolerance: a chain of vertices each within 
+the tolerance of the next becomes one vertex. A cluster keeps the vertex object and the 
+position of its smallest id and the kept vertices stay in order. When anything is merged the 
+faces are remapped and the mesh is rebuilt at once, the faces that collapse to fewer than 
+three vertices are dropped and the ones that touch themselves are split into simple loops. 
+The edges and faces are new objects after a rebuild, when nothing is merged the mesh is not 
+touched.
+*/
+template<typename MeshType>
+std::size_t weld_vertices( MeshType &m, typename MeshType::real_t tolerance, int threads = 0 )
+{
+    typedef typename MeshType::real_t real_t;
+    typedef typename MeshType::vertex_ptr_t vertex_ptr_t;
+    typedef typename indexed_mesh< real_t >::point_t point_t;
+
+    typename MeshType::vertex_iterator_t vb = m.verts_begin();
+    const std::ptrdiff_t nv = std::ptrdiff_t( m.verts_size() );
+
+    std::vector< uid_t > label;
+    std::size_t count = 0;
+
+    //the grid and the sets are released before the faces are copied
+    {
+        std::vector< point_t > points( nv );
+
+        #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+        for( std::ptrdiff_t i = 0; i < nv; ++i )
+            points[ vb[i]->id() ] = vb[i]->point();
+
+        union_find sets( nv );
+
+        {
+            weld_grid< real_t > grid( points, tolerance, threads );
+            grid.unite( sets, threads );
+        }
+
+        count = sets.labels( label, threads );
+    }
+
+    if( count == std::size_t( nv ) )
+        return 0;
+
+    //the smallest id of a cluster is met first
+    std::vector< vertex_ptr_t > verts( nv );
+    std::vector< vertex_ptr_t > kept;
+    kept.reserve( count );
+
+    for( std::ptrdiff_t i = 0; i < nv; ++i )
+        verts[ vb[i]->id() ] = vb[i];
+
+    for( std::ptrdiff_t i = 0; i < nv; ++i )
+        if( label[i] == kept.size() )
+            kept.push_back( verts[i] );
+
+    verts.clear();
+
+    indexed_mesh< real_t > im;
+    make_indexed( m, im, threads );
+    std::vector< uid_t >().swap( im.face_edges );
+    std::vector< uid_t >().swap( im.edge_verts );
+
+    const std::ptrdiff_t nf = std::ptrdiff_t( im.faces_size() );
+    std::vector< char > touched( nf, 0 );
+
+    #pragma omp parallel for num_threads( parallel_threads( threads ) ) schedule(static)
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+    {
+        const uid_t b = im.face_start[f], e = im.face_start[f+1];
+
+        for( uid_t k = b; k < e; ++k )
+            im.face_verts[k] = label[ im.face_verts[k] ];
+
+        for( uid_t k = b; k < e && !touched[f]; ++k )
+            for( uid_t j = b; j < k && !touched[f]; ++j )
+                touched[f] = im.face_verts[j] == im.face_verts[k];
+    }
+
+    std::vector< std::size_t > sizes;
+    std::vector< uid_t > indices;
+    sizes.reserve( nf );
+    indices.reserve( im.face_verts.size() );
+
+    for( std::ptrdiff_t f = 0; f < nf; ++f )
+    {
+        const uid_t *v = &im.face_verts[0] + im.face_start[f];
+
+        if( touched[f] )
+            split_polygon_loops( v, im.face_size( f ), sizes, indices );
+        else
+        {
+            sizes.push_back( im.face_size( f ) );
+            indices.insert( indices.end(), v, v + im.face_size( f ) );
+        }
+    }
+
+    im = indexed_mesh< real_t >();
+
+    m.rebuild( kept, sizes, indices );
+
+    return std::size_t( nv ) - count;
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,438 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+
+#ifndef MATH_CHOLESKY_H
+#define MATH_CHOLESKY_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace arch
+{
+
+namespace math
+{
+
+/*!
+\brief Sparse Cholesky factorization of a symmetric positive definite matrix
+
+The matrix is given by its full pattern in compressed columns (every column lists the rows 
+of both triangles, the diagonal included). analyze() computes a nested dissection ordering 
+from the graph of the matrix and the structure of the factor, factor() the values, so matrices 
+with the same pattern share the analysis by copying the object before factor(). The factor 
+is computed with the up-looking algorithm of Davis, Direct Methods for Sparse Linear Systems 
+(2006), row by row from the elimination tree. solve() only reads the factor, so it can run 
+for many right hand sides at once from different threads.
+*/
+class sparse_cholesky
+{
+public:
+    typedef std::size_t index_t;
+
+    sparse_cholesky() : Size(0), Factored(false) {}
+
+    //!ordering and structure of the factor for the pattern of a matrix
+    void analyze( std::size_t n, const std::vector< index_t > &start, const std::vector< index_t > &rows )
+    {
+        Size = n;
+        Factored = false;
+
+        dissect( start, rows );
+
+        Inverse.resize( n );
+        for( index_t k = 0; k < n; ++k )
+            Inverse[ Perm[k] ] = k;
+
+        //upper triangle of the permuted matrix by columns, Map gives the source of every entry
+        Cp.assign( n + 1, 0 );
+
+        for( index_t j = 0; j < n; ++j )
+            for( index_t p = start[j]; p < start[j+1]; ++p )
+            {
+                const index_t a = Inverse[ rows[p] ], b = Inverse[j];
+
+                if( a <= b )
+                    ++Cp[ b + 1 ];
+            }
+
+        for( index_t k = 0; k < n; ++k )
+            Cp[k+1] += Cp[k];
+
+        std::vector< index_t > next( Cp.begin(), Cp.end() - 1 );
+        Ci.resize( Cp.back() );
+        Map.resize( Cp.back() );
+
+        for( index_t j = 0; j < n; ++j )
+            for( index_t p = start[j]; p < start[j+1]; ++p )
+            {
+                const index_t a = Inverse[ rows[p] ], b = Inverse[j];
+
+                if( a <= b )
+                {
+                    Ci[ next[b] ] = a;
+                    Map[ next[b]++ ] = p;
+                }
+            }
+
+        tree();
+
+        //the pattern of row k of the factor is the reach of its entries in the elimination tree
+        std::vector< index_t > counts( n, 1 ), stack( n ), mark( n, none() );
+
+        for( index_t k = 0; k < n; ++k )
+            for( index_t top = reach( k, stack, mark ); top < n; ++top )
+                ++counts[ stack[top] ];
+
+        Lp.assign( n + 1, 0 );
+        for( index_t k = 0; k < n; ++k )
+            Lp[k+1] = Lp[k] + counts[k];
+
+        Li.assign( Lp.back(), 0 );
+        Lx.assign( Lp.back(), 0.0 );
+    }
+
+    /*!
+    \brief Computes the factor of a matrix with the analyzed pattern
+    \param values the entries in the order of the rows of analyze()
+    \return false if the matrix is not positive definite
+    */
+    bool factor( const std::vector< double > &values )
+    {
+        const index_t n = Size;
+        std::vector< index_t > stack( n ), mark( n, none() ), free( Lp.begin(), Lp.end() - 1 );
+        std::vector< double > x( n, 0.0 );
+
+        Factored = false;
+
+        for( index_t k = 0; k < n; ++k )
+        {
+            const index_t top = reach( k, stack, mark );
+
+            for( index_t p = Cp[k]; p < Cp[k+1]; ++p )
+                x[ Ci[p] ] += values[ Map[p] ];
+
+            double d = x[k];
+            x[k] = 0.0;
+
+            //solve with the rows above for row k of the factor
+            for( index_t t = top; t < n; ++t )
+            {
+                const index_t i = stack[t];
+                const double lki = x[i] / Lx[ Lp[i] ];
+
+                x[i] = 0.0;
+
+                for( index_t p = Lp[i] + 1; p < free[i]; ++p )
+                    x[ Li[p] ] -= Lx[p] * lki;
+
+                d -= lki * lki;
+
+                const index_t p = free[i]++;
+                Li[p] = k;
+                Lx[p] = lki;
+            }
+
+            if( !(d > 0.0) )
+                return false;
+
+            const index_t p = free[k]++;
+            Li[p] = k;
+            Lx[p] = std::sqrt( d );
+        }
+
+        Factored = true;
+        return true;
+    }
+
+    //!solves A x = b in place
+    void solve( std::vector< double > &b )const
+    {
+        const index_t n = Size;
+        std::vector< double > x( n );
+
+        for( index_t k = 0; k < n; ++k )
+            x[k] = b[ Perm[k] ];
+
+        for( index_t j = 0; j < n; ++j )
+        {
+            x[j] /= Lx[ Lp[j] ];
+
+            for( index_t p = Lp[j] + 1; p < Lp[j+1]; ++p )
+                x[ Li[p] ] -= Lx[p] * x[j];
+        }
+
+        for( index_t j = n; j-- > 0; )
+        {
+            for( index_t p = Lp[j] + 1; p < Lp[j+1]; ++p )
+                x[j] -= Lx[p] * x[ Li[p] ];
+
+            x[j] /= Lx[ Lp[j] ];
+        }
+
+        for( index_t k = 0; k < n; ++k )
+            b[ Perm[k] ] = x[k];
+    }
+
+    std::size_t size()const { return Size; }
+
+    //!number of entries of the factor
+    std::size_t nonzeros()const { return Lx.size(); }
+
+    bool factored()const { return Factored; }
+
+private:
+    static index_t none() { return ~index_t( 0 ); }
+
+    //!parts of the graph up to this size keep their order
+    static index_t leaf() { return 64; }
+
+    //!elimination tree of the permuted matrix
+    void tree()
+    {
+        const index_t n = Size;
+        std::vector< index_t > ancestor( n, none() );
+
+        Parent.assign( n, none() );
+
+        for( index_t k = 0; k < n; ++k )
+            for( index_t p = Cp[k]; p < Cp[k+1]; ++p )
+            {
+                //walk up from i to the root of its subtree with path compression
+                for( index_t i = Ci[p]; i != none() && i < k; )
+                {
+                    const index_t next = ancestor[i];
+                    ancestor[i] = k;
+
+                    if( next == none() )
+                        Parent[i] = k;
+
+                    i = next;
+                }
+            }
+    }
+
+    //!pattern of row k of the factor in topological order, in stack[top..n)
+    index_t reach( index_t k, std::vector< index_t > &stack, std::vector< index_t > &mark )const
+    {
+        const index_t n = Size;
+        index_t top = n;
+
+        mark[k] = k;
+
+        for( index_t p = Cp[k]; p < Cp[k+1]; ++p )
+        {
+            index_t i = Ci[p], len = 0;
+
+            if( i > k )
+                continue;
+
+            //the path up to a marked node, pushed in reverse so the deepest comes first
+            for( ; mark[i] != k; i = Parent[i] )
+            {
+                stack[ len++ ] = i;
+                mark[i] = k;
+            }
+
+            while( len > 0 )
+                stack[ --top ] = stack[ --len ];
+        }
+
+        return top;
+    }
+
+    /*!
+    \brief Nested dissection ordering of the graph of the matrix
+
+    A part of the graph is split by a level of a breadth first search from a pseudo peripheral 
+    vertex, the level that halves the part is the separator and is numbered after the two 
+    sides. The parts are kept in contiguous ranges of Perm and split until they are small.
+    */
+    void dissect( const std::vector< index_t > &start, const std::vector< index_t > &rows )
+    {
+        const index_t n = Size;
+
+        Perm.resize( n );
+        for( index_t k = 0; k < n; ++k )
+            Perm[k] = k;
+
+        //the vertices of the range [lo,hi) of Perm have part lo
+        std::vector< index_t > part( n, 0 ), level( n, none() ), queue;
+        std::vector< std::pair< index_t, index_t > > ranges( 1, std::make_pair( index_t( 0 ), n ) );
+
+        queue.reserve( n );
+
+        while( !ranges.empty() )
+        {
+            const index_t lo = ranges.back().first, hi = ranges.back().second;
+            ranges.pop_back();
+
+            if( hi - lo <= leaf() )
+                continue;
+
+            //a few sweeps from the vertex of smallest degree of the last level
+            index_t root = Perm[lo], depth = 0;
+
+            for( int sweep = 0; sweep < 4; ++sweep )
+            {
+                const index_t d = levels( root, lo, start, rows, part, level, queue );
+                const index_t last = level[ queue.back() ];
+                index_t best = queue.back();
+
+                for( index_t q = queue.size(); q-- > 0 && level[ queue[q] ] == last; )
+                    if( start[ queue[q] + 1 ] - start[ queue[q] ] < start[ best + 1 ] - start[ best ] )
+                        best = queue[q];
+
+                if( sweep > 0 && d <= depth )
+                    break;
+
+                depth = d;
+                root = best;
+            }
+
+            levels( root, lo, start, rows, part, level, queue );
+
+            const std::vector< index_t > range( Perm.begin() + lo, Perm.begin() + hi );
+
+            index_t cut = none();
+
+            //a part that is not connected is split into the reached component and the rest
+            if( queue.size() < hi - lo )
+                cut = none();
+            else
+            {
+                //the smallest level that leaves at least a third on both sides, else the median one
+                const index_t total = index_t( queue.size() );
+                index_t best = none();
+
+                for( index_t q = 0; q < total; )
+                {
+                    index_t e = q;
+                    while( e < total && level[ queue[e] ] == level[ queue[q] ] )
+                        ++e;
+
+                    if( cut == none() && 2 * e >= total )
+                        cut = level[ queue[q] ];
+
+                    if( 3 * q >= total && 3 * (total - e) >= total && e - q < best )
+                    {
+                        best = e - q;
+                        cut = level[ queue[q] ];
+                    }
+
+                    q = e;
+                }
+            }
+
+            //order as [ before the cut | after the cut or not reached | cut ]
+            index_t a = lo, s = hi;
+            std::vector< index_t > after;
+
+            for( index_t k = 0; k < range.size(); ++k )
+                if( level[ range[k] ] == none() )
+                    after.push_back( range[k] );
+
+            for( index_t q = 0; q < queue.size(); ++q )
+            {
+                const index_t v = queue[q];
+
+                if( cut == none() || level[v] < cut )
+                    Perm[ a++ ] = v;
+                else if( level[v] == cut )
+                    Perm[ --s ] = v;
+                else
+                    after.push_back( v );
+            }
+
+            for( index_t q = 0; q < queue.size(); ++q )
+                level[ queue[q] ] = none();
+
+            const index_t b = a;
+            std::copy( after.begin(), after.end(), Perm.begin() + b );
+
+            for( index_t k = lo; k < b; ++k )
+                part[ Perm[k] ] = lo;
+
+            for( index_t k = b; k < s; ++k )
+                part[ Perm[k] ] = b;
+
+            for( index_t k = s; k < hi; ++k )
+                part[ Perm[k] ] = none();
+
+            ranges.push_back( std::make_pair( lo, b ) );
+            ranges.push_back( std::make_pair( b, s ) );
+        }
+    }
+
+    //!breadth first levels of the part of root, returns the depth
+    index_t levels( index_t root, index_t lo, const std::vector< index_t > &start, const std::vector< index_t > &rows,
+                    const std::vector< index_t > &part, std::vector< index_t > &level, std::vector< index_t > &queue )const
+    {
+        for( index_t q = 0; q < queue.size(); ++q )
+            level[ queue[q] ] = none();
+
+        queue.clear();
+        queue.push_back( root );
+        level[root] = 0;
+
+        for( index_t q = 0; q < queue.size(); ++q )
+        {
+            const index_t v = queue[q];
+
+            for( index_t p = start[v]; p < start[v+1]; ++p )
+            {
+                const index_t w = rows[p];
+
+                if( part[w] == lo && level[w] == none() )
+                {
+                    level[w] = level[v] + 1;
+                    queue.push_back( w );
+                }
+            }
+        }
+
+        return level[ queue.back() ];
+    }
+
+    std::size_t Size;
+    bool Factored;
+
+    //!Perm[k] is the row of the matrix at position k of the factor, Inverse the opposite
+    std::vector< index_t > Perm, Inverse;
+
+    //!upper triangle of the permuted matrix and the position of its entries in the input
+    std::vector< index_t > Cp, Ci, Map;
+
+    std::vector< index_t > Parent;
+
+    //!factor by columns, the diagonal first
+    std::vector< index_t > Lp, Li;
+    std::vector< double > Lx;
+};
+
+}
+
+}
+
+#endif
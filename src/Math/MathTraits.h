@@ -25,6 +25,16 @@
 #include <cmath>
 #include <cfloat>
 
+//!force inlining of the small vector operators, so that whole expressions are
+//!fused by the optimizer without intermediate vector temporaries
+#if defined(_MSC_VER)
+#define ARCH_INLINE __forceinline
+#elif defined(__GNUC__)
+#define ARCH_INLINE inline __attribute__((always_inline))
+#else
+#define ARCH_INLINE inline
+#endif
+
 namespace arch
 {
 
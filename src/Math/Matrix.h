@@ -0,0 +1,168 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef MATH_MATRIX_H
+#define MATH_MATRIX_H
+
+#include "Vector.h"
+#include "Simd.h"
+
+namespace arch
+{
+
+namespace math
+{
+
+//!3x3 matrix stored in row major order
+template< typename Real >
+class mat3
+{
+public:
+    typedef Real real_t;
+
+    // constructors
+    mat3<Real>( void );
+    mat3<Real>( const Real &v );
+    mat3<Real>( const Real *ptr );
+    mat3<Real>( const vec3<Real> &r0, const vec3<Real> &r1, const vec3<Real> &r2 );
+    mat3<Real>( 
+        const Real &m00, const Real &m01, const Real &m02,
+        const Real &m10, const Real &m11, const Real &m12,
+        const Real &m20, const Real &m21, const Real &m22 );
+
+    // operators
+    void operator+=( const mat3<Real> &m );
+    void operator-=( const mat3<Real> &m );
+    void operator*=( const Real &v );
+
+    Real &operator()(unsigned int row, unsigned int col);
+    Real operator()(unsigned int row, unsigned int col)const;
+
+    vec3<Real> row(unsigned int index)const;
+    vec3<Real> col(unsigned int index)const;
+
+    std::size_t size()const;
+
+    // variables
+    Real m[9];
+};
+
+//!identity matrix
+template< typename Real >
+mat3<Real> identity3();
+
+template< typename Real >
+mat3<Real> transpose(const mat3<Real> &a);
+
+template< typename Real >
+Real determinant(const mat3<Real> &a);
+
+/*!
+\brief Inverts a matrix using the cofactor expansion
+\param a the matrix to invert
+\param inv the inverse matrix
+\param tol the minimum absolute determinant of an invertible matrix
+\return false if the matrix is singular and inv is not set
+*/
+template< typename Real >
+bool inverse(const mat3<Real> &a, mat3<Real> &inv, const Real &tol = traits<Real>::zero_tol);
+
+/*!
+\brief Solves the linear system a * x = b
+\return false if the matrix is singular and x is not set
+*/
+template< typename Real >
+bool solve(const mat3<Real> &a, const vec3<Real> &b, vec3<Real> &x, const Real &tol = traits<Real>::zero_tol);
+
+//!outer product a * b^T
+template< typename Real >
+mat3<Real> outer(const vec3<Real> &a, const vec3<Real> &b);
+
+template<typename Real>
+std::ostream &operator<<(std::ostream &output, const mat3<Real> &m);
+
+//!4x4 matrix stored in row major order
+template< typename Real >
+class mat4
+{
+public:
+    typedef Real real_t;
+
+    // constructors
+    mat4<Real>( void );
+    mat4<Real>( const Real &v );
+    mat4<Real>( const Real *ptr );
+    mat4<Real>( const vec4<Real> &r0, const vec4<Real> &r1, const vec4<Real> &r2, const vec4<Real> &r3 );
+
+    // operators
+    void operator+=( const mat4<Real> &m );
+    void operator-=( const mat4<Real> &m );
+    void operator*=( const Real &v );
+
+    Real &operator()(unsigned int row, unsigned int col);
+    Real operator()(unsigned int row, unsigned int col)const;
+
+    vec4<Real> row(unsigned int index)const;
+    vec4<Real> col(unsigned int index)const;
+
+    std::size_t size()const;
+
+    // variables
+    Real m[16];
+};
+
+//!identity matrix
+template< typename Real >
+mat4<Real> identity4();
+
+template< typename Real >
+mat4<Real> transpose(const mat4<Real> &a);
+
+template< typename Real >
+Real determinant(const mat4<Real> &a);
+
+/*!
+\brief Inverts a matrix using the cofactor expansion
+\param a the matrix to invert
+\param inv the inverse matrix
+\param tol the minimum absolute determinant of an invertible matrix
+\return false if the matrix is singular and inv is not set
+*/
+template< typename Real >
+bool inverse(const mat4<Real> &a, mat4<Real> &inv, const Real &tol = traits<Real>::zero_tol);
+
+template<typename Real>
+std::ostream &operator<<(std::ostream &output, const mat4<Real> &m);
+
+typedef mat3<double> mat3d;
+typedef mat3<float> mat3f;
+
+typedef mat4<double> mat4d;
+typedef mat4<float> mat4f;
+
+#include "Matrix.inl"
+
+}
+
+}
+
+#endif
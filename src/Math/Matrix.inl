@@ -0,0 +1,496 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+/*
+ * mat3<Real> Class Constructors
+ */
+template< typename Real >
+ARCH_INLINE mat3<Real>::mat3( void )
+{}
+
+template< typename Real >
+ARCH_INLINE mat3<Real>::mat3( const Real &v )
+{
+    for( int i = 0; i < 9; ++i ) m[i] = v;
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real>::mat3( const Real *ptr )
+{
+    for( int i = 0; i < 9; ++i ) m[i] = ptr[i];
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real>::mat3( const vec3<Real> &r0, const vec3<Real> &r1, const vec3<Real> &r2 )
+{
+    m[0] = r0.x; m[1] = r0.y; m[2] = r0.z;
+    m[3] = r1.x; m[4] = r1.y; m[5] = r1.z;
+    m[6] = r2.x; m[7] = r2.y; m[8] = r2.z;
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real>::mat3( 
+        const Real &m00, const Real &m01, const Real &m02,
+        const Real &m10, const Real &m11, const Real &m12,
+        const Real &m20, const Real &m21, const Real &m22 )
+{
+    m[0] = m00; m[1] = m01; m[2] = m02;
+    m[3] = m10; m[4] = m11; m[5] = m12;
+    m[6] = m20; m[7] = m21; m[8] = m22;
+}
+
+/*
+ * mat3<Real> Member Operators
+ */
+template< typename Real >
+ARCH_INLINE void mat3<Real>::operator+=( const mat3<Real> &a )
+{
+    for( int i = 0; i < 9; ++i ) m[i] += a.m[i];
+}
+
+template< typename Real >
+ARCH_INLINE void mat3<Real>::operator-=( const mat3<Real> &a )
+{
+    for( int i = 0; i < 9; ++i ) m[i] -= a.m[i];
+}
+
+template< typename Real >
+ARCH_INLINE void mat3<Real>::operator*=( const Real &v )
+{
+    for( int i = 0; i < 9; ++i ) m[i] *= v;
+}
+
+template< typename Real >
+ARCH_INLINE Real &mat3<Real>::operator()(unsigned int row, unsigned int col)
+{
+    return m[row*3 + col];
+}
+
+template< typename Real >
+ARCH_INLINE Real mat3<Real>::operator()(unsigned int row, unsigned int col)const
+{
+    return m[row*3 + col];
+}
+
+template< typename Real >
+ARCH_INLINE vec3<Real> mat3<Real>::row(unsigned int index)const
+{
+    return vec3<Real>( m[index*3], m[index*3+1], m[index*3+2] );
+}
+
+template< typename Real >
+ARCH_INLINE vec3<Real> mat3<Real>::col(unsigned int index)const
+{
+    return vec3<Real>( m[index], m[index+3], m[index+6] );
+}
+
+template< typename Real >
+ARCH_INLINE std::size_t mat3<Real>::size()const
+{
+    return 9;
+}
+
+/*
+ * mat3<Real> Non Member Operators
+ */
+template< typename Real >
+ARCH_INLINE mat3<Real> operator+( const mat3<Real> &a, const mat3<Real> &b )
+{
+    mat3<Real> r(a);
+    r += b;
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real> operator-( const mat3<Real> &a, const mat3<Real> &b )
+{
+    mat3<Real> r(a);
+    r -= b;
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real> operator*( const mat3<Real> &a, const Real &f )
+{
+    mat3<Real> r(a);
+    r *= f;
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real> operator*( const Real &f, const mat3<Real> &a )
+{
+    return a * f;
+}
+
+template< typename Real >
+ARCH_INLINE vec3<Real> operator*( const mat3<Real> &a, const vec3<Real> &v )
+{
+    return vec3<Real>(
+        a.m[0]*v.x + a.m[1]*v.y + a.m[2]*v.z,
+        a.m[3]*v.x + a.m[4]*v.y + a.m[5]*v.z,
+        a.m[6]*v.x + a.m[7]*v.y + a.m[8]*v.z );
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real> operator*( const mat3<Real> &a, const mat3<Real> &b )
+{
+    mat3<Real> r;
+
+    for( int i = 0; i < 3; ++i )
+        for( int j = 0; j < 3; ++j )
+            r.m[i*3+j] = a.m[i*3]*b.m[j] + a.m[i*3+1]*b.m[3+j] + a.m[i*3+2]*b.m[6+j];
+
+    return r;
+}
+
+/*
+ * mat3<Real> Functions
+ */
+template< typename Real >
+ARCH_INLINE mat3<Real> identity3()
+{
+    return mat3<Real>( 
+        Real(1.0), Real(0.0), Real(0.0),
+        Real(0.0), Real(1.0), Real(0.0),
+        Real(0.0), Real(0.0), Real(1.0) );
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real> transpose(const mat3<Real> &a)
+{
+    return mat3<Real>( a.col(0), a.col(1), a.col(2) );
+}
+
+template< typename Real >
+ARCH_INLINE Real determinant(const mat3<Real> &a)
+{
+    return dot( a.row(0), cross( a.row(1), a.row(2) ) );
+}
+
+template< typename Real >
+inline bool inverse(const mat3<Real> &a, mat3<Real> &inv, const Real &tol)
+{
+    using std::abs;
+
+    //the rows of the adjugate transpose are the cross products of the rows
+    const vec3<Real> r0 = a.row(0), r1 = a.row(1), r2 = a.row(2);
+    const vec3<Real> c0 = cross( r1, r2 );
+    const vec3<Real> c1 = cross( r2, r0 );
+    const vec3<Real> c2 = cross( r0, r1 );
+
+    const Real det = dot( r0, c0 );
+
+    if( !(abs( det ) > tol) )       //also rejects NaN
+        return false;
+
+    const Real idet = Real(1.0) / det;
+
+    inv = mat3<Real>(
+        c0.x*idet, c1.x*idet, c2.x*idet,
+        c0.y*idet, c1.y*idet, c2.y*idet,
+        c0.z*idet, c1.z*idet, c2.z*idet );
+
+    return true;
+}
+
+template< typename Real >
+inline bool solve(const mat3<Real> &a, const vec3<Real> &b, vec3<Real> &x, const Real &tol)
+{
+    mat3<Real> inv;
+
+    if( !inverse( a, inv, tol ) )
+        return false;
+
+    x = inv * b;
+    return true;
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real> outer(const vec3<Real> &a, const vec3<Real> &b)
+{
+    return mat3<Real>( b * a.x, b * a.y, b * a.z );
+}
+
+template<typename Real>
+inline std::ostream &operator << (std::ostream &output, const mat3<Real> &m)
+{
+    output << m.row(0) << ' ' << m.row(1) << ' ' << m.row(2);
+
+    return output;
+}
+
+/*
+ * mat4<Real> Class Constructors
+ */
+template< typename Real >
+ARCH_INLINE mat4<Real>::mat4( void )
+{}
+
+template< typename Real >
+ARCH_INLINE mat4<Real>::mat4( const Real &v )
+{
+    for( int i = 0; i < 16; ++i ) m[i] = v;
+}
+
+template< typename Real >
+ARCH_INLINE mat4<Real>::mat4( const Real *ptr )
+{
+    for( int i = 0; i < 16; ++i ) m[i] = ptr[i];
+}
+
+template< typename Real >
+ARCH_INLINE mat4<Real>::mat4( const vec4<Real> &r0, const vec4<Real> &r1, const vec4<Real> &r2, const vec4<Real> &r3 )
+{
+    m[0]  = r0.x; m[1]  = r0.y; m[2]  = r0.z; m[3]  = r0.w;
+    m[4]  = r1.x; m[5]  = r1.y; m[6]  = r1.z; m[7]  = r1.w;
+    m[8]  = r2.x; m[9]  = r2.y; m[10] = r2.z; m[11] = r2.w;
+    m[12] = r3.x; m[13] = r3.y; m[14] = r3.z; m[15] = r3.w;
+}
+
+/*
+ * mat4<Real> Member Operators
+ */
+template< typename Real >
+ARCH_INLINE void mat4<Real>::operator+=( const mat4<Real> &a )
+{
+    for( int i = 0; i < 16; ++i ) m[i] += a.m[i];
+}
+
+template< typename Real >
+ARCH_INLINE void mat4<Real>::operator-=( const mat4<Real> &a )
+{
+    for( int i = 0; i < 16; ++i ) m[i] -= a.m[i];
+}
+
+template< typename Real >
+ARCH_INLINE void mat4<Real>::operator*=( const Real &v )
+{
+    for( int i = 0; i < 16; ++i ) m[i] *= v;
+}
+
+#ifdef ARCH_SSE
+template<>
+ARCH_INLINE void mat4<float>::operator+=( const mat4<float> &a )
+{
+    for( int i = 0; i < 16; i += 4 )
+        _mm_storeu_ps( m + i, _mm_add_ps( _mm_loadu_ps( m + i ), _mm_loadu_ps( a.m + i ) ) );
+}
+
+template<>
+ARCH_INLINE void mat4<float>::operator-=( const mat4<float> &a )
+{
+    for( int i = 0; i < 16; i += 4 )
+        _mm_storeu_ps( m + i, _mm_sub_ps( _mm_loadu_ps( m + i ), _mm_loadu_ps( a.m + i ) ) );
+}
+#endif
+
+template< typename Real >
+ARCH_INLINE Real &mat4<Real>::operator()(unsigned int row, unsigned int col)
+{
+    return m[row*4 + col];
+}
+
+template< typename Real >
+ARCH_INLINE Real mat4<Real>::operator()(unsigned int row, unsigned int col)const
+{
+    return m[row*4 + col];
+}
+
+template< typename Real >
+ARCH_INLINE vec4<Real> mat4<Real>::row(unsigned int index)const
+{
+    return vec4<Real>( m[index*4], m[index*4+1], m[index*4+2], m[index*4+3] );
+}
+
+template< typename Real >
+ARCH_INLINE vec4<Real> mat4<Real>::col(unsigned int index)const
+{
+    return vec4<Real>( m[index], m[index+4], m[index+8], m[index+12] );
+}
+
+template< typename Real >
+ARCH_INLINE std::size_t mat4<Real>::size()const
+{
+    return 16;
+}
+
+/*
+ * mat4<Real> Non Member Operators
+ */
+template< typename Real >
+ARCH_INLINE mat4<Real> operator+( const mat4<Real> &a, const mat4<Real> &b )
+{
+    mat4<Real> r(a);
+    r += b;
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE mat4<Real> operator-( const mat4<Real> &a, const mat4<Real> &b )
+{
+    mat4<Real> r(a);
+    r -= b;
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE mat4<Real> operator*( const mat4<Real> &a, const Real &f )
+{
+    mat4<Real> r(a);
+    r *= f;
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE mat4<Real> operator*( const Real &f, const mat4<Real> &a )
+{
+    return a * f;
+}
+
+template< typename Real >
+ARCH_INLINE vec4<Real> operator*( const mat4<Real> &a, const vec4<Real> &v )
+{
+    return vec4<Real>(
+        a.m[0]*v.x  + a.m[1]*v.y  + a.m[2]*v.z  + a.m[3]*v.w,
+        a.m[4]*v.x  + a.m[5]*v.y  + a.m[6]*v.z  + a.m[7]*v.w,
+        a.m[8]*v.x  + a.m[9]*v.y  + a.m[10]*v.z + a.m[11]*v.w,
+        a.m[12]*v.x + a.m[13]*v.y + a.m[14]*v.z + a.m[15]*v.w );
+}
+
+template< typename Real >
+ARCH_INLINE mat4<Real> operator*( const mat4<Real> &a, const mat4<Real> &b )
+{
+    mat4<Real> r;
+
+    for( int i = 0; i < 4; ++i )
+        for( int j = 0; j < 4; ++j )
+            r.m[i*4+j] = 
+                a.m[i*4]*b.m[j] + a.m[i*4+1]*b.m[4+j] + 
+                a.m[i*4+2]*b.m[8+j] + a.m[i*4+3]*b.m[12+j];
+
+    return r;
+}
+
+/*
+ * mat4<Real> Functions
+ */
+template< typename Real >
+ARCH_INLINE mat4<Real> identity4()
+{
+    mat4<Real> r( Real(0.0) );
+    r.m[0] = r.m[5] = r.m[10] = r.m[15] = Real(1.0);
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE mat4<Real> transpose(const mat4<Real> &a)
+{
+    return mat4<Real>( a.col(0), a.col(1), a.col(2), a.col(3) );
+}
+
+template< typename Real >
+inline Real determinant(const mat4<Real> &a)
+{
+    const Real *m = a.m;
+
+    //2x2 sub-determinants of the upper and lower row pairs
+    Real s0 = m[0]*m[5] - m[4]*m[1];
+    Real s1 = m[0]*m[6] - m[4]*m[2];
+    Real s2 = m[0]*m[7] - m[4]*m[3];
+    Real s3 = m[1]*m[6] - m[5]*m[2];
+    Real s4 = m[1]*m[7] - m[5]*m[3];
+    Real s5 = m[2]*m[7] - m[6]*m[3];
+
+    Real c5 = m[10]*m[15] - m[14]*m[11];
+    Real c4 = m[9]*m[15] - m[13]*m[11];
+    Real c3 = m[9]*m[14] - m[13]*m[10];
+    Real c2 = m[8]*m[15] - m[12]*m[11];
+    Real c1 = m[8]*m[14] - m[12]*m[10];
+    Real c0 = m[8]*m[13] - m[12]*m[9];
+
+    return s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+}
+
+template< typename Real >
+inline bool inverse(const mat4<Real> &a, mat4<Real> &inv, const Real &tol)
+{
+    using std::abs;
+
+    const Real *m = a.m;
+
+    Real s0 = m[0]*m[5] - m[4]*m[1];
+    Real s1 = m[0]*m[6] - m[4]*m[2];
+    Real s2 = m[0]*m[7] - m[4]*m[3];
+    Real s3 = m[1]*m[6] - m[5]*m[2];
+    Real s4 = m[1]*m[7] - m[5]*m[3];
+    Real s5 = m[2]*m[7] - m[6]*m[3];
+
+    Real c5 = m[10]*m[15] - m[14]*m[11];
+    Real c4 = m[9]*m[15] - m[13]*m[11];
+    Real c3 = m[9]*m[14] - m[13]*m[10];
+    Real c2 = m[8]*m[15] - m[12]*m[11];
+    Real c1 = m[8]*m[14] - m[12]*m[10];
+    Real c0 = m[8]*m[13] - m[12]*m[9];
+
+    Real det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+
+    if( !(abs( det ) > tol) )       //also rejects NaN
+        return false;
+
+    Real idet = Real(1.0) / det;
+    Real *r = inv.m;
+
+    r[0]  = ( m[5]*c5 - m[6]*c4 + m[7]*c3) * idet;
+    r[1]  = (-m[1]*c5 + m[2]*c4 - m[3]*c3) * idet;
+    r[2]  = ( m[13]*s5 - m[14]*s4 + m[15]*s3) * idet;
+    r[3]  = (-m[9]*s5 + m[10]*s4 - m[11]*s3) * idet;
+
+    r[4]  = (-m[4]*c5 + m[6]*c2 - m[7]*c1) * idet;
+    r[5]  = ( m[0]*c5 - m[2]*c2 + m[3]*c1) * idet;
+    r[6]  = (-m[12]*s5 + m[14]*s2 - m[15]*s1) * idet;
+    r[7]  = ( m[8]*s5 - m[10]*s2 + m[11]*s1) * idet;
+
+    r[8]  = ( m[4]*c4 - m[5]*c2 + m[7]*c0) * idet;
+    r[9]  = (-m[0]*c4 + m[1]*c2 - m[3]*c0) * idet;
+    r[10] = ( m[12]*s4 - m[13]*s2 + m[15]*s0) * idet;
+    r[11] = (-m[8]*s4 + m[9]*s2 - m[11]*s0) * idet;
+
+    r[12] = (-m[4]*c3 + m[5]*c1 - m[6]*c0) * idet;
+    r[13] = ( m[0]*c3 - m[1]*c1 + m[2]*c0) * idet;
+    r[14] = (-m[12]*s3 + m[13]*s1 - m[14]*s0) * idet;
+    r[15] = ( m[8]*s3 - m[9]*s1 + m[10]*s0) * idet;
+
+    return true;
+}
+
+template<typename Real>
+inline std::ostream &operator << (std::ostream &output, const mat4<Real> &m)
+{
+    for( unsigned int i = 0; i < 4; ++i )
+    {
+        const vec4<Real> r = m.row(i);
+        output << (i ? " " : "") << r.x << ' ' << r.y << ' ' << r.z << ' ' << r.w;
+    }
+
+    return output;
+}
@@ -0,0 +1,418 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef MATH_PREDICATES_H
+#define MATH_PREDICATES_H
+
+#include <cmath>
+
+namespace arch
+{
+
+namespace math
+{
+
+/*!
+\brief Exact floating point expansions
+
+An expansion is a sum of doubles of increasing magnitude that do not overlap, the sign of the 
+sum is the sign of the last component. The routines follow Shewchuk, Adaptive Precision 
+Floating-Point Arithmetic and Fast Robust Geometric Predicates (1997). They need double 
+arithmetic rounded to nearest without extended precision, as with SSE2, and no overflow or 
+underflow in the products.
+*/
+struct expansion
+{
+    //!half of the machine epsilon of double, 2^-53
+    static double epsilon() { return 1.1102230246251565e-16; }
+
+    //!2^27 + 1, splits a double in two halves of 26 bits
+    static double splitter() { return 134217729.0; }
+
+    //!x + y = a + b exactly, |a| >= |b|
+    static void fast_two_sum( double a, double b, double &x, double &y )
+    {
+        x = a + b;
+        y = b - (x - a);
+    }
+
+    //!x + y = a + b exactly
+    static void two_sum( double a, double b, double &x, double &y )
+    {
+        x = a + b;
+        const double bv = x - a, av = x - bv;
+        y = (a - av) + (b - bv);
+    }
+
+    //!x + y = a - b exactly
+    static void two_diff( double a, double b, double &x, double &y )
+    {
+        x = a - b;
+        const double bv = a - x, av = x + bv;
+        y = (a - av) + (bv - b);
+    }
+
+    static void split( double a, double &hi, double &lo )
+    {
+        const double c = splitter() * a;
+        hi = c - (c - a);
+        lo = a - hi;
+    }
+
+    //!x + y = a * b exactly, b already split
+    static void two_product( double a, double b, double bhi, double blo, double &x, double &y )
+    {
+        double ahi, alo;
+        split( a, ahi, alo );
+
+        x = a * b;
+        y = alo * blo - (((x - ahi * bhi) - alo * bhi) - ahi * blo);
+    }
+
+    /*!
+    \brief h = e + f
+    \return the number of components of h, at most elen + flen
+    */
+    static int sum( int elen, const double *e, int flen, const double *f, double *h )
+    {
+        int ei = 0, fi = 0, hi = 0;
+        double enow = e[0], fnow = f[0], q, qnew, hh;
+
+        //the components are merged by magnitude
+        if( (fnow > enow) == (fnow > -enow) ) { q = enow; enow = ++ei < elen ? e[ei] : 0.0; }
+        else                                  { q = fnow; fnow = ++fi < flen ? f[fi] : 0.0; }
+
+        if( ei < elen && fi < flen )
+        {
+            if( (fnow > enow) == (fnow > -enow) ) { fast_two_sum( enow, q, qnew, hh ); enow = ++ei < elen ? e[ei] : 0.0; }
+            else                                  { fast_two_sum( fnow, q, qnew, hh ); fnow = ++fi < flen ? f[fi] : 0.0; }
+
+            q = qnew;
+            if( hh != 0.0 ) h[hi++] = hh;
+
+            while( ei < elen && fi < flen )
+            {
+                if( (fnow > enow) == (fnow > -enow) ) { two_sum( q, enow, qnew, hh ); enow = ++ei < elen ? e[ei] : 0.0; }
+                else                                  { two_sum( q, fnow, qnew, hh ); fnow = ++fi < flen ? f[fi] : 0.0; }
+
+                q = qnew;
+                if( hh != 0.0 ) h[hi++] = hh;
+            }
+        }
+
+        for( ; ei < elen; enow = ++ei < elen ? e[ei] : 0.0 )
+        {
+            two_sum( q, enow, qnew, hh );
+            q = qnew;
+            if( hh != 0.0 ) h[hi++] = hh;
+        }
+
+        for( ; fi < flen; fnow = ++fi < flen ? f[fi] : 0.0 )
+        {
+            two_sum( q, fnow, qnew, hh );
+            q = qnew;
+            if( hh != 0.0 ) h[hi++] = hh;
+        }
+
+        if( q != 0.0 || hi == 0 )
+            h[hi++] = q;
+
+        return hi;
+    }
+
+    /*!
+    \brief h = e * b
+    \return the number of components of h, at most 2 * elen
+    */
+    static int scale( int elen, const double *e, double b, double *h )
+    {
+        double bhi, blo, q, hh, p1, p0, s;
+        split( b, bhi, blo );
+
+        int hi = 0;
+        two_product( e[0], b, bhi, blo, q, hh );
+        if( hh != 0.0 ) h[hi++] = hh;
+
+        for( int i = 1; i < elen; ++i )
+        {
+            two_product( e[i], b, bhi, blo, p1, p0 );
+            two_sum( q, p0, s, hh );
+            if( hh != 0.0 ) h[hi++] = hh;
+            fast_two_sum( p1, s, q, hh );
+            if( hh != 0.0 ) h[hi++] = hh;
+        }
+
+        if( q != 0.0 || hi == 0 )
+            h[hi++] = q;
+
+        return hi;
+    }
+
+    /*!
+    \brief h = e * f
+    \return the number of components of h, at most 2 * elen * flen <= N
+    */
+    template<int N>
+    static int product( int elen, const double *e, int flen, const double *f, double *h )
+    {
+        double scaled[N], acc[N];
+
+        int hlen = scale( elen, e, f[0], h );
+
+        for( int i = 1; i < flen; ++i )
+        {
+            const int slen = scale( elen, e, f[i], scaled );
+            hlen = sum( hlen, h, slen, scaled, acc );
+
+            for( int k = 0; k < hlen; ++k )
+                h[k] = acc[k];
+        }
+
+        return hlen;
+    }
+
+    static void negate( int elen, double *e )
+    {
+        for( int i = 0; i < elen; ++i )
+            e[i] = -e[i];
+    }
+
+    /*!
+    \brief e = a - b
+    \return 1 when the difference is exact in double, which is the usual case for nearby points, 2 otherwise
+    */
+    static int diff( double a, double b, double *e )
+    {
+        double x, y;
+        two_diff( a, b, x, y );
+
+        if( y == 0.0 )
+        {
+            e[0] = x;
+            return 1;
+        }
+
+        e[0] = y;
+        e[1] = x;
+        return 2;
+    }
+
+    //!a * b - c * d as an expansion of at most 16 components, the factors have at most 2 components
+    static int cross( int alen, const double *a, int blen, const double *b, int clen, const double *c, int dlen, const double *d, double *h )
+    {
+        double ab[8], cd[8];
+        const int ablen = product<8>( alen, a, blen, b, ab );
+        const int cdlen = product<8>( clen, c, dlen, d, cd );
+
+        negate( cdlen, cd );
+        return sum( ablen, ab, cdlen, cd, h );
+    }
+};
+
+//!orient2d evaluated exactly
+inline double orient2d_exact( double ax, double ay, double bx, double by, double cx, double cy )
+{
+    double acx[2], acy[2], bcx[2], bcy[2], h[16];
+    const int acxlen = expansion::diff( ax, cx, acx ), acylen = expansion::diff( ay, cy, acy );
+    const int bcxlen = expansion::diff( bx, cx, bcx ), bcylen = expansion::diff( by, cy, bcy );
+
+    const int n = expansion::cross( acxlen, acx, bcylen, bcy, acylen, acy, bcxlen, bcx, h );
+    return h[n - 1];
+}
+
+//!orient3d evaluated exactly
+inline double orient3d_exact( double ax, double ay, double az, double bx, double by, double bz,
+                              double cx, double cy, double cz, double dx, double dy, double dz )
+{
+    double d[3][3][2];
+    int dlen[3][3];
+    const double p[3][3] = { { ax, ay, az }, { bx, by, bz }, { cx, cy, cz } };
+    const double q[3] = { dx, dy, dz };
+
+    for( int i = 0; i < 3; ++i )
+        for( int k = 0; k < 3; ++k )
+            dlen[i][k] = expansion::diff( p[i][k], q[k], d[i][k] );
+
+    //the cofactors along z, each z difference times a 2x2 minor of the other two points
+    double minor[16], term[3][64], ab[128], h[192];
+    int len[3];
+
+    for( int i = 0; i < 3; ++i )
+    {
+        const int j = (i + 1) % 3, k = (i + 2) % 3;
+        const int mlen = expansion::cross( dlen[j][0], d[j][0], dlen[k][1], d[k][1], dlen[k][0], d[k][0], dlen[j][1], d[j][1], minor );
+        len[i] = expansion::product<64>( mlen, minor, dlen[i][2], d[i][2], term[i] );
+    }
+
+    const int ablen = expansion::sum( len[0], term[0], len[1], term[1], ab );
+    const int n = expansion::sum( ablen, ab, len[2], term[2], h );
+
+    return -h[n - 1];
+}
+
+//!incircle evaluated exactly
+inline double incircle_exact( double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy )
+{
+    double d[3][2][2];
+    int dlen[3][2];
+    const double p[3][2] = { { ax, ay }, { bx, by }, { cx, cy } };
+    const double q[2] = { dx, dy };
+
+    for( int i = 0; i < 3; ++i )
+        for( int k = 0; k < 2; ++k )
+            dlen[i][k] = expansion::diff( p[i][k], q[k], d[i][k] );
+
+    //the lifted coordinate of every point times the 2x2 minor of the other two
+    double xx[8], yy[8], lift[16], minor[16], term[3][512], ab[1024], h[1536];
+    int len[3];
+
+    for( int i = 0; i < 3; ++i )
+    {
+        const int j = (i + 1) % 3, k = (i + 2) % 3;
+
+        const int xlen = expansion::product<8>( dlen[i][0], d[i][0], dlen[i][0], d[i][0], xx );
+        const int ylen = expansion::product<8>( dlen[i][1], d[i][1], dlen[i][1], d[i][1], yy );
+        const int llen = expansion::sum( xlen, xx, ylen, yy, lift );
+        const int mlen = expansion::cross( dlen[j][0], d[j][0], dlen[k][1], d[k][1], dlen[k][0], d[k][0], dlen[j][1], d[j][1], minor );
+
+        len[i] = expansion::product<512>( llen, lift, mlen, minor, term[i] );
+    }
+
+    const int ablen = expansion::sum( len[0], term[0], len[1], term[1], ab );
+    const int n = expansion::sum( ablen, ab, len[2], term[2], h );
+
+    return h[n - 1];
+}
+
+/*!
+\brief Orientation of three points of the plane
+\return twice the signed area of the triangle abc, positive when it is counter clock-wise
+
+The determinant is evaluated in double and returned when it is larger than its rounding error 
+bound, which is the case for all but nearly collinear points. Otherwise it is recomputed as 
+an exact expansion, so the sign is always right and 0 means exactly collinear.
+*/
+inline double orient2d( double ax, double ay, double bx, double by, double cx, double cy )
+{
+    const double left = (ax - cx) * (by - cy);
+    const double right = (ay - cy) * (bx - cx);
+    const double det = left - right;
+
+    double detsum;
+
+    if( left > 0.0 )
+    {
+        if( right <= 0.0 )
+            return det;
+
+        detsum = left + right;
+    }
+    else if( left < 0.0 )
+    {
+        if( right >= 0.0 )
+            return det;
+
+        detsum = -left - right;
+    }
+    else
+        return det;
+
+    const double eps = expansion::epsilon();
+    const double bound = (3.0 + 16.0 * eps) * eps * detsum;
+
+    if( det >= bound || -det >= bound )
+        return det;
+
+    return orient2d_exact( ax, ay, bx, by, cx, cy );
+}
+
+/*!
+\brief Orientation of four points
+\return six times the signed volume of the tetrahedron abcd, positive when d lies on the side 
+the normal of the counter clock-wise triangle abc points to
+
+Filtered like orient2d, exact when the double evaluation is not conclusive. The sign is the 
+opposite of Shewchuk's orient3d.
+*/
+inline double orient3d( double ax, double ay, double az, double bx, double by, double bz,
+                        double cx, double cy, double cz, double dx, double dy, double dz )
+{
+    const double adx = ax - dx, bdx = bx - dx, cdx = cx - dx;
+    const double ady = ay - dy, bdy = by - dy, cdy = cy - dy;
+    const double adz = az - dz, bdz = bz - dz, cdz = cz - dz;
+
+    const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    const double cdxady = cdx * ady, adxcdy = adx * cdy;
+    const double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    const double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+
+    const double permanent = (std::fabs( bdxcdy ) + std::fabs( cdxbdy )) * std::fabs( adz ) +
+                             (std::fabs( cdxady ) + std::fabs( adxcdy )) * std::fabs( bdz ) +
+                             (std::fabs( adxbdy ) + std::fabs( bdxady )) * std::fabs( cdz );
+
+    const double eps = expansion::epsilon();
+    const double bound = (7.0 + 56.0 * eps) * eps * permanent;
+
+    if( det > bound || -det > bound )
+        return -det;
+
+    return orient3d_exact( ax, ay, az, bx, by, bz, cx, cy, cz, dx, dy, dz );
+}
+
+/*!
+\brief Position of a point relative to the circle through three points of the plane
+\return positive when d lies inside the circle of the counter clock-wise triangle abc, 
+negative outside and 0 on the circle
+
+Filtered like orient2d, exact when the double evaluation is not conclusive. The sign is 
+reversed for a clock-wise triangle.
+*/
+inline double incircle( double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy )
+{
+    const double adx = ax - dx, bdx = bx - dx, cdx = cx - dx;
+    const double ady = ay - dy, bdy = by - dy, cdy = cy - dy;
+
+    const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy, alift = adx * adx + ady * ady;
+    const double cdxady = cdx * ady, adxcdy = adx * cdy, blift = bdx * bdx + bdy * bdy;
+    const double adxbdy = adx * bdy, bdxady = bdx * ady, clift = cdx * cdx + cdy * cdy;
+
+    const double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+
+    const double permanent = (std::fabs( bdxcdy ) + std::fabs( cdxbdy )) * alift +
+                             (std::fabs( cdxady ) + std::fabs( adxcdy )) * blift +
+                             (std::fabs( adxbdy ) + std::fabs( bdxady )) * clift;
+
+    const double eps = expansion::epsilon();
+    const double bound = (10.0 + 96.0 * eps) * eps * permanent;
+
+    if( det > bound || -det > bound )
+        return det;
+
+    return incircle_exact( ax, ay, bx, by, cx, cy, dx, dy );
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef MATH_QUADRIC_H
+#define MATH_QUADRIC_H
+
+#include "Vector.h"
+#include "Matrix.h"
+#include "Simd.h"
+
+namespace arch
+{
+
+namespace math
+{
+
+/*!
+\brief Symmetric 4x4 quadric error matrix (see 'Surface Simplification Using Quadric Error Metrics' of Garland and Heckbert)
+
+The quadric of the plane ax + by + cz + d = 0 is the outer product of (a,b,c,d),
+the error of a point is the sum of the squared distances from the accumulated planes.
+Only the upper triangle is stored, padded to a multiple of four for SIMD.
+*/
+template< typename Real >
+class quadric
+{
+public:
+    typedef Real real_t;
+
+    // constructors
+
+    //!zero quadric
+    quadric<Real>( void );
+
+    //!quadric of the plane ax + by + cz + d = 0 weighted by w
+    quadric<Real>( const Real &a, const Real &b, const Real &c, const Real &d, const Real &w = Real(1.0) );
+
+    //!quadric of the plane with normal n passing through p weighted by w
+    quadric<Real>( const vec3<Real> &n, const vec3<Real> &p, const Real &w = Real(1.0) );
+
+    // operators
+    void operator+=( const quadric<Real> &q );
+    void operator*=( const Real &v );
+
+    //!returns the error of the point
+    Real evaluate( const vec3<Real> &p )const;
+
+    /*!
+    \brief Finds the point of minimum error
+    \param p the optimal point
+    \return false if the quadric is singular (e.g. coplanar planes) and p is not set
+    */
+    bool optimize( vec3<Real> &p )const;
+
+    //!the upper left 3x3 block A of the quadric
+    mat3<Real> tensor()const;
+
+    //!the vector b of the quadric error p^T A p + 2 b^T p + c
+    vec3<Real> vector()const;
+
+    //!the constant c of the quadric error p^T A p + 2 b^T p + c
+    Real offset()const;
+
+    // variables a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, 0, 0
+    Real m[12];
+};
+
+typedef quadric<double> quadricd;
+typedef quadric<float> quadricf;
+
+#include "Quadric.inl"
+
+}
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*
+  Archmind Non-manifold Geometric Kernel
+  Copyright (C) 2010 Athanasiadis Theodoros
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+/*
+ * quadric<Real> Class Constructors
+ */
+template< typename Real >
+ARCH_INLINE quadric<Real>::quadric( void )
+{
+    for( int i = 0; i < 12; ++i ) m[i] = Real(0.0);
+}
+
+template< typename Real >
+ARCH_INLINE quadric<Real>::quadric( const Real &a, const Real &b, const Real &c, const Real &d, const Real &w )
+{
+    m[0] = w*a*a; m[1] = w*a*b; m[2] = w*a*c; m[3] = w*a*d;
+    m[4] = w*b*b; m[5] = w*b*c; m[6] = w*b*d;
+    m[7] = w*c*c; m[8] = w*c*d;
+    m[9] = w*d*d;
+    m[10] = m[11] = Real(0.0);
+}
+
+template< typename Real >
+ARCH_INLINE quadric<Real>::quadric( const vec3<Real> &n, const vec3<Real> &p, const Real &w )
+{
+    *this = quadric<Real>( n.x, n.y, n.z, -dot( n, p ), w );
+}
+
+/*
+ * quadric<Real> Member Operators
+ */
+template< typename Real >
+ARCH_INLINE void quadric<Real>::operator+=( const quadric<Real> &q )
+{
+    for( int i = 0; i < 12; ++i ) m[i] += q.m[i];
+}
+
+template< typename Real >
+ARCH_INLINE void quadric<Real>::operator*=( const Real &v )
+{
+    for( int i = 0; i < 12; ++i ) m[i] *= v;
+}
+
+template< typename Real >
+ARCH_INLINE Real quadric<Real>::evaluate( const vec3<Real> &p )const
+{
+    const Real x = p.x, y = p.y, z = p.z;
+
+    return 
+        x * (m[0]*x + Real(2.0)*(m[1]*y + m[2]*z + m[3])) +
+        y * (m[4]*y + Real(2.0)*(m[5]*z + m[6])) +
+        z * (m[7]*z + Real(2.0)*m[8]) +
+        m[9];
+}
+
+#ifdef ARCH_SSE
+template<>
+ARCH_INLINE void quadric<float>::operator+=( const quadric<float> &q )
+{
+    _mm_storeu_ps( m,     _mm_add_ps( _mm_loadu_ps( m ),     _mm_loadu_ps( q.m ) ) );
+    _mm_storeu_ps( m + 4, _mm_add_ps( _mm_loadu_ps( m + 4 ), _mm_loadu_ps( q.m + 4 ) ) );
+    _mm_storeu_ps( m + 8, _mm_add_ps( _mm_loadu_ps( m + 8 ), _mm_loadu_ps( q.m + 8 ) ) );
+}
+
+template<>
+ARCH_INLINE void quadric<float>::operator*=( const float &v )
+{
+    const __m128 s = _mm_set1_ps( v );
+
+    _mm_storeu_ps( m,     _mm_mul_ps( _mm_loadu_ps( m ),     s ) );
+    _mm_storeu_ps( m + 4, _mm_mul_ps( _mm_loadu_ps( m + 4 ), s ) );
+    _mm_storeu_ps( m + 8, _mm_mul_ps( _mm_loadu_ps( m + 8 ), s ) );
+}
+
+template<>
+ARCH_INLINE float quadric<float>::evaluate( const vec3<float> &p )const
+{
+    const float x = p.x, y = p.y, z = p.z;
+
+    //monomials matching the coefficient layout, the off-diagonal terms are doubled
+    const __m128 p0 = _mm_mul_ps( _mm_setr_ps( x, x+x, x+x, x+x ), _mm_setr_ps( x, y, z, 1.0f ) );
+    const __m128 p1 = _mm_mul_ps( _mm_setr_ps( y, y+y, y+y, z ), _mm_setr_ps( y, z, 1.0f, z ) );
+    const __m128 p2 = _mm_setr_ps( z+z, 1.0f, 0.0f, 0.0f );
+
+    __m128 s = _mm_mul_ps( _mm_loadu_ps( m ), p0 );
+    s = _mm_add_ps( s, _mm_mul_ps( _mm_loadu_ps( m + 4 ), p1 ) );
+    s = _mm_add_ps( s, _mm_mul_ps( _mm_loadu_ps( m + 8 ), p2 ) );
+
+    //horizontal sum
+    s = _mm_add_ps( s, _mm_movehl_ps( s, s ) );
+    s = _mm_add_ss( s, _mm_shuffle_ps( s, s, 1 ) );
+
+    return _mm_cvtss_f32( s );
+}
+
+template<>
+ARCH_INLINE void quadric<double>::operator+=( const quadric<double> &q )
+{
+    for( int i = 0; i < 12; i += 2 )
+        _mm_storeu_pd( m + i, _mm_add_pd( _mm_loadu_pd( m + i ), _mm_loadu_pd( q.m + i ) ) );
+}
+
+template<>
+ARCH_INLINE void quadric<double>::operator*=( const double &v )
+{
+    const __m128d s = _mm_set1_pd( v );
+
+    for( int i = 0; i < 12; i += 2 )
+        _mm_storeu_pd( m + i, _mm_mul_pd( _mm_loadu_pd( m + i ), s ) );
+}
+#endif
+
+template< typename Real >
+inline bool quadric<Real>::optimize( vec3<Real> &p )const
+{
+    using std::sqrt;
+
+    //scale invariant singularity test : |det(A)| against the cubed frobenius norm of A
+    const Real norm_sq = 
+        m[0]*m[0] + m[4]*m[4] + m[7]*m[7] + 
+        Real(2.0)*(m[1]*m[1] + m[2]*m[2] + m[5]*m[5]);
+
+    const Real norm = sqrt( norm_sq );
+
+    vec3<Real> x;
+    if( !solve( tensor(), vector(), x, traits<Real>::zero_tol * norm * norm_sq ) )
+        return false;
+
+    p = -x;
+    return true;
+}
+
+template< typename Real >
+ARCH_INLINE mat3<Real> quadric<Real>::tensor()const
+{
+    return mat3<Real>(
+        m[0], m[1], m[2],
+        m[1], m[4], m[5],
+        m[2], m[5], m[7] );
+}
+
+template< typename Real >
+ARCH_INLINE vec3<Real> quadric<Real>::vector()const
+{
+    return vec3<Real>( m[3], m[6], m[8] );
+}
+
+template< typename Real >
+ARCH_INLINE Real quadric<Real>::offset()const
+{
+    return m[9];
+}
+
+/*
+ * quadric<Real> Non Member Operators
+ */
+template< typename Real >
+ARCH_INLINE quadric<Real> operator+( const quadric<Real> &a, const quadric<Real> &b )
+{
+    quadric<Real> r(a);
+    r += b;
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE quadric<Real> operator*( const quadric<Real> &a, const Real &f )
+{
+    quadric<Real> r(a);
+    r *= f;
+    return r;
+}
+
+template< typename Real >
+ARCH_INLINE quadric<Real> operator*( const Real &f, const quadric<Real> &a )
+{
+    return a * f;
+}
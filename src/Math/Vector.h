@@ -23,6 +23,7 @@
 #define MATH_VECTOR_H
 
 #include "MathTraits.h"
+#include "Predicates.h"
 #include <cstdlib>      //for abs
 #include <cmath>        //for sqrt
 #include <iostream>
@@ -88,9 +89,8 @@ public:
 
     template< typename T >
     vec3<Real>( const vec3<T> &v ) : 
-        x(v.x), y(v.y), z(v.z)
+        x(Real(v.x)), y(Real(v.y)), z(Real(v.z))
     { 
-        x = Real(v.x); y = Real(v.y); z = Real(v.z);
     }
 
     template< typename T >
@@ -211,33 +211,40 @@ Real clip_line_to_plane
     return (+pd -dot(lp,pn)) / dotND;
 }
 
+/*!
+\brief Checks if a point lies in a triangle
+\return true if the point projected on the plane of the triangle is inside it or on its border
+
+The points are projected on the coordinate plane of the dominant axis of the triangle normal and 
+compared with the exact orient2d, so nearly degenerate triangles are classified correctly. A 
+triangle without area contains no point.
+*/
 template< typename Real >
 bool point_in_triangle
 (const vec3<Real> &point, const vec3<Real> &v1, const vec3<Real> &v2, const vec3<Real> &v3)
 {
-    vec3<Real> E0, E1, Q;
-    Real e00, e01, e11, Delta, q0, q1, s0, s1;
+    using std::abs;
 
-    E0 = v2 - v1;
-    E1 = v3 - v1;
-    
-    Q = point - v1;
+    const double ux = double(v2.x) - double(v1.x), uy = double(v2.y) - double(v1.y), uz = double(v2.z) - double(v1.z);
+    const double vx = double(v3.x) - double(v1.x), vy = double(v3.y) - double(v1.y), vz = double(v3.z) - double(v1.z);
+    const double n[3] = { abs( uy * vz - uz * vy ), abs( uz * vx - ux * vz ), abs( ux * vy - uy * vx ) };
 
-    e00 = dot(E0,E0);
-    e01 = dot(E0,E1);
-    e11 = dot(E1,E1);
+    const int axis = n[0] > n[1] ? (n[0] > n[2] ? 0 : 2) : (n[1] > n[2] ? 1 : 2);
+    const int i = (axis + 1) % 3, j = (axis + 2) % 3;
 
-    q0 = dot(E0,Q);
-    q1 = dot(E1,Q);
+    const double area = orient2d( v1[i], v1[j], v2[i], v2[j], v3[i], v3[j] );
 
-    s0 = e11 * q0 - e01 * q1;
-    s1 = e00 * q1 - e01 * q0;
-    Delta = e00 * e11 - (e01 * e01);
+    if( area == 0.0 )
+        return false;
+
+    const double s0 = orient2d( v1[i], v1[j], v2[i], v2[j], point[i], point[j] );
+    const double s1 = orient2d( v2[i], v2[j], v3[i], v3[j], point[i], point[j] );
+    const double s2 = orient2d( v3[i], v3[j], v1[i], v1[j], point[i], point[j] );
 
-    if( (s0 >= -traits<Real>::zero_tol && s1 >= -traits<Real>::zero_tol) && ((s0 + s1) / Delta) <= (1.0 + traits<Real>::zero_tol) )
-        return true;
+    if( area > 0.0 )
+        return s0 >= 0.0 && s1 >= 0.0 && s2 >= 0.0;
     else
-        return false;
+        return s0 <= 0.0 && s1 <= 0.0 && s2 <= 0.0;
 }
 
 typedef vec2<double> vec2d;
@@ -23,25 +23,25 @@
  * vec2<Real> Class Constructors 
  */
 template< typename Real >    
-inline vec2<Real>::vec2( const vec2<Real> &v )
+ARCH_INLINE vec2<Real>::vec2( const vec2<Real> &v )
 {
     x = v.x; y = v.y;
 }
 
 template< typename Real >    
-inline vec2<Real>::vec2( const Real &x_, const Real &y_ )
+ARCH_INLINE vec2<Real>::vec2( const Real &x_, const Real &y_ )
 {
     x = x_; y = y_;
 }
 
 template< typename Real >    
-inline vec2<Real>::vec2( const Real &v ) 
+ARCH_INLINE vec2<Real>::vec2( const Real &v ) 
 {
     x = v; y = v;
 }
 
 template< typename Real >    
-inline vec2<Real>::vec2( void )
+ARCH_INLINE vec2<Real>::vec2( void )
 {}
       
 /*
@@ -49,66 +49,65 @@ inline vec2<Real>::vec2( void )
  */
 
 template< typename Real >    
-inline void vec2<Real>::operator+=( const vec2<Real> &v )
+ARCH_INLINE void vec2<Real>::operator+=( const vec2<Real> &v )
 {
     x += v.x;
     y += v.y;
 }
 
 template< typename Real >    
-inline void vec2<Real>::operator-=( const vec2<Real> &v )
+ARCH_INLINE void vec2<Real>::operator-=( const vec2<Real> &v )
 {
     x -= v.x;
     y -= v.y;
 }
 
 template< typename Real >    
-inline void vec2<Real>::operator/=(const Real &v)
+ARCH_INLINE void vec2<Real>::operator/=(const Real &v)
 {
     x /= v;
     y /= v;
 }
 
 template< typename Real >    
-inline void vec2<Real>::operator*=(const Real &v)
+ARCH_INLINE void vec2<Real>::operator*=(const Real &v)
 {
     x *= v;
     y *= v;
 }
 
 template< typename Real >    
-inline vec2<Real> vec2<Real>::operator-()
+ARCH_INLINE vec2<Real> vec2<Real>::operator-()
 {
-    const vec2<Real> v(-x,-y);
-    return v;
+    return vec2<Real>(-x,-y);
 }
 
 template< typename Real >    
-inline Real &vec2<Real>::operator()(unsigned int index)
+ARCH_INLINE Real &vec2<Real>::operator()(unsigned int index)
 {
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >    
-inline Real vec2<Real>::operator()(unsigned int index)const
+ARCH_INLINE Real vec2<Real>::operator()(unsigned int index)const
 { 
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >    
-inline Real &vec2<Real>::operator[](unsigned int index)
+ARCH_INLINE Real &vec2<Real>::operator[](unsigned int index)
 {
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >    
-inline Real vec2<Real>::operator[](unsigned int index)const
+ARCH_INLINE Real vec2<Real>::operator[](unsigned int index)const
 { 
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >
-std::size_t vec2<Real>::size()const
+ARCH_INLINE std::size_t vec2<Real>::size()const
 {
     return 2;
 }
@@ -117,63 +116,58 @@ std::size_t vec2<Real>::size()const
  * vec2<Real> Non Member Operators
  */
 template< typename Real >
-inline vec2<Real> operator+( const vec2<Real> &a, const vec2<Real> &b )
+ARCH_INLINE vec2<Real> operator+( const vec2<Real> &a, const vec2<Real> &b )
 {
-    const vec2<Real> v( a.x+b.x,a.y+b.y );
-    return v;
+    return vec2<Real>(a.x+b.x,a.y+b.y);
 }
 
 template< typename Real >
-inline vec2<Real> operator-( const vec2<Real> &a, const vec2<Real> &b )
+ARCH_INLINE vec2<Real> operator-( const vec2<Real> &a, const vec2<Real> &b )
 {
-    const vec2<Real> v(a.x-b.x,a.y-b.y);
-    return v;
+    return vec2<Real>(a.x-b.x,a.y-b.y);
 }
 
 template< typename Real >
-inline vec2<Real> operator/( const vec2<Real> &a, const Real b)
+ARCH_INLINE vec2<Real> operator/( const vec2<Real> &a, const Real b)
 {
-    const vec2<Real> v(a.x/b,a.y/b);
-    return v;
+    return vec2<Real>(a.x/b,a.y/b);
 }
 
 template< typename Real >
-inline vec2<Real> operator*( const vec2<Real> &a, const Real b)
+ARCH_INLINE vec2<Real> operator*( const vec2<Real> &a, const Real b)
 {
-    const vec2<Real> v(a.x*b,a.y*b);
-    return v;
+    return vec2<Real>(a.x*b,a.y*b);
 }
 
 template< typename Real >
-inline vec2<Real> operator*( const Real &b, const vec2<Real> &a)
+ARCH_INLINE vec2<Real> operator*( const Real &b, const vec2<Real> &a)
 {
-    const vec2<Real> v(a.x*b,a.y*b);
-    return v;
+    return vec2<Real>(a.x*b,a.y*b);
 }
 
 template< typename Real >
-inline bool operator==(const vec2<Real> &a, const vec2<Real> &b )
+ARCH_INLINE bool operator==(const vec2<Real> &a, const vec2<Real> &b )
 {
-    return (a.x == b.y) && (a.y == b.y);
+    return (a.x == b.x) && (a.y == b.y);
 }
 
 /* 
  * vec2<Real> Functions
  */
 template< typename Real>
-inline Real magnitude(const vec2<Real> &a)
+ARCH_INLINE Real magnitude(const vec2<Real> &a)
 {
     return sqrt(a.x*a.x + a.y*a.y);
 }
 
 template< typename Real>
-inline Real dot(const vec2<Real> &a, const vec2<Real> &b)
+ARCH_INLINE Real dot(const vec2<Real> &a, const vec2<Real> &b)
 {
     return (a.x * b.x + a.y * b.y);
 }
 
 template< typename Real>
-inline Real adot(const vec2<Real> &a, const vec2<Real> &b)
+ARCH_INLINE Real adot(const vec2<Real> &a, const vec2<Real> &b)
 {
     using std::abs;
     return abs(dot(a,b));
@@ -194,25 +188,25 @@ inline std::ostream &operator << (std::ostream &output, const vec2<Real> &v)
 
 
 template< typename Real >
-inline vec3<Real>::vec3( const Real *ptr )
+ARCH_INLINE vec3<Real>::vec3( const Real *ptr )
 {
     x = ptr[0]; y = ptr[1]; z = ptr[2];
 }
 
 template< typename Real >
-inline vec3<Real>::vec3( const Real &x_, const Real &y_, const Real &z_)
+ARCH_INLINE vec3<Real>::vec3( const Real &x_, const Real &y_, const Real &z_)
 {
     x = x_; y = y_; z = z_;
 }
 
 template< typename Real >
-inline vec3<Real>::vec3( const Real &v ) 
+ARCH_INLINE vec3<Real>::vec3( const Real &v ) 
 {
     x = v; y = v; z = v;
 }
 
 template< typename Real >
-inline vec3<Real>::vec3( void )
+ARCH_INLINE vec3<Real>::vec3( void )
 {}
 
 /*
@@ -220,7 +214,7 @@ inline vec3<Real>::vec3( void )
  */
 
 template< typename Real >
-inline bool vec3<Real>::operator==(const vec3<Real> &v )
+ARCH_INLINE bool vec3<Real>::operator==(const vec3<Real> &v )
 {
     using std::abs;
 
@@ -235,7 +229,7 @@ inline bool vec3<Real>::operator==(const vec3<Real> &v )
 }
 
 template< typename Real >
-inline void vec3<Real>::operator+=( const vec3<Real> &v )
+ARCH_INLINE void vec3<Real>::operator+=( const vec3<Real> &v )
 {
     x += v.x;
     y += v.y;
@@ -243,7 +237,7 @@ inline void vec3<Real>::operator+=( const vec3<Real> &v )
 }
 
 template< typename Real >
-inline void vec3<Real>::operator-=( const vec3<Real> &v)
+ARCH_INLINE void vec3<Real>::operator-=( const vec3<Real> &v)
 {
     x -= v.x;
     y -= v.y;
@@ -251,7 +245,7 @@ inline void vec3<Real>::operator-=( const vec3<Real> &v)
 }
 
 template< typename Real >
-inline void vec3<Real>::operator/=(const Real &v)
+ARCH_INLINE void vec3<Real>::operator/=(const Real &v)
 {
     x /= v;
     y /= v;
@@ -259,7 +253,7 @@ inline void vec3<Real>::operator/=(const Real &v)
 }
 
 template< typename Real >
-inline void vec3<Real>::operator*=(const Real &v)
+ARCH_INLINE void vec3<Real>::operator*=(const Real &v)
 {
     x *= v;
     y *= v;
@@ -267,38 +261,37 @@ inline void vec3<Real>::operator*=(const Real &v)
 }
 
 template< typename Real >
-inline vec3<Real> vec3<Real>::operator-()const
+ARCH_INLINE vec3<Real> vec3<Real>::operator-()const
 {
-    const vec3<Real> v(-x,-y,-z);
-    return v;
+    return vec3<Real>(-x,-y,-z);
 }
 
 template< typename Real >
-inline Real &vec3<Real>::operator()(unsigned int index)
+ARCH_INLINE Real &vec3<Real>::operator()(unsigned int index)
 { 
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >
-inline Real vec3<Real>::operator()(unsigned int index)const
+ARCH_INLINE Real vec3<Real>::operator()(unsigned int index)const
 {
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >
-inline Real &vec3<Real>::operator[](unsigned int index)
+ARCH_INLINE Real &vec3<Real>::operator[](unsigned int index)
 {
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >
-inline Real vec3<Real>::operator[](unsigned int index)const
+ARCH_INLINE Real vec3<Real>::operator[](unsigned int index)const
 { 
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >
-std::size_t vec3<Real>::size()const
+ARCH_INLINE std::size_t vec3<Real>::size()const
 {
     return 3;
 }
@@ -307,45 +300,40 @@ std::size_t vec3<Real>::size()const
  * vec3<Real> Non Member Operators
  */
 template< typename Real >
-inline vec3<Real> operator+( const vec3<Real> &a, const vec3<Real> &b )
+ARCH_INLINE vec3<Real> operator+( const vec3<Real> &a, const vec3<Real> &b )
 {
-       const vec3<Real> v( a.x+b.x,a.y+b.y, a.z+b.z );
-       return v;
+    return vec3<Real>(a.x+b.x,a.y+b.y, a.z+b.z);
 }
 
 template< typename Real >
-inline vec3<Real> operator-( const vec3<Real> &a, const vec3<Real> &b )
+ARCH_INLINE vec3<Real> operator-( const vec3<Real> &a, const vec3<Real> &b )
 {
-       const vec3<Real> v(a.x-b.x,a.y-b.y,a.z-b.z);
-       return v;
+    return vec3<Real>(a.x-b.x,a.y-b.y,a.z-b.z);
 }
 
 
 template< typename Real >
-inline vec3<Real> operator/( const vec3<Real> &a, const Real &f )
+ARCH_INLINE vec3<Real> operator/( const vec3<Real> &a, const Real &f )
 {
-       const vec3<Real> v(a.x/f,a.y/f,a.z/f);
-       return v;
+    return vec3<Real>(a.x/f,a.y/f,a.z/f);
 }
 
 template< typename Real >
-inline vec3<Real> operator*( const vec3<Real> &a, const Real &f )
+ARCH_INLINE vec3<Real> operator*( const vec3<Real> &a, const Real &f )
 {
-       const vec3<Real> v(a.x*f,a.y*f,a.z*f);
-       return v;
+    return vec3<Real>(a.x*f,a.y*f,a.z*f);
 }
 
 template< typename Real >
-inline vec3<Real> operator*( const Real &f, const vec3<Real> &a )
+ARCH_INLINE vec3<Real> operator*( const Real &f, const vec3<Real> &a )
 {
-       const vec3<Real> v(a.x*f,a.y*f,a.z*f);
-       return v;
+    return vec3<Real>(a.x*f,a.y*f,a.z*f);
 }
 
 template< typename Real >
-inline bool operator==(const vec3<Real> &a, const vec3<Real> &b )
+ARCH_INLINE bool operator==(const vec3<Real> &a, const vec3<Real> &b )
 {
-       return (a.x == b.y) && (a.y == b.y) && (a.z == b.z);
+       return (a.x == b.x) && (a.y == b.y) && (a.z == b.z);
 }
 
 template<typename Real>
@@ -361,13 +349,13 @@ inline std::ostream &operator << (std::ostream &output, const vec3<Real> &v)
  * vec3<Real> Functions
  */
 template< typename Real>
-inline Real dot(const vec3<Real> &a, const vec3<Real> &b)
+ARCH_INLINE Real dot(const vec3<Real> &a, const vec3<Real> &b)
 {
     return (a.x * b.x + a.y * b.y + a.z * b.z);
 }
 
 template< typename Real>
-inline Real adot(const vec3<Real> &a, const vec3<Real> &b)
+ARCH_INLINE Real adot(const vec3<Real> &a, const vec3<Real> &b)
 {
     using std::abs;
     return abs(dot(a,b));
@@ -375,7 +363,7 @@ inline Real adot(const vec3<Real> &a, const vec3<Real> &b)
 
 
 template< typename Real>
-inline Real magnitude(const vec3<Real> &a)
+ARCH_INLINE Real magnitude(const vec3<Real> &a)
 {
     using std::sqrt;
 
@@ -383,7 +371,7 @@ inline Real magnitude(const vec3<Real> &a)
 }
 
 template< typename Real>
-inline vec3<Real> cross(const vec3<Real> &a, const vec3<Real> &b)
+ARCH_INLINE vec3<Real> cross(const vec3<Real> &a, const vec3<Real> &b)
 {
     const vec3<Real> vcross(
             ((a.y * b.z) - (a.z * b.y)),
@@ -394,7 +382,7 @@ inline vec3<Real> cross(const vec3<Real> &a, const vec3<Real> &b)
 }
 
 template< typename Real>
-inline vec3<Real> normal(const vec3<Real> &v1, const vec3<Real> &v2, const vec3<Real> &v3)
+ARCH_INLINE vec3<Real> normal(const vec3<Real> &v1, const vec3<Real> &v2, const vec3<Real> &v3)
 {
     return normalize(cross(v3-v1,v2-v1));   
 }
@@ -403,25 +391,25 @@ inline vec3<Real> normal(const vec3<Real> &v1, const vec3<Real> &v2, const vec3<
  * vec4<Real> Class Constructors 
  */
 template< typename Real >
-inline vec4<Real>::vec4( const vec4<Real> &v )
+ARCH_INLINE vec4<Real>::vec4( const vec4<Real> &v )
 {
     x = v.x; y = v.y; z = v.z; w = v.w;
 }
           
 template< typename Real >
-inline vec4<Real>::vec4( const Real &x_, const Real &y_, const Real &z_, const Real &w_)
+ARCH_INLINE vec4<Real>::vec4( const Real &x_, const Real &y_, const Real &z_, const Real &w_)
 {
     x = x_; y = y_; z = z_; w = w_;
 }
           
 template< typename Real >
-inline vec4<Real>::vec4( const Real &v ) 
+ARCH_INLINE vec4<Real>::vec4( const Real &v ) 
 {
     x = v; y = v; z = v; w = v;
 }
           
 template< typename Real >
-inline vec4<Real>::vec4( void )
+ARCH_INLINE vec4<Real>::vec4( void )
 {}
 
 /*
@@ -429,63 +417,62 @@ inline vec4<Real>::vec4( void )
  */
 
 template< typename Real >
-inline void vec4<Real>::operator+=( const vec4<Real> &v )
+ARCH_INLINE void vec4<Real>::operator+=( const vec4<Real> &v )
 {
     x += v.x; y += v.y; z += v.z; w += v.w;
 }
 
 template< typename Real >
-inline void vec4<Real>::operator-=( const vec4<Real> &v)
+ARCH_INLINE void vec4<Real>::operator-=( const vec4<Real> &v)
 {
     x -= v.x; y -= v.y; z -= v.z; w -= v.w;
 }
 
 template< typename Real >
-inline void vec4<Real>::operator/=(const Real &v)
+ARCH_INLINE void vec4<Real>::operator/=(const Real &v)
 {
     x /= v; y /= v; z /= v; w /= v;
 }
 
 template< typename Real >
-inline void vec4<Real>::operator*=(const Real &v)
+ARCH_INLINE void vec4<Real>::operator*=(const Real &v)
 {
-    x *= v; y *= v; z *= v; z *= v;
+    x *= v; y *= v; z *= v; w *= v;
 }
 
 template< typename Real >
-inline vec4<Real> vec4<Real>::operator-()
+ARCH_INLINE vec4<Real> vec4<Real>::operator-()
 {
-    const vec4<Real> v(-x,-y,-z,-w);
-    return v;
+    return vec4<Real>(-x,-y,-z,-w);
 }
 
 
 template< typename Real >
-inline Real &vec4<Real>::operator()(unsigned int index)
+ARCH_INLINE Real &vec4<Real>::operator()(unsigned int index)
 { 
     return *(((Real *) &x) + index); 
 }
           
 template< typename Real >
-inline Real vec4<Real>::operator()(unsigned int index)const
+ARCH_INLINE Real vec4<Real>::operator()(unsigned int index)const
 { 
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >
-inline Real &vec4<Real>::operator[](unsigned int index)
+ARCH_INLINE Real &vec4<Real>::operator[](unsigned int index)
 { 
     return *(((Real *) &x) + index); 
 }
           
 template< typename Real >
-inline Real vec4<Real>::operator[](unsigned int index)const
+ARCH_INLINE Real vec4<Real>::operator[](unsigned int index)const
 { 
     return *(((Real *) &x) + index); 
 }
 
 template< typename Real >
-std::size_t vec4<Real>::size()const
+ARCH_INLINE std::size_t vec4<Real>::size()const
 {
     return 4;
 }
@@ -494,62 +481,57 @@ std::size_t vec4<Real>::size()const
  * vec4<Real> Non Member Operators
  */
 template< typename Real >
-inline vec4<Real> operator+( const vec4<Real> &a, const vec4<Real> &b )
+ARCH_INLINE vec4<Real> operator+( const vec4<Real> &a, const vec4<Real> &b )
 {
-       const vec4<Real> v( a.x+b.x,a.y+b.y, a.z+b.z, a.w+b.w );
-       return v;
+    return vec4<Real>(a.x+b.x,a.y+b.y, a.z+b.z, a.w+b.w);
 }
 
 template< typename Real >
-inline vec4<Real> operator-( const vec4<Real> &a, const vec4<Real> &b )
+ARCH_INLINE vec4<Real> operator-( const vec4<Real> &a, const vec4<Real> &b )
 {
-       const vec4<Real> v(a.x-b.x,a.y-b.y,a.z-b.z,a.w-b.w);
-       return v;
+    return vec4<Real>(a.x-b.x,a.y-b.y,a.z-b.z,a.w-b.w);
 }
 
 template< typename Real >
-inline vec4<Real> operator/( const vec4<Real> &a, const Real &f )
+ARCH_INLINE vec4<Real> operator/( const vec4<Real> &a, const Real &f )
 {
-       const vec4<Real> v(a.x/f,a.y/f,a.z/f,a.w/f);
-       return v;
+    return vec4<Real>(a.x/f,a.y/f,a.z/f,a.w/f);
 }
 
 template< typename Real >
-inline vec4<Real> operator*( const vec4<Real> &a, const Real &f )
+ARCH_INLINE vec4<Real> operator*( const vec4<Real> &a, const Real &f )
 {
-       const vec4<Real> v(a.x*f,a.y*f,a.z*f,a.w*f);
-       return v;
+    return vec4<Real>(a.x*f,a.y*f,a.z*f,a.w*f);
 }
 
 template< typename Real >
-inline vec4<Real> operator*( const Real f, const vec4<Real> &a )
+ARCH_INLINE vec4<Real> operator*( const Real f, const vec4<Real> &a )
 {
-       const vec4<Real> v(a.x*f,a.y*f,a.z*f,a.w*f);
-       return v;
+    return vec4<Real>(a.x*f,a.y*f,a.z*f,a.w*f);
 }
 
 template< typename Real >
-inline bool operator==(const vec4<Real> &a, const vec4<Real> &b )
+ARCH_INLINE bool operator==(const vec4<Real> &a, const vec4<Real> &b )
 {
-       return (a.x == b.y) && (a.y == b.y) && (a.z == b.z) && (a.w == b.w);
+       return (a.x == b.x) && (a.y == b.y) && (a.z == b.z) && (a.w == b.w);
 }
 
 
 template< typename VectorType >
-inline typename VectorType::real_t distance(const VectorType &a, const VectorType &b)
+ARCH_INLINE typename VectorType::real_t distance(const VectorType &a, const VectorType &b)
 {
     return magnitude( a - b );
 }
 
 template< typename VectorType >
-inline typename VectorType::real_t distance_sq(const VectorType &a, const VectorType &b)
+ARCH_INLINE typename VectorType::real_t distance_sq(const VectorType &a, const VectorType &b)
 {
     const VectorType c(a - b);
     return dot( c, c );
 }
 
 template< typename VectorType>
-inline VectorType normalize(const VectorType &a)
+ARCH_INLINE VectorType normalize(const VectorType &a)
 {
     return a / magnitude(a);
 }
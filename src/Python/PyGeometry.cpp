@@ -23,11 +23,32 @@
 #include "PyGeometry.h"
 #include "../Geometry/Geometry.h"
 #include "../Geometry/Algorithms.h"
+#include "../Geometry/Decimate.h"
+#include "../Geometry/Boundary.h"
+#include "../Geometry/Quality.h"
+#include "../Geometry/Improve.h"
+#include "../Geometry/Subdivide.h"
+#include "../Geometry/Smooth.h"
+#include "../Geometry/Orient.h"
+#include "../Geometry/Components.h"
+#include "../Geometry/Bvh.h"
+#include "../Geometry/Weld.h"
+#include "../Geometry/Intersect.h"
+#include "../Geometry/Manifold.h"
+#include "../Geometry/Geodesics.h"
+#include "../Geometry/Curvature.h"
+#include "../Geometry/Slice.h"
+#include "../Geometry/Properties.h"
+#include "../Geometry/Remesh.h"
+#include "../Geometry/Distance.h"
 
 #include <boost/python.hpp>
 #include <boost/python/stl_iterator.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <string>
+#include <iterator>
+
 using arch::python::real_t;
 
 using namespace arch::geometry;
@@ -79,6 +100,22 @@ bool py_is_convex(const boost::python::object &o)
     return is_convex( begin, end );
 }
 
+//the predicates on the mesh points, the 2d ones read x and y
+double py_orient2d(const mesh_t::point_t &a, const mesh_t::point_t &b, const mesh_t::point_t &c)
+{
+    return arch::math::orient2d( a.x, a.y, b.x, b.y, c.x, c.y );
+}
+
+double py_orient3d(const mesh_t::point_t &a, const mesh_t::point_t &b, const mesh_t::point_t &c, const mesh_t::point_t &d)
+{
+    return orient3( a, b, c, d );
+}
+
+double py_incircle(const mesh_t::point_t &a, const mesh_t::point_t &b, const mesh_t::point_t &c, const mesh_t::point_t &d)
+{
+    return arch::math::incircle( a.x, a.y, b.x, b.y, c.x, c.y, d.x, d.y );
+}
+
 //Convert a python list to a c++ iterator range
 template<typename T,typename R>
 R py_centroid(const boost::python::object &o)
@@ -136,6 +173,382 @@ std::vector< vertex_ptr_t > triangulate_ret(const face_ptr_t &f)
     return tris;
 }
 
+std::size_t py_triangulate_mesh(mesh_t &m, bool keep_quads)
+{
+    triangulate_options options;
+    options.keep_quads = keep_quads;
+
+    return triangulate_mesh( m, options );
+}
+
+std::size_t py_decimate(mesh_t &m, std::size_t target_faces, bool lock_boundary, double feature_angle, 
+                        double max_error, bool parallel)
+{
+    decimate_options options;
+    options.lock_boundary = lock_boundary;
+    options.feature_angle = feature_angle;
+    options.max_error = max_error;
+    options.parallel = parallel;
+
+    return decimate( m, target_faces, options );
+}
+
+boost::python::list py_boundary_loops(const mesh_t &m)
+{
+    std::vector< mesh_t::vertex_array_t > loops;
+    boundary_loops( m, loops );
+
+    boost::python::list l;
+    for( std::size_t i = 0; i < loops.size(); ++i )
+        l.append( loops[i] );
+
+    return l;
+}
+
+boost::python::list py_histogram(const quality_measure &q)
+{
+    boost::python::list l;
+    for( std::size_t i = 0; i < q.histogram.size(); ++i )
+        l.append( q.histogram[i] );
+
+    return l;
+}
+
+mesh_quality py_quality_report(const mesh_t &m, int threads)
+{
+    return quality_report( m, threads );
+}
+
+improve_stats py_improve(mesh_t &m, int iterations, double skew_angle, double max_angle, double improve_angle, 
+                         double feature_angle, double node_equiv)
+{
+    improve_options options;
+    options.iterations = iterations;
+    options.skew_angle = skew_angle;
+    options.max_angle = max_angle;
+    options.improve_angle = improve_angle;
+    options.feature_angle = feature_angle;
+    options.node_equiv = node_equiv;
+
+    return improve( m, options );
+}
+
+std::size_t py_subdivide(mesh_t &m, subdivide_scheme scheme, int levels)
+{
+    subdivide_options options;
+    options.scheme = scheme;
+    options.levels = levels;
+
+    return subdivide( m, options );
+}
+
+std::size_t py_smooth(mesh_t &m, int iterations, smooth_weights weights, double lambda, double mu)
+{
+    smooth_options options;
+    options.weights = weights;
+    options.lambda = lambda;
+    options.mu = mu;
+
+    return smooth( m, iterations, options );
+}
+
+template<typename T>
+boost::python::list py_list(const std::vector< T > &v)
+{
+    boost::python::list l;
+    for( std::size_t i = 0; i < v.size(); ++i )
+        l.append( v[i] );
+
+    return l;
+}
+
+boost::python::list py_component_faces(const orientation_report &r)
+{
+    return py_list( r.component_faces );
+}
+
+boost::python::list py_component_flips(const orientation_report &r)
+{
+    return py_list( r.component_flips );
+}
+
+boost::python::list py_component_orientable(const orientation_report &r)
+{
+    boost::python::list l;
+    for( std::size_t i = 0; i < r.component_orientable.size(); ++i )
+        l.append( r.component_orientable[i] != 0 );
+
+    return l;
+}
+
+orientation_report py_orient_consistently(mesh_t &m, int threads)
+{
+    return orient_consistently( m, threads );
+}
+
+typedef mesh_components< mesh_t::real_t > components_t;
+
+//the ids are returned as lists with -1 in place of NO_ID
+boost::python::list py_ids(const std::vector< arch::geometry::uid_t > &v)
+{
+    boost::python::list l;
+    for( std::size_t i = 0; i < v.size(); ++i )
+        l.append( v[i] == NO_ID ? -1 : long( v[i] ) );
+
+    return l;
+}
+
+boost::python::list py_face_component(const components_t &c) { return py_ids( c.face_component ); }
+boost::python::list py_vertex_component(const components_t &c) { return py_ids( c.vertex_component ); }
+boost::python::list py_component_face_count(const components_t &c) { return py_list( c.faces ); }
+boost::python::list py_component_vertex_count(const components_t &c) { return py_list( c.verts ); }
+boost::python::list py_component_min(const components_t &c) { return py_list( c.min ); }
+boost::python::list py_component_max(const components_t &c) { return py_list( c.max ); }
+
+components_t py_connected_components(const mesh_t &m, component_connectivity by, bool bounds)
+{
+    components_options options;
+    options.by = by;
+    options.bounds = bounds;
+
+    components_t c;
+    connected_components( m, c, options );
+
+    return c;
+}
+
+typedef face_bvh< mesh_t::real_t > bvh_t;
+
+boost::shared_ptr< bvh_t > py_make_bvh(const mesh_t &m)
+{
+    return boost::shared_ptr< bvh_t >( new bvh_t( m ) );
+}
+
+//(face id, point, distance) or None
+boost::python::object py_bvh_closest_point(const bvh_t &bvh, const mesh_t::point_t &p)
+{
+    bvh_t::closest_t r;
+    if( !bvh.closest_point( p, r ) )
+        return boost::python::object();
+
+    return boost::python::make_tuple( r.face, r.point, r.distance );
+}
+
+//(face id, t) or None
+boost::python::object py_bvh_ray_hit(const bvh_t &bvh, const mesh_t::point_t &origin, const mesh_t::point_t &dir)
+{
+    bvh_t::hit_t r;
+    if( !bvh.ray_hit( origin, dir, r ) )
+        return boost::python::object();
+
+    return boost::python::make_tuple( r.face, r.t );
+}
+
+boost::python::list py_bvh_box_overlap(const bvh_t &bvh, const mesh_t::point_t &lo, const mesh_t::point_t &hi)
+{
+    std::vector< arch::geometry::uid_t > faces;
+    bvh.box_overlap( lo, hi, faces );
+
+    return py_list( faces );
+}
+
+void py_bvh_refit(bvh_t &bvh, const mesh_t &m)
+{
+    bvh.refit( m );
+}
+
+std::size_t py_weld_vertices(mesh_t &m, mesh_t::real_t tolerance, int threads)
+{
+    return weld_vertices( m, tolerance, threads );
+}
+
+//list of (face id, face id)
+boost::python::list py_find_self_intersections(const mesh_t &m, int threads)
+{
+    std::vector< face_pair > pairs;
+    find_self_intersections( m, pairs, threads );
+
+    boost::python::list l;
+    for( std::size_t i = 0; i < pairs.size(); ++i )
+        l.append( boost::python::make_tuple( pairs[i].first, pairs[i].second ) );
+
+    return l;
+}
+
+//the bitsets are returned as bytes, the id i is bit i % 8 of byte i / 8 (numpy.unpackbits with bitorder='little')
+boost::python::object py_bits(const manifold_report::bitset_t &bits)
+{
+    std::string bytes;
+    bytes.reserve( bits.num_blocks() );
+    boost::to_block_range( bits, std::back_inserter( bytes ) );
+
+#if PY_MAJOR_VERSION >= 3
+    PyObject *o = PyBytes_FromStringAndSize( bytes.data(), Py_ssize_t( bytes.size() ) );
+#else
+    PyObject *o = PyString_FromStringAndSize( bytes.data(), Py_ssize_t( bytes.size() ) );
+#endif
+
+    return boost::python::object( boost::python::handle<>( o ) );
+}
+
+boost::python::object py_boundary_edges(const manifold_report &r) { return py_bits( r.boundary_edges ); }
+boost::python::object py_manifold_edges(const manifold_report &r) { return py_bits( r.manifold_edges ); }
+boost::python::object py_tjoin_edges(const manifold_report &r) { return py_bits( r.tjoin_edges ); }
+boost::python::object py_nonmanifold_verts(const manifold_report &r) { return py_bits( r.nonmanifold_verts ); }
+boost::python::object py_isolated_verts(const manifold_report &r) { return py_bits( r.isolated_verts ); }
+
+manifold_report py_classify_manifold(const mesh_t &m, int threads)
+{
+    return classify_manifold( m, threads );
+}
+
+//the original vertex id of every vertex
+boost::python::list py_make_manifold(mesh_t &m, int threads)
+{
+    std::vector< arch::geometry::uid_t > original;
+    make_manifold( m, original, threads );
+
+    return py_list( original );
+}
+
+typedef geodesics< mesh_t::real_t > geodesics_t;
+
+boost::shared_ptr< geodesics_t > py_make_geodesics(const mesh_t &m, int threads)
+{
+    indexed_mesh< mesh_t::real_t > im;
+    make_indexed( m, im, threads );
+
+    return boost::shared_ptr< geodesics_t >( new geodesics_t( im, threads ) );
+}
+
+std::vector< arch::geometry::uid_t > py_sources(const boost::python::object &o)
+{
+    typedef boost::python::stl_input_iterator< arch::geometry::uid_t > iterator_t;
+    iterator_t begin(o), end;
+
+    return std::vector< arch::geometry::uid_t >( begin, end );
+}
+
+boost::python::list py_geodesics_distance(geodesics_t &g, const boost::python::object &sources, geodesic_method method)
+{
+    std::vector< double > distance;
+
+    //the interpreter lock keeps the lazy factoring to one caller
+    if( method == GEODESIC_HEAT && !g.heat_ready() )
+        g.prepare_heat();
+
+    g.distance( method, py_sources( sources ), distance );
+
+    return py_list( distance );
+}
+
+boost::python::list py_geodesic_distance(const mesh_t &m, const boost::python::object &sources, geodesic_method method, int threads)
+{
+    std::vector< double > distance;
+    geodesic_distance( m, py_sources( sources ), distance, method, threads );
+
+    return py_list( distance );
+}
+
+boost::python::list py_mean_curvature(const mesh_curvature &c) { return py_list( c.mean ); }
+boost::python::list py_gaussian_curvature(const mesh_curvature &c) { return py_list( c.gaussian ); }
+boost::python::list py_kmax_curvature(const mesh_curvature &c) { return py_list( c.kmax ); }
+boost::python::list py_kmin_curvature(const mesh_curvature &c) { return py_list( c.kmin ); }
+boost::python::list py_vertex_area(const mesh_curvature &c) { return py_list( c.area ); }
+boost::python::list py_dihedral(const mesh_curvature &c) { return py_list( c.dihedral ); }
+
+boost::python::object py_feature_edges(const mesh_curvature &c, double angle, int threads)
+{
+    return py_bits( c.feature_edges( angle, threads ) );
+}
+
+mesh_curvature py_curvature(const mesh_t &m, int threads)
+{
+    mesh_curvature c;
+    compute_curvature( m, c, threads );
+
+    return c;
+}
+
+//a list of (points, closed) polylines for every offset
+boost::python::list py_slice(const mesh_t &m, const mesh_t::point_t &normal, const boost::python::object &offsets, int threads)
+{
+    typedef boost::python::stl_input_iterator< double > iterator_t;
+    iterator_t begin(offsets), end;
+
+    std::vector< cross_section< mesh_t::real_t > > sections;
+    slice( m, normal, std::vector< double >( begin, end ), sections, threads );
+
+    boost::python::list l;
+    for( std::size_t i = 0; i < sections.size(); ++i )
+    {
+        const cross_section< mesh_t::real_t > &s = sections[i];
+
+        boost::python::list polylines;
+        for( std::size_t k = 0; k < s.polylines_size(); ++k )
+        {
+            boost::python::list points;
+            for( std::size_t j = s.start[k]; j < s.start[k+1]; ++j )
+                points.append( s.points[j] );
+
+            polylines.append( boost::python::make_tuple( points, bool( s.closed[k] ) ) );
+        }
+
+        l.append( polylines );
+    }
+
+    return l;
+}
+
+mesh_t::point_t py_point(const mesh_properties::point_t &p)
+{
+    return mesh_t::point_t( mesh_t::real_t( p.x ), mesh_t::real_t( p.y ), mesh_t::real_t( p.z ) );
+}
+
+mesh_t::point_t py_properties_lo(const mesh_properties &r) { return py_point( r.lo ); }
+mesh_t::point_t py_properties_hi(const mesh_properties &r) { return py_point( r.hi ); }
+mesh_t::point_t py_properties_centroid(const mesh_properties &r) { return py_point( r.centroid ); }
+mesh_t::point_t py_properties_center(const mesh_properties &r) { return py_point( r.center ); }
+
+//the rows of the inertia tensor
+boost::python::tuple py_properties_inertia(const mesh_properties &r)
+{
+    const arch::math::mat3< double > &i = r.inertia;
+
+    return boost::python::make_tuple( boost::python::make_tuple( i(0,0), i(0,1), i(0,2) ), 
+                                      boost::python::make_tuple( i(1,0), i(1,1), i(1,2) ), 
+                                      boost::python::make_tuple( i(2,0), i(2,1), i(2,2) ) );
+}
+
+mesh_properties py_mass_properties(const mesh_t &m, int threads)
+{
+    return mass_properties( m, threads );
+}
+
+boost::python::list py_vertex_error(const mesh_distance &d) { return py_list( d.vertex_error ); }
+
+mesh_distance py_surface_distance(const mesh_t &a, const mesh_t &b, std::size_t samples, int threads)
+{
+    return surface_distance( a, b, samples, threads );
+}
+
+double py_hausdorff_distance(const mesh_t &a, const mesh_t &b, std::size_t samples, int threads)
+{
+    return hausdorff_distance( a, b, samples, threads );
+}
+
+remesh_stats py_remesh(mesh_t &m, double target_length, int iterations, double feature_angle, bool project, int threads)
+{
+    remesh_options options;
+    options.target_length = target_length;
+    options.iterations = iterations;
+    options.feature_angle = feature_angle;
+    options.project = project;
+    options.threads = threads;
+
+    return remesh( m, options );
+}
+
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(split_edge_overloads, split_edge, 1, 3)
 
 void arch::python::export_geometry()
@@ -170,6 +583,234 @@ void arch::python::export_geometry()
     def("triangulate", &triangulate_ret,
             "Triangulates a simple planar face and returns a list of vertices", args("f"));
 
+    def("triangulate_mesh", &py_triangulate_mesh,
+            "Triangulates all the polygonal faces of the mesh and returns their number", 
+            (arg("m"), arg("keep_quads") = false));
+
+    def("decimate", &py_decimate,
+            "Simplifies the mesh with quadric edge collapses and returns the number of faces", 
+            (arg("m"), arg("target_faces"), arg("lock_boundary") = true, arg("feature_angle") = 60.0, 
+             arg("max_error") = -1.0, arg("parallel") = false));
+
+    def("boundary_loops", &py_boundary_loops,
+            "Returns the closed loops of the free edges as lists of vertices", args("m"));
+
+    def("fill_holes", &fill_holes< mesh_t >,
+            "Triangulates the holes with a perimeter below the threshold and returns their number", args("m","max_perimeter"));
+
+    class_< quality_measure >("quality_measure", "Statistics and histogram of a quality measure")
+        .def_readonly("min", &quality_measure::min)
+        .def_readonly("max", &quality_measure::max)
+        .def_readonly("count", &quality_measure::count)
+        .def_readonly("start", &quality_measure::start, "Lower end of the first bucket")
+        .def_readonly("width", &quality_measure::width, "Width of the buckets")
+        .add_property("mean", &quality_measure::mean)
+        .add_property("histogram", &py_histogram, "Number of values in each bucket")
+        ;
+
+    class_< mesh_quality >("mesh_quality", "Quality statistics of the faces and the edges of a mesh")
+        .def_readonly("faces", &mesh_quality::faces)
+        .def_readonly("degenerate", &mesh_quality::degenerate, "Number of faces with zero area")
+        .def_readonly("min_angle", &mesh_quality::min_angle)
+        .def_readonly("max_angle", &mesh_quality::max_angle)
+        .def_readonly("aspect_ratio", &mesh_quality::aspect_ratio)
+        .def_readonly("skew", &mesh_quality::skew)
+        .def_readonly("area", &mesh_quality::area)
+        .def_readonly("edge_length", &mesh_quality::edge_length)
+        ;
+
+    def("quality_report", &py_quality_report,
+            "Returns the angle, aspect ratio, skew, area and edge length statistics of the mesh", 
+            (arg("m"), arg("threads") = 0));
+
+    class_< improve_stats >("improve_stats", "Number of operations applied by the mesh improvement")
+        .def_readonly("flips", &improve_stats::flips)
+        .def_readonly("splits", &improve_stats::splits)
+        .def_readonly("collapses", &improve_stats::collapses)
+        ;
+
+    def("improve", &py_improve,
+            "Improves the triangles with edge flips, splits and collapses, the angles are in degrees", 
+            (arg("m"), arg("iterations") = 1, arg("skew_angle") = 5.0, arg("max_angle") = 175.0, 
+             arg("improve_angle") = 14.0, arg("feature_angle") = 5.0, arg("node_equiv") = 0.001));
+
+    enum_< subdivide_scheme >("subdivide_scheme")
+        .value("hermite", SUBDIVIDE_HERMITE)
+        .value("loop", SUBDIVIDE_LOOP)
+        .value("catmull_clark", SUBDIVIDE_CATMULL_CLARK)
+        ;
+
+    def("subdivide", &py_subdivide,
+            "Subdivides the faces of the mesh and returns their number", 
+            (arg("m"), arg("scheme") = SUBDIVIDE_LOOP, arg("levels") = 1));
+
+    enum_< smooth_weights >("smooth_weights")
+        .value("uniform", SMOOTH_UNIFORM)
+        .value("cotangent", SMOOTH_COTANGENT)
+        ;
+
+    def("smooth", &py_smooth,
+            "Laplacian smoothing of the vertices that are not on free or tjoin edges, a negative mu gives Taubin smoothing. Returns the number of moved vertices", 
+            (arg("m"), arg("iterations") = 1, arg("weights") = SMOOTH_UNIFORM, arg("lambda_") = 1.0, arg("mu") = 0.0));
+
+    class_< orientation_report >("orientation_report", "Flipped faces and orientability of the components")
+        .def_readonly("flips", &orientation_report::flips)
+        .def_readonly("non_orientable", &orientation_report::non_orientable, "Number of non orientable components")
+        .add_property("components", &orientation_report::components)
+        .add_property("component_faces", &py_component_faces)
+        .add_property("component_flips", &py_component_flips)
+        .add_property("component_orientable", &py_component_orientable)
+        ;
+
+    def("orient_consistently", &py_orient_consistently,
+            "Flips the faces so that neighbouring faces have the same orientation", 
+            (arg("m"), arg("threads") = 0));
+
+    enum_< component_connectivity >("component_connectivity")
+        .value("edge", CONNECT_EDGE)
+        .value("vertex", CONNECT_VERTEX)
+        ;
+
+    class_< components_t >("mesh_components", "Connected components of a mesh, numbered in the order of their first face")
+        .def_readonly("count", &components_t::count)
+        .add_property("face_component", &py_face_component, "Component of every face by id")
+        .add_property("vertex_component", &py_vertex_component, "Component of every vertex by id, -1 for the vertices without faces")
+        .add_property("faces", &py_component_face_count, "Number of faces of every component")
+        .add_property("verts", &py_component_vertex_count, "Number of vertices of every component")
+        .add_property("min", &py_component_min, "Lower corner of the bounding box of every component")
+        .add_property("max", &py_component_max, "Upper corner of the bounding box of every component")
+        ;
+
+    def("connected_components", &py_connected_components,
+            "Labels the faces and the vertices with their connected component", 
+            (arg("m"), arg("by") = CONNECT_EDGE, arg("bounds") = false));
+
+    class_< bvh_t, boost::shared_ptr< bvh_t >, boost::noncopyable >("face_bvh", 
+            "Bounding volume hierarchy over the faces of a mesh, the queries return face ids", no_init)
+        .def("__init__", make_constructor( &py_make_bvh ))
+        .def("closest_point", &py_bvh_closest_point, "Returns (face, point, distance) of the closest point or None", args("p"))
+        .def("ray_hit", &py_bvh_ray_hit, "Returns (face, t) of the first hit of the ray or None", args("origin","dir"))
+        .def("box_overlap", &py_bvh_box_overlap, "Returns the faces with a triangle whose box overlaps the box", args("lo","hi"))
+        .def("refit", &py_bvh_refit, "Updates the boxes after the vertices of the mesh were moved", args("m"))
+        ;
+
+    def("weld_vertices", &py_weld_vertices,
+            "Merges the vertices closer than the tolerance and rebuilds the faces. Returns the number of removed vertices", 
+            (arg("m"), arg("tolerance") = 0.0, arg("threads") = 0));
+
+    def("find_self_intersections", &py_find_self_intersections,
+            "Returns the (face, face) id pairs of the faces that cross each other away from their shared vertices", 
+            (arg("m"), arg("threads") = 0));
+
+    class_< manifold_report >("manifold_report", 
+            "Boundary, manifold and tjoin edges, non manifold and isolated vertices. The bitsets are bytes indexed by the ids, least significant bit first")
+        .def_readonly("boundary_count", &manifold_report::boundary_count)
+        .def_readonly("manifold_count", &manifold_report::manifold_count)
+        .def_readonly("tjoin_count", &manifold_report::tjoin_count)
+        .def_readonly("nonmanifold_count", &manifold_report::nonmanifold_count)
+        .def_readonly("isolated_count", &manifold_report::isolated_count)
+        .add_property("is_manifold", &manifold_report::is_manifold)
+        .add_property("boundary_edges", &py_boundary_edges, "Edges with at most one face")
+        .add_property("manifold_edges", &py_manifold_edges, "Edges with two faces")
+        .add_property("tjoin_edges", &py_tjoin_edges, "Edges with three or more faces")
+        .add_property("nonmanifold_verts", &py_nonmanifold_verts, "Vertices on a tjoin edge or with more than one fan of faces")
+        .add_property("isolated_verts", &py_isolated_verts, "Vertices without faces")
+        ;
+
+    def("classify_manifold", &py_classify_manifold,
+            "Classifies the edges and the vertices of the mesh in one parallel pass", 
+            (arg("m"), arg("threads") = 0));
+
+    def("make_manifold", &py_make_manifold,
+            "Splits the tjoin edges and the pinched vertices by copying vertices. Returns the original vertex id of every vertex", 
+            (arg("m"), arg("threads") = 0));
+
+    enum_< geodesic_method >("geodesic_method")
+        .value("dijkstra", GEODESIC_DIJKSTRA)
+        .value("fast_marching", GEODESIC_FAST_MARCHING)
+        .value("heat", GEODESIC_HEAT)
+        ;
+
+    class_< geodesics_t, boost::shared_ptr< geodesics_t >, boost::noncopyable >("geodesics", 
+            "Geodesic distances on a mesh, keeps the connectivity and the heat method factors for repeated queries", no_init)
+        .def("__init__", make_constructor( &py_make_geodesics, default_call_policies(), (arg("m"), arg("threads") = 0) ))
+        .def("distance", &py_geodesics_distance, 
+             "Returns the distance of every vertex from the closest source vertex id, inf where no source is reached", 
+             (arg("sources"), arg("method") = GEODESIC_FAST_MARCHING))
+        .def("prepare_heat", &geodesics_t::prepare_heat, 
+             "Factors the heat method systems with the time step in squared mean edge lengths", (arg("time") = 1.0))
+        ;
+
+    def("geodesic_distance", &py_geodesic_distance,
+            "Returns the distance of every vertex from the closest source vertex id, inf where no source is reached", 
+            (arg("m"), arg("sources"), arg("method") = GEODESIC_FAST_MARCHING, arg("threads") = 0));
+
+    class_< mesh_curvature >("mesh_curvature", 
+            "Curvatures of the vertices and dihedral angles of the edges, the lists are indexed by the ids")
+        .add_property("mean", &py_mean_curvature, "Mean curvature, positive on convex parts")
+        .add_property("gaussian", &py_gaussian_curvature, "Gaussian curvature")
+        .add_property("kmax", &py_kmax_curvature, "Largest principal curvature")
+        .add_property("kmin", &py_kmin_curvature, "Smallest principal curvature")
+        .add_property("area", &py_vertex_area, "Mixed Voronoi area")
+        .add_property("dihedral", &py_dihedral, "Signed dihedral angle in degrees, inf on edges with other than two faces")
+        .def("feature_edges", &py_feature_edges, 
+             "Edges with a dihedral angle above angle degrees as bytes indexed by the ids, least significant bit first", 
+             (arg("angle"), arg("threads") = 0))
+        ;
+
+    def("curvature", &py_curvature,
+            "Computes the curvatures and the dihedral angles of the mesh in parallel", 
+            (arg("m"), arg("threads") = 0));
+
+    class_< mesh_properties >("mesh_properties", 
+            "Bounding box, area and centroid of the surface, volume, center of mass and inertia of the enclosed solid")
+        .add_property("lo", &py_properties_lo, "Lower corner of the bounding box")
+        .add_property("hi", &py_properties_hi, "Upper corner of the bounding box")
+        .add_property("diagonal", &mesh_properties::diagonal)
+        .def_readonly("area", &mesh_properties::area)
+        .def_readonly("volume", &mesh_properties::volume, "Negative when the faces point inwards")
+        .add_property("centroid", &py_properties_centroid, "Area weighted centroid of the surface")
+        .add_property("center", &py_properties_center, "Center of mass of the solid")
+        .add_property("inertia", &py_properties_inertia, "Rows of the inertia tensor about the center of mass")
+        ;
+
+    def("mass_properties", &py_mass_properties,
+            "Computes the properties in parallel with the same result for any number of threads", 
+            (arg("m"), arg("threads") = 0));
+
+    class_< remesh_stats >("remesh_stats", "Number of operations applied by the remeshing")
+        .def_readonly("splits", &remesh_stats::splits)
+        .def_readonly("collapses", &remesh_stats::collapses)
+        .def_readonly("flips", &remesh_stats::flips)
+        .def_readonly("rounds", &remesh_stats::rounds)
+        ;
+
+    def("remesh", &py_remesh,
+            "Remeshes the surface to triangles with edges of about target_length, the mean edge length if it is not positive. "
+            "The boundary and the edges sharper than feature_angle degrees are kept", 
+            (arg("m"), arg("target_length") = -1.0, arg("iterations") = 5, arg("feature_angle") = 45.0, 
+             arg("project") = true, arg("threads") = 0));
+
+    class_< mesh_distance >("mesh_distance", "Distance from the surface of a mesh to another one")
+        .def_readonly("max", &mesh_distance::max, "Largest distance of the samples and the vertices")
+        .def_readonly("mean", &mesh_distance::mean, "Area weighted mean distance of the samples")
+        .def_readonly("rms", &mesh_distance::rms, "Area weighted root mean square distance of the samples")
+        .def_readonly("samples", &mesh_distance::samples)
+        .add_property("vertex_error", &py_vertex_error, "Distance of every vertex to the other mesh")
+        ;
+
+    def("surface_distance", &py_surface_distance,
+            "Distance from a to b of points sampled on a in proportion to the area and of the vertices of a", 
+            (arg("a"), arg("b"), arg("samples") = 100000, arg("threads") = 0));
+
+    def("hausdorff_distance", &py_hausdorff_distance,
+            "Largest of the distances from a to b and from b to a", 
+            (arg("a"), arg("b"), arg("samples") = 100000, arg("threads") = 0));
+
+    def("slice_mesh", &py_slice,
+            "Cuts the mesh with the parallel planes dot(p,normal) = offset. Returns a list of (points, closed) polylines for every offset", 
+            (arg("m"), arg("normal"), arg("offsets"), arg("threads") = 0));
+
     def("centroid", &py_centroid< mesh_t::vertex_ptr_t, mesh_t::point_t >);
     def("is_convex", &py_is_convex<  mesh_t::point_t >);
     
@@ -228,6 +869,10 @@ void arch::python::export_geometry()
     def("clip_line_to_plane", clip_line_to_plane_fn );
     def("point_in_triangle", point_in_triangle_fn );
 
+    def("orient2d", &py_orient2d, "Twice the signed area of the triangle in the xy plane, positive when counter clock-wise, exact sign", args("a","b","c"));
+    def("orient3d", &py_orient3d, "Six times the signed volume of the tetrahedron, positive when d is on the normal side of abc, exact sign", args("a","b","c","d"));
+    def("incircle", &py_incircle, "Positive when d is inside the circle of the counter clock-wise triangle abc in the xy plane, exact sign", args("a","b","c","d"));
+
     class_< vertex_t, vertex_ptr_t >("vertex", "Mesh vertex")
         .def(init<const point_t &>())
         .def(init<real_t,real_t,real_t>())